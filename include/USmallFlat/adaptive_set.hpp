@@ -0,0 +1,18 @@
+#pragma once
+
+#include "basic_adaptive_set.hpp"
+
+#include "details/vector_bind.hpp"
+
+namespace Ubpa {
+    template<typename Key, std::size_t N = 8, std::size_t M = 64,
+        typename Compare = std::less<Key>, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, template<typename>class TAllocator = std::allocator>
+    class adaptive_set : public basic_adaptive_set<details::Tvector_bind<TAllocator>::template Ttype, Key, N, M, Compare, Hash, KeyEqual> {
+        using mybase = basic_adaptive_set<details::Tvector_bind<TAllocator>::template Ttype, Key, N, M, Compare, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        adaptive_set(std::initializer_list<value_type> ilist) : mybase(ilist) {}
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "basic_flat_map.hpp"
+#include "basic_flat_unordered_map.hpp"
+#include "details/adaptive_base.hpp"
+
+namespace Ubpa {
+    // a map for any size, see details::adaptive_base
+    // - up to N elements: inline, linear scan
+    // - up to M elements: basic_flat_map<Vector, Key, T, Compare>
+    // - else: basic_flat_unordered_map<Vector, Vector, Key, T, Hash, KeyEqual>
+    template<template<typename>class Vector, typename Key, typename T, std::size_t N = 8, std::size_t M = 64,
+        typename Compare = std::less<Key>, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class basic_adaptive_map : public details::adaptive_base<Key, std::pair<Key, T>, std::pair<const Key, T>, N, M, Compare,
+        basic_flat_map<Vector, Key, T, Compare>, basic_flat_unordered_map<Vector, Vector, Key, T, Hash, KeyEqual>>
+    {
+        using mybase = details::adaptive_base<Key, std::pair<Key, T>, std::pair<const Key, T>, N, M, Compare,
+            basic_flat_map<Vector, Key, T, Compare>, basic_flat_unordered_map<Vector, Vector, Key, T, Hash, KeyEqual>>;
+    public:
+        using typename mybase::key_type;
+        using typename mybase::value_type;
+        using typename mybase::iterator;
+        using mapped_type = T;
+
+        basic_adaptive_map() = default;
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_adaptive_map(Iter first, Iter last) { insert(first, last); }
+
+        basic_adaptive_map(std::initializer_list<value_type> ilist) : basic_adaptive_map(ilist.begin(), ilist.end()) {}
+
+        //
+        // Element access
+        ///////////////////
+
+        T& at(const key_type& key) {
+            if (auto target = mybase::find(key); target != mybase::end())
+                return target->second;
+            throw std::out_of_range("invalid basic_adaptive_map subscript");
+        }
+
+        const T& at(const key_type& key) const { return const_cast<basic_adaptive_map*>(this)->at(key); }
+
+        T& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        T& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        //
+        // Modifiers
+        //////////////
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, std::move(value.second)); }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            std::pair<Key, T> value(std::forward<Args>(args)...);
+            return mybase::insert_unique(value.first, [&]() -> std::pair<Key, T>&& { return std::move(value); });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) { return try_emplace_impl(k, std::forward<Args>(args)...); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) { return try_emplace_impl(std::move(k), std::forward<Args>(args)...); }
+
+        template<typename M_>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M_&& obj) { return insert_or_assign_impl(k, std::forward<M_>(obj)); }
+
+        template<typename M_>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M_&& obj) { return insert_or_assign_impl(std::move(k), std::forward<M_>(obj)); }
+
+    private:
+        // k and args are only consumed if k is inserted
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+            return mybase::insert_unique(k, [&]() {
+                return std::pair<Key, T>(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template<typename K, typename Obj>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& k, Obj&& obj) {
+            auto rst = mybase::insert_unique(k, [&]() { return std::pair<Key, T>(std::forward<K>(k), std::forward<Obj>(obj)); });
+            if (!rst.second)
+                rst.first->second = std::forward<Obj>(obj);
+            return rst;
+        }
+    };
+}
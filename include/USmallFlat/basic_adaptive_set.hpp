@@ -0,0 +1,49 @@
+#pragma once
+
+#include "basic_flat_set.hpp"
+#include "basic_flat_unordered_set.hpp"
+#include "details/adaptive_base.hpp"
+
+namespace Ubpa {
+    // a set for any size, see details::adaptive_base
+    // - up to N elements: inline, linear scan
+    // - up to M elements: basic_flat_set<Vector, Key, Compare>
+    // - else: basic_flat_unordered_set<Vector, Vector, Key, Hash, KeyEqual>
+    template<template<typename>class Vector, typename Key, std::size_t N = 8, std::size_t M = 64,
+        typename Compare = std::less<Key>, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class basic_adaptive_set : public details::adaptive_base<Key, Key, Key, N, M, Compare,
+        basic_flat_set<Vector, Key, Compare>, basic_flat_unordered_set<Vector, Vector, Key, Hash, KeyEqual>>
+    {
+        using mybase = details::adaptive_base<Key, Key, Key, N, M, Compare,
+            basic_flat_set<Vector, Key, Compare>, basic_flat_unordered_set<Vector, Vector, Key, Hash, KeyEqual>>;
+    public:
+        using typename mybase::value_type;
+        using typename mybase::iterator;
+
+        basic_adaptive_set() = default;
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_adaptive_set(Iter first, Iter last) { insert(first, last); }
+
+        basic_adaptive_set(std::initializer_list<value_type> ilist) : basic_adaptive_set(ilist.begin(), ilist.end()) {}
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return mybase::insert_unique(value, [&]() -> const value_type& { return value; });
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return mybase::insert_unique(value, [&]() -> value_type&& { return std::move(value); });
+        }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) { return insert(value_type(std::forward<Args>(args)...)); }
+    };
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "basic_flat_map.hpp"
+#include "static_vector.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace Ubpa {
+    // a basic_flat_map for write-heavy use
+    // - insert / emplace / try_emplace / insert_or_assign / operator[] append to an unsorted buffer of at most N elements,
+    //   merged into the flat map when it is full
+    // - count / contains / at / erase(key) search the flat map and scan the buffer
+    // - anything returning iterators (begin, find, lower_bound, ...) first merges the buffer,
+    //   so even const lookups modify the object, don't share one between threads without a lock
+    template<template<typename>class Vector, typename Key, typename T, typename Compare = std::less<Key>, std::size_t N = 64>
+    class basic_buffered_flat_map {
+        static_assert(N > 0);
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using flat_type = basic_flat_map<Vector, Key, T, Compare>;
+        using buffer_type = static_vector<std::pair<Key, T>, N>;
+
+        using key_type = typename flat_type::key_type;
+        using mapped_type = typename flat_type::mapped_type;
+        using value_type = typename flat_type::value_type;
+        using size_type = typename flat_type::size_type;
+        using difference_type = typename flat_type::difference_type;
+        using key_compare = typename flat_type::key_compare;
+        using iterator = typename flat_type::iterator;
+        using const_iterator = typename flat_type::const_iterator;
+        using reverse_iterator = typename flat_type::reverse_iterator;
+        using const_reverse_iterator = typename flat_type::const_reverse_iterator;
+
+        static constexpr std::size_t buffer_capacity = N;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        basic_buffered_flat_map() = default;
+
+        explicit basic_buffered_flat_map(const Compare& comp) : m_flat(comp) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_buffered_flat_map(Iter first, Iter last, const Compare& comp = Compare()) : m_flat(first, last, comp) {}
+
+        basic_buffered_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : m_flat(ilist, comp) {}
+
+        //
+        // Iterators
+        //////////////
+        // merge the buffer
+
+        iterator begin() { return flat().begin(); }
+        const_iterator begin() const { return flat().begin(); }
+        const_iterator cbegin() const { return flat().cbegin(); }
+
+        iterator end() { return flat().end(); }
+        const_iterator end() const { return flat().end(); }
+        const_iterator cend() const { return flat().cend(); }
+
+        reverse_iterator rbegin() { return flat().rbegin(); }
+        const_reverse_iterator rbegin() const { return flat().rbegin(); }
+        const_reverse_iterator crbegin() const { return flat().crbegin(); }
+
+        reverse_iterator rend() { return flat().rend(); }
+        const_reverse_iterator rend() const { return flat().rend(); }
+        const_reverse_iterator crend() const { return flat().crend(); }
+
+        //
+        // Element access
+        ///////////////////
+
+        mapped_type& at(const key_type& key) {
+            if (auto value = find_mapped(key))
+                return *value;
+            throw std::out_of_range("invalid basic_buffered_flat_map subscript");
+        }
+
+        const mapped_type& at(const key_type& key) const { return const_cast<basic_buffered_flat_map*>(this)->at(key); }
+
+        mapped_type& operator[](const key_type& key) { return *try_emplace_impl(key).first; }
+        mapped_type& operator[](key_type&& key) { return *try_emplace_impl(std::move(key)).first; }
+
+        //
+        // Capacity
+        /////////////
+
+        bool empty() const noexcept { return m_flat.empty() && m_buffer.empty(); }
+
+        size_type size() const noexcept { return m_flat.size() + m_buffer.size(); }
+
+        size_type max_size() const noexcept { return m_flat.max_size(); }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            m_flat.clear();
+            m_buffer.clear();
+        }
+
+        // returns whether value was inserted, amortized O(log(size()) + N + size() / N)
+        bool insert(const value_type& value) { return try_emplace_impl(value.first, value.second).second; }
+        bool insert(value_type&& value) { return try_emplace_impl(value.first, std::move(value.second)).second; }
+
+        // a large batch goes straight to the bulk insert of the flat map
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            flush();
+            m_flat.insert(first, last);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        bool emplace(Args&&... args) {
+            std::pair<Key, T> value(std::forward<Args>(args)...);
+            return try_emplace_impl(std::move(value.first), std::move(value.second)).second;
+        }
+
+        template<typename... Args>
+        bool try_emplace(const key_type& k, Args&&... args) { return try_emplace_impl(k, std::forward<Args>(args)...).second; }
+
+        template<typename... Args>
+        bool try_emplace(key_type&& k, Args&&... args) { return try_emplace_impl(std::move(k), std::forward<Args>(args)...).second; }
+
+        template<typename M>
+        bool insert_or_assign(const key_type& k, M&& m) { return insert_or_assign_impl(k, std::forward<M>(m)); }
+
+        template<typename M>
+        bool insert_or_assign(key_type&& k, M&& m) { return insert_or_assign_impl(std::move(k), std::forward<M>(m)); }
+
+        iterator erase(const_iterator pos) { return flat().erase(pos); }
+        iterator erase(const_iterator first, const_iterator last) { return flat().erase(first, last); }
+
+        size_type erase(const key_type& key) {
+            if (auto target = buffer_find(key); target != m_buffer.end()) {
+                // unsorted, the last one fills the gap
+                if (target != std::prev(m_buffer.end()))
+                    *target = std::move(m_buffer.back());
+                m_buffer.pop_back();
+                return 1;
+            }
+            return m_flat.erase(key);
+        }
+
+        // merges the buffer into the flat map
+        void flush() const {
+            if (m_buffer.empty())
+                return;
+            m_flat.insert(std::make_move_iterator(m_buffer.begin()), std::make_move_iterator(m_buffer.end()));
+            m_buffer.clear();
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        bool contains(const key_type& key) const { return m_flat.contains(key) || buffer_find(key) != m_buffer.end(); }
+
+        iterator find(const key_type& key) { return flat().find(key); }
+        const_iterator find(const key_type& key) const { return flat().find(key); }
+
+        std::pair<iterator, iterator> equal_range(const key_type& key) { return flat().equal_range(key); }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return flat().equal_range(key); }
+
+        iterator lower_bound(const key_type& key) { return flat().lower_bound(key); }
+        const_iterator lower_bound(const key_type& key) const { return flat().lower_bound(key); }
+
+        iterator upper_bound(const key_type& key) { return flat().upper_bound(key); }
+        const_iterator upper_bound(const key_type& key) const { return flat().upper_bound(key); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return m_flat.key_comp(); }
+
+        // the flat map after merging the buffer
+        flat_type& flat() { flush(); return m_flat; }
+        const flat_type& flat() const { flush(); return m_flat; }
+
+    private:
+        typename buffer_type::iterator buffer_find(const key_type& key) const {
+            const auto comp = m_flat.key_comp();
+            return std::find_if(m_buffer.begin(), m_buffer.end(),
+                [&](const std::pair<Key, T>& elem) { return !comp(elem, key) && !comp(key, elem); });
+        }
+
+        mapped_type* find_mapped(const key_type& key) {
+            if (auto target = m_flat.find(key); target != m_flat.end())
+                return &target->second;
+            if (auto target = buffer_find(key); target != m_buffer.end())
+                return &target->second;
+            return nullptr;
+        }
+
+        template<typename K, typename... Args>
+        mapped_type& buffer_emplace(K&& k, Args&&... args) {
+            if (m_buffer.size() == N)
+                flush();
+            m_buffer.emplace_back(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(k)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            return m_buffer.back().second;
+        }
+
+        // returns the mapped value of k and whether it was inserted
+        template<typename K, typename... Args>
+        std::pair<mapped_type*, bool> try_emplace_impl(K&& k, Args&&... args) {
+            if (auto value = find_mapped(k))
+                return { value, false };
+            return { &buffer_emplace(std::forward<K>(k), std::forward<Args>(args)...), true };
+        }
+
+        template<typename K, typename M>
+        bool insert_or_assign_impl(K&& k, M&& m) {
+            if (auto value = find_mapped(k)) {
+                *value = std::forward<M>(m);
+                return false;
+            }
+            buffer_emplace(std::forward<K>(k), std::forward<M>(m));
+            return true;
+        }
+
+        mutable flat_type m_flat;
+        mutable buffer_type m_buffer;
+    };
+
+    template<template<typename>class Vector, typename Key, typename T, typename Compare, std::size_t N>
+    bool operator==(const basic_buffered_flat_map<Vector, Key, T, Compare, N>& lhs, const basic_buffered_flat_map<Vector, Key, T, Compare, N>& rhs) {
+        return lhs.flat() == rhs.flat();
+    }
+
+    template<template<typename>class Vector, typename Key, typename T, typename Compare, std::size_t N>
+    bool operator!=(const basic_buffered_flat_map<Vector, Key, T, Compare, N>& lhs, const basic_buffered_flat_map<Vector, Key, T, Compare, N>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "basic_flat_set.hpp"
+#include "static_vector.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Ubpa {
+    // a basic_flat_set for write-heavy use
+    // - insert / emplace append to an unsorted buffer of at most N elements, merged into the flat set when it is full
+    // - count / contains / erase(key) search the flat set and scan the buffer
+    // - anything returning iterators (begin, find, lower_bound, ...) first merges the buffer,
+    //   so even const lookups modify the object, don't share one between threads without a lock
+    template<template<typename>class Vector, typename Key, typename Compare = std::less<Key>, std::size_t N = 64>
+    class basic_buffered_flat_set {
+        static_assert(N > 0);
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using flat_type = basic_flat_set<Vector, Key, Compare>;
+        using buffer_type = static_vector<Key, N>;
+
+        using key_type = typename flat_type::key_type;
+        using value_type = typename flat_type::value_type;
+        using size_type = typename flat_type::size_type;
+        using difference_type = typename flat_type::difference_type;
+        using key_compare = typename flat_type::key_compare;
+        using value_compare = typename flat_type::value_compare;
+        using reference = typename flat_type::reference;
+        using const_reference = typename flat_type::const_reference;
+        using iterator = typename flat_type::iterator;
+        using const_iterator = typename flat_type::const_iterator;
+        using reverse_iterator = typename flat_type::reverse_iterator;
+        using const_reverse_iterator = typename flat_type::const_reverse_iterator;
+
+        static constexpr std::size_t buffer_capacity = N;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        basic_buffered_flat_set() = default;
+
+        explicit basic_buffered_flat_set(const Compare& comp) : m_flat(comp) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_buffered_flat_set(Iter first, Iter last, const Compare& comp = Compare()) : m_flat(first, last, comp) {}
+
+        basic_buffered_flat_set(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : m_flat(ilist, comp) {}
+
+        //
+        // Iterators
+        //////////////
+        // merge the buffer
+
+        iterator begin() { return flat().begin(); }
+        const_iterator begin() const { return flat().begin(); }
+        const_iterator cbegin() const { return flat().cbegin(); }
+
+        iterator end() { return flat().end(); }
+        const_iterator end() const { return flat().end(); }
+        const_iterator cend() const { return flat().cend(); }
+
+        reverse_iterator rbegin() { return flat().rbegin(); }
+        const_reverse_iterator rbegin() const { return flat().rbegin(); }
+        const_reverse_iterator crbegin() const { return flat().crbegin(); }
+
+        reverse_iterator rend() { return flat().rend(); }
+        const_reverse_iterator rend() const { return flat().rend(); }
+        const_reverse_iterator crend() const { return flat().crend(); }
+
+        //
+        // Capacity
+        /////////////
+
+        bool empty() const noexcept { return m_flat.empty() && m_buffer.empty(); }
+
+        size_type size() const noexcept { return m_flat.size() + m_buffer.size(); }
+
+        size_type max_size() const noexcept { return m_flat.max_size(); }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            m_flat.clear();
+            m_buffer.clear();
+        }
+
+        // returns whether value was inserted, amortized O(log(size()) + N + size() / N)
+        bool insert(const value_type& value) { return emplace(value); }
+        bool insert(value_type&& value) { return emplace(std::move(value)); }
+
+        // a large batch goes straight to the bulk insert of the flat set
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            flush();
+            m_flat.insert(first, last);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        bool emplace(Args&&... args) {
+            value_type value(std::forward<Args>(args)...);
+            if (m_flat.contains(value) || buffer_find(value) != m_buffer.end())
+                return false;
+            if (m_buffer.size() == N)
+                flush();
+            m_buffer.push_back(std::move(value));
+            return true;
+        }
+
+        iterator erase(const_iterator pos) { return flat().erase(pos); }
+        iterator erase(const_iterator first, const_iterator last) { return flat().erase(first, last); }
+
+        size_type erase(const key_type& key) {
+            if (auto target = buffer_find(key); target != m_buffer.end()) {
+                // unsorted, the last one fills the gap
+                if (target != std::prev(m_buffer.end()))
+                    *target = std::move(m_buffer.back());
+                m_buffer.pop_back();
+                return 1;
+            }
+            return m_flat.erase(key);
+        }
+
+        // merges the buffer into the flat set
+        void flush() const {
+            if (m_buffer.empty())
+                return;
+            m_flat.insert(std::make_move_iterator(m_buffer.begin()), std::make_move_iterator(m_buffer.end()));
+            m_buffer.clear();
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        bool contains(const key_type& key) const { return m_flat.contains(key) || buffer_find(key) != m_buffer.end(); }
+
+        iterator find(const key_type& key) { return flat().find(key); }
+        const_iterator find(const key_type& key) const { return flat().find(key); }
+
+        std::pair<iterator, iterator> equal_range(const key_type& key) { return flat().equal_range(key); }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return flat().equal_range(key); }
+
+        iterator lower_bound(const key_type& key) { return flat().lower_bound(key); }
+        const_iterator lower_bound(const key_type& key) const { return flat().lower_bound(key); }
+
+        iterator upper_bound(const key_type& key) { return flat().upper_bound(key); }
+        const_iterator upper_bound(const key_type& key) const { return flat().upper_bound(key); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return m_flat.key_comp(); }
+        value_compare value_comp() const { return m_flat.value_comp(); }
+
+        // the flat set after merging the buffer
+        flat_type& flat() { flush(); return m_flat; }
+        const flat_type& flat() const { flush(); return m_flat; }
+
+    private:
+        typename buffer_type::iterator buffer_find(const key_type& key) const {
+            const auto comp = m_flat.key_comp();
+            return std::find_if(m_buffer.begin(), m_buffer.end(),
+                [&](const value_type& elem) { return !comp(elem, key) && !comp(key, elem); });
+        }
+
+        mutable flat_type m_flat;
+        mutable buffer_type m_buffer;
+    };
+
+    template<template<typename>class Vector, typename Key, typename Compare, std::size_t N>
+    bool operator==(const basic_buffered_flat_set<Vector, Key, Compare, N>& lhs, const basic_buffered_flat_set<Vector, Key, Compare, N>& rhs) {
+        return lhs.flat() == rhs.flat();
+    }
+
+    template<template<typename>class Vector, typename Key, typename Compare, std::size_t N>
+    bool operator!=(const basic_buffered_flat_set<Vector, Key, Compare, N>& lhs, const basic_buffered_flat_set<Vector, Key, Compare, N>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -43,6 +43,23 @@ namespace Ubpa {
         mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
         mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
 
+        // -- is_transparent
+        // key_type is only constructed from x if x is inserted
+
+        template<typename K, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        mapped_type& at(const K& x) {
+            auto target = mybase::find(x);
+            if (target == mybase::end())
+                throw_out_of_range();
+            return target->second;
+        }
+
+        template<typename K, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const mapped_type& at(const K& x) const { return const_cast<basic_flat_map*>(this)->at(x); }
+
+        template<typename K, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        mapped_type& operator[](K&& x) { return try_emplace_impl(std::forward<K>(x)).first->second; }
+
         //
         // Modifiers
         //////////////
@@ -75,6 +92,23 @@ namespace Ubpa {
         iterator try_emplace(const_iterator hint, key_type&& k, Args&&... args)
         { return try_emplace_hint_impl(hint, std::move(k), std::forward<Args>(args)...); }
 
+        // -- is_transparent
+
+        template<typename K, typename M, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        std::pair<iterator, bool> insert_or_assign(K&& x, M&& m) { return insert_or_assign_impl(std::forward<K>(x), std::forward<M>(m)); }
+
+        template<typename K, typename M, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        iterator insert_or_assign(const_iterator hint, K&& x, M&& m) { return insert_or_assign_hint_impl(hint, std::forward<K>(x), std::forward<M>(m)); }
+
+        template<typename K, typename... Args, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>
+            && !std::is_convertible_v<K&&, iterator> && !std::is_convertible_v<K&&, const_iterator>, typename Comp_::is_transparent>>
+        std::pair<iterator, bool> try_emplace(K&& x, Args&&... args)
+        { return try_emplace_impl(std::forward<K>(x), std::forward<Args>(args)...); }
+
+        template<typename K, typename... Args, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        iterator try_emplace(const_iterator hint, K&& x, Args&&... args)
+        { return try_emplace_hint_impl(hint, std::forward<K>(x), std::forward<Args>(args)...); }
+
     private:
         [[noreturn]] void throw_out_of_range() const { throw std::out_of_range("invalid basic_flat_map subscript"); }
 
@@ -140,7 +174,7 @@ namespace Ubpa {
                 last = hint;
             }
 
-            auto lb = std::lower_bound(first, last, k, mybase::key_comp()); // value <= lb
+            auto lb = mybase::lower_bound_in(first, last, k); // value <= lb
 
 
             if (lb == mybase::end() || mybase::key_comp()(k, *lb)) // value < lb
@@ -187,7 +221,7 @@ namespace Ubpa {
                 last = hint;
             }
 
-            auto lb = std::lower_bound(first, last, k, mybase::key_comp()); // value <= lb
+            auto lb = mybase::lower_bound_in(first, last, k); // value <= lb
 
 
             if (lb == mybase::end() || mybase::key_comp()(k, *lb)) // value < lb
@@ -0,0 +1,459 @@
+#pragma once
+
+#include "sorted_tags.hpp"
+#include "details/flat_base_multiset.hpp"
+#include "details/flat_soa_map_iterator.hpp"
+
+#include <vector>
+#include <stdexcept>
+
+namespace Ubpa {
+    // structure of arrays: the keys and the mapped values live in two parallel Vectors,
+    // so lookups only walk the dense key array
+    // iterators dereference to the proxy std::pair<const Key&, T&>
+    template <template<typename>class Vector, typename Key, typename T, typename Compare = std::less<Key>>
+    class basic_flat_soa_map : private details::flat_base_multiset_base<Compare> {
+        using mybase = details::flat_base_multiset_base<Compare>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_container_type = Vector<Key>;
+        using mapped_container_type = Vector<T>;
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using key_compare = Compare;
+        using reference = std::pair<const Key&, T&>;
+        using const_reference = std::pair<const Key&, const T&>;
+        using size_type = typename key_container_type::size_type;
+        using difference_type = typename key_container_type::difference_type;
+        using iterator = details::flat_soa_map_iterator<typename key_container_type::const_iterator, typename mapped_container_type::iterator>;
+        using const_iterator = details::flat_soa_map_iterator<typename key_container_type::const_iterator, typename mapped_container_type::const_iterator>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        basic_flat_soa_map() : mybase(Compare()) {}
+
+        explicit basic_flat_soa_map(const Compare& comp) : mybase(comp) {}
+
+        // keys[i] maps to values[i], in any order
+        basic_flat_soa_map(key_container_type keys, mapped_container_type values, const Compare& comp = Compare()) : mybase(comp) {
+            assert(keys.size() == values.size());
+            std::vector<value_type> elems;
+            elems.reserve(keys.size());
+            for (size_type i = 0; i < keys.size(); i++)
+                elems.emplace_back(std::move(keys[i]), std::move(values[i]));
+            merge_sorted(sort_unique(std::move(elems)));
+        }
+
+        basic_flat_soa_map(sorted_unique_t, key_container_type keys, mapped_container_type values, const Compare& comp = Compare())
+            : mybase(comp), m_keys(std::move(keys)), m_values(std::move(values))
+        {
+            assert(m_keys.size() == m_values.size());
+            assert(std::adjacent_find(m_keys.begin(), m_keys.end(),
+                [&](const Key& lhs, const Key& rhs) { return !this->GetCompare()(lhs, rhs); }) == m_keys.end());
+        }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_flat_soa_map(Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp) { insert(first, last); }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_flat_soa_map(sorted_unique_t tag, Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp) { insert(tag, first, last); }
+
+        basic_flat_soa_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : basic_flat_soa_map(ilist.begin(), ilist.end(), comp) {}
+
+        basic_flat_soa_map(sorted_unique_t tag, std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : basic_flat_soa_map(tag, ilist.begin(), ilist.end(), comp) {}
+
+        basic_flat_soa_map(const basic_flat_soa_map&) = default;
+
+        basic_flat_soa_map(basic_flat_soa_map&&) noexcept = default;
+
+        basic_flat_soa_map& operator=(const basic_flat_soa_map&) = default;
+
+        basic_flat_soa_map& operator=(basic_flat_soa_map&&) noexcept = default;
+
+        basic_flat_soa_map& operator=(std::initializer_list<value_type> ilist) {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        //
+        // Iterators
+        //////////////
+
+        iterator begin() noexcept { return make_iterator(0); }
+        const_iterator begin() const noexcept { return make_iterator(0); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return make_iterator(size()); }
+        const_iterator end() const noexcept { return make_iterator(size()); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator{ end() }; }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{ end() }; }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+        reverse_iterator rend() noexcept { return reverse_iterator{ begin() }; }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator{ begin() }; }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        //
+        // Element access
+        ///////////////////
+
+        mapped_type& at(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                throw_out_of_range();
+            return target->second;
+        }
+
+        const mapped_type& at(const key_type& key) const { return const_cast<basic_flat_soa_map*>(this)->at(key); }
+
+        mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        const key_container_type& keys() const noexcept { return m_keys; }
+        const mapped_container_type& values() const noexcept { return m_values; }
+
+        //
+        // Capacity
+        /////////////
+
+        bool empty() const noexcept { return m_keys.empty(); }
+
+        size_type size() const noexcept { return m_keys.size(); }
+
+        size_type max_size() const noexcept { return std::min<size_type>(m_keys.max_size(), m_values.max_size()); }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            m_keys.clear();
+            m_values.clear();
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+        // sorts [first, last) aside and merges it in, O(n + m log m); the earlier of equivalent keys is kept
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) { merge_sorted(sort_unique(std::vector<value_type>(first, last))); }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        // [first, last) is sorted and unique
+        template<typename InputIt>
+        void insert(sorted_unique_t, InputIt first, InputIt last) {
+            if (empty()) {
+                for (; first != last; ++first) {
+                    assert(empty() || this->GetCompare()(m_keys.back(), (*first).first));
+                    m_keys.push_back((*first).first);
+                    m_values.push_back((*first).second);
+                }
+            }
+            else
+                merge_sorted(std::vector<value_type>(first, last));
+        }
+
+        void insert(sorted_unique_t tag, std::initializer_list<value_type> ilist) { insert(tag, ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            value_type value(std::forward<Args>(args)...);
+            return try_emplace(std::move(value.first), std::move(value.second));
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& m) { return insert_or_assign_impl(k, std::forward<M>(m)); }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M&& m) { return insert_or_assign_impl(std::move(k), std::forward<M>(m)); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args)
+        { return try_emplace_impl(k, std::forward<Args>(args)...); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args)
+        { return try_emplace_impl(std::move(k), std::forward<Args>(args)...); }
+
+        iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+        iterator erase(iterator pos) { return erase(const_iterator{ pos }, std::next(const_iterator{ pos })); }
+        iterator erase(const_iterator first, const_iterator last) {
+            const auto offset = index_of(first);
+            const auto count = last - first;
+            m_keys.erase(m_keys.begin() + offset, m_keys.begin() + offset + count);
+            m_values.erase(m_values.begin() + offset, m_values.begin() + offset + count);
+            return make_iterator(offset);
+        }
+        size_type erase(const key_type& key) {
+            auto iter = find(key);
+            if (iter == end())
+                return 0;
+            else {
+                erase(iter);
+                return 1;
+            }
+        }
+
+        // pred takes reference, the two arrays are compacted in one pass
+        template<typename Pred>
+        size_type erase_if(Pred pred) {
+            const auto oldsize = size();
+            size_type out = 0;
+            for (size_type i = 0; i < oldsize; i++) {
+                if (pred(*make_iterator(i)))
+                    continue;
+                if (out != i) {
+                    m_keys[out] = std::move(m_keys[i]);
+                    m_values[out] = std::move(m_values[i]);
+                }
+                ++out;
+            }
+            m_keys.erase(m_keys.begin() + out, m_keys.end());
+            m_values.erase(m_values.begin() + out, m_values.end());
+            return oldsize - out;
+        }
+
+        void swap(basic_flat_soa_map& other) noexcept {
+            using std::swap;
+            swap(this->GetCompare(), other.GetCompare());
+            swap(m_keys, other.m_keys);
+            swap(m_values, other.m_values);
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        iterator find(const key_type& key) { return make_iterator(t_find(key)); }
+        const_iterator find(const key_type& key) const { return make_iterator(t_find(key)); }
+
+        bool contains(const key_type& key) const { return t_find(key) != size(); }
+
+        std::pair<iterator, iterator> equal_range(const key_type& key) { return { lower_bound(key), upper_bound(key) }; }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return { lower_bound(key), upper_bound(key) }; }
+
+        iterator lower_bound(const key_type& key) { return make_iterator(t_lower_bound(key)); }
+        const_iterator lower_bound(const key_type& key) const { return make_iterator(t_lower_bound(key)); }
+
+        iterator upper_bound(const key_type& key) { return make_iterator(t_upper_bound(key)); }
+        const_iterator upper_bound(const key_type& key) const { return make_iterator(t_upper_bound(key)); }
+
+        // -- is_transparent
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        iterator find(const K& key) { return make_iterator(t_find(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator find(const K& key) const { return make_iterator(t_find(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        size_type count(const K& key) const { return static_cast<size_type>(contains(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        bool contains(const K& key) const { return t_find(key) != size(); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        iterator lower_bound(const K& key) { return make_iterator(t_lower_bound(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator lower_bound(const K& key) const { return make_iterator(t_lower_bound(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        iterator upper_bound(const K& key) { return make_iterator(t_upper_bound(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator upper_bound(const K& key) const { return make_iterator(t_upper_bound(key)); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return this->GetCompare(); }
+
+    private:
+        [[noreturn]] void throw_out_of_range() const { throw std::out_of_range("invalid basic_flat_soa_map subscript"); }
+
+        iterator make_iterator(size_type offset) noexcept { return { m_keys.cbegin() + offset, m_values.begin() + offset }; }
+        const_iterator make_iterator(size_type offset) const noexcept { return { m_keys.cbegin() + offset, m_values.cbegin() + offset }; }
+
+        size_type index_of(const_iterator iter) const noexcept { return static_cast<size_type>(iter.key_iter() - m_keys.cbegin()); }
+
+        // the keys are contiguous, small maps get the SIMD scan of the flat sets
+        template<typename K>
+        static constexpr bool use_branchless_search = std::is_arithmetic_v<K> && enable_branchless_search_v<Key, Compare>;
+
+        template<typename K>
+        size_type t_lower_bound(const K& key) const {
+            if constexpr (use_branchless_search<K>)
+                return static_cast<size_type>(details::fast_lower_bound<Key, Compare>(m_keys.begin(), m_keys.end(), key, std::identity{}) - m_keys.begin());
+            else
+                return static_cast<size_type>(std::lower_bound(m_keys.begin(), m_keys.end(), key, this->GetCompare()) - m_keys.begin());
+        }
+
+        template<typename K>
+        size_type t_upper_bound(const K& key) const {
+            if constexpr (use_branchless_search<K>)
+                return static_cast<size_type>(details::fast_upper_bound<Key, Compare>(m_keys.begin(), m_keys.end(), key, std::identity{}) - m_keys.begin());
+            else
+                return static_cast<size_type>(std::upper_bound(m_keys.begin(), m_keys.end(), key, this->GetCompare()) - m_keys.begin());
+        }
+
+        // size() if not found
+        template<typename K>
+        size_type t_find(const K& key) const {
+            const auto lb = t_lower_bound(key); // key <= lb
+            if (lb == size() || this->GetCompare()(key, m_keys[lb])) // key < lb
+                return size();
+            else
+                return lb;
+        }
+
+        // the key is inserted first, so a throwing mapped_type ctor leaves the map unchanged
+        template<typename K, typename... Args>
+        iterator emplace_at(size_type offset, K&& k, Args&&... args) {
+            m_keys.insert(m_keys.begin() + offset, std::forward<K>(k));
+            try {
+                m_values.insert(m_values.begin() + offset, mapped_type(std::forward<Args>(args)...));
+            }
+            catch (...) {
+                m_keys.erase(m_keys.begin() + offset);
+                throw;
+            }
+            return make_iterator(offset);
+        }
+
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+            const auto lb = t_lower_bound(k); // key <= lb
+            if (lb == size() || this->GetCompare()(k, m_keys[lb])) // key < lb
+                return { emplace_at(lb, std::forward<K>(k), std::forward<Args>(args)...), true };
+            else
+                return { make_iterator(lb), false }; // key == lb
+        }
+
+        template<typename K, typename M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& k, M&& m) {
+            const auto lb = t_lower_bound(k); // k <= lb
+            if (lb == size() || this->GetCompare()(k, m_keys[lb])) // k < lb
+                return { emplace_at(lb, std::forward<K>(k), std::forward<M>(m)), true };
+            else { // k == lb
+                m_values[lb] = std::forward<M>(m);
+                return { make_iterator(lb), false };
+            }
+        }
+
+        // stable sort by key and drop the later of equivalent keys
+        std::vector<value_type> sort_unique(std::vector<value_type> elems) const {
+            auto& comp = this->GetCompare();
+            std::stable_sort(elems.begin(), elems.end(),
+                [&](const value_type& lhs, const value_type& rhs) { return comp(lhs.first, rhs.first); });
+            elems.erase(std::unique(elems.begin(), elems.end(),
+                [&](const value_type& lhs, const value_type& rhs) { return !comp(lhs.first, rhs.first); }), elems.end());
+            return elems;
+        }
+
+        // elems is sorted and unique, on equivalent keys the existing element wins
+        void merge_sorted(std::vector<value_type> elems) {
+            if (elems.empty())
+                return;
+
+            auto& comp = this->GetCompare();
+            if (empty() || comp(m_keys.back(), elems.front().first)) { // append
+                for (auto& elem : elems) {
+                    m_keys.push_back(std::move(elem.first));
+                    m_values.push_back(std::move(elem.second));
+                }
+                return;
+            }
+
+            key_container_type keys;
+            mapped_container_type values;
+            auto push = [&](auto&& key, auto&& value) {
+                keys.push_back(std::forward<decltype(key)>(key));
+                values.push_back(std::forward<decltype(value)>(value));
+            };
+
+            size_type i = 0;
+            auto cursor = elems.begin();
+            while (i < size() && cursor != elems.end()) {
+                if (comp(cursor->first, m_keys[i])) {
+                    push(std::move(cursor->first), std::move(cursor->second));
+                    ++cursor;
+                }
+                else {
+                    if (!comp(m_keys[i], cursor->first)) // equivalent
+                        ++cursor;
+                    push(std::move(m_keys[i]), std::move(m_values[i]));
+                    ++i;
+                }
+            }
+            for (; i < size(); ++i)
+                push(std::move(m_keys[i]), std::move(m_values[i]));
+            for (; cursor != elems.end(); ++cursor)
+                push(std::move(cursor->first), std::move(cursor->second));
+
+            m_keys = std::move(keys);
+            m_values = std::move(values);
+        }
+
+        key_container_type m_keys;
+        mapped_container_type m_values;
+    };
+
+    template <template<typename>class Vector, typename Key, typename T, typename Compare>
+    bool operator==(const basic_flat_soa_map<Vector, Key, T, Compare>& lhs, const basic_flat_soa_map<Vector, Key, T, Compare>& rhs) {
+        return lhs.size() == rhs.size()
+            && std::equal(lhs.keys().begin(), lhs.keys().end(), rhs.keys().begin())
+            && std::equal(lhs.values().begin(), lhs.values().end(), rhs.values().begin());
+    }
+
+    template <template<typename>class Vector, typename Key, typename T, typename Compare>
+    bool operator<(const basic_flat_soa_map<Vector, Key, T, Compare>& lhs, const basic_flat_soa_map<Vector, Key, T, Compare>& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template <template<typename>class Vector, typename Key, typename T, typename Compare>
+    bool operator!=(const basic_flat_soa_map<Vector, Key, T, Compare>& lhs, const basic_flat_soa_map<Vector, Key, T, Compare>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <template<typename>class Vector, typename Key, typename T, typename Compare>
+    bool operator>(const basic_flat_soa_map<Vector, Key, T, Compare>& lhs, const basic_flat_soa_map<Vector, Key, T, Compare>& rhs) {
+        return rhs < lhs;
+    }
+
+    template <template<typename>class Vector, typename Key, typename T, typename Compare>
+    bool operator<=(const basic_flat_soa_map<Vector, Key, T, Compare>& lhs, const basic_flat_soa_map<Vector, Key, T, Compare>& rhs) {
+        return !(rhs < lhs);
+    }
+
+    template <template<typename>class Vector, typename Key, typename T, typename Compare>
+    bool operator>=(const basic_flat_soa_map<Vector, Key, T, Compare>& lhs, const basic_flat_soa_map<Vector, Key, T, Compare>& rhs) {
+        return !(lhs < rhs);
+    }
+}
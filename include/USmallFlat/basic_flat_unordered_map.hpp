@@ -0,0 +1,100 @@
+#pragma once
+
+#include "details/flat_unordered_base.hpp"
+
+#include <stdexcept>
+#include <tuple>
+
+namespace Ubpa {
+    // an unordered map of contiguous elements, see details::flat_unordered_base
+    // - Vector: storage of the elements
+    // - TableVector: storage of the hash table (one control byte and one index per slot)
+    template<template<typename>class Vector, template<typename>class TableVector,
+        typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class basic_flat_unordered_map
+        : public details::flat_unordered_base<Vector, TableVector, Key, std::pair<Key, T>, std::pair<const Key, T>, Hash, KeyEqual>
+    {
+        using mybase = details::flat_unordered_base<Vector, TableVector, Key, std::pair<Key, T>, std::pair<const Key, T>, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using mybase::insert;
+        using typename mybase::key_type;
+        using typename mybase::value_type;
+        using typename mybase::iterator;
+        using mapped_type = T;
+
+        basic_flat_unordered_map(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : mybase(ilist, hash, equal) {}
+
+        //
+        // Element access
+        ///////////////////
+
+        T& at(const key_type& key) {
+            if (auto target = mybase::find(key); target != mybase::end())
+                return target->second;
+            throw std::out_of_range("invalid basic_flat_unordered_map subscript");
+        }
+
+        const T& at(const key_type& key) const { return const_cast<basic_flat_unordered_map*>(this)->at(key); }
+
+        T& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        T& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        //
+        // Modifiers
+        //////////////
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return mybase::insert_unique(value.first, [&]() { return std::pair<Key, T>(value); });
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return mybase::insert_unique(value.first, [&]() { return std::pair<Key, T>(std::move(value)); });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            std::pair<Key, T> value(std::forward<Args>(args)...);
+            return mybase::insert_unique(value.first, [&]() -> std::pair<Key, T>&& { return std::move(value); });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) {
+            return try_emplace_impl(k, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) {
+            return try_emplace_impl(std::move(k), std::forward<Args>(args)...);
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& obj) {
+            return insert_or_assign_impl(k, std::forward<M>(obj));
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M&& obj) {
+            return insert_or_assign_impl(std::move(k), std::forward<M>(obj));
+        }
+
+    private:
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+            return mybase::insert_unique(k, [&]() {
+                return std::pair<Key, T>(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template<typename K, typename M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& k, M&& obj) {
+            auto rst = mybase::insert_unique(k, [&]() { return std::pair<Key, T>(std::forward<K>(k), std::forward<M>(obj)); });
+            if (!rst.second)
+                rst.first->second = std::forward<M>(obj);
+            return rst;
+        }
+    };
+}
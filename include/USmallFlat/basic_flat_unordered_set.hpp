@@ -0,0 +1,35 @@
+#pragma once
+
+#include "details/flat_unordered_base.hpp"
+
+namespace Ubpa {
+    // an unordered set of contiguous elements, see details::flat_unordered_base
+    // - Vector: storage of the elements
+    // - TableVector: storage of the hash table (one control byte and one index per slot)
+    template<template<typename>class Vector, template<typename>class TableVector,
+        typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class basic_flat_unordered_set : public details::flat_unordered_base<Vector, TableVector, Key, Key, Key, Hash, KeyEqual> {
+        using mybase = details::flat_unordered_base<Vector, TableVector, Key, Key, Key, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using mybase::insert;
+        using typename mybase::value_type;
+        using typename mybase::iterator;
+
+        basic_flat_unordered_set(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : mybase(ilist, hash, equal) {}
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            return mybase::insert_unique(value, [&]() -> const value_type& { return value; });
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            return mybase::insert_unique(value, [&]() -> value_type&& { return std::move(value); });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+    };
+}
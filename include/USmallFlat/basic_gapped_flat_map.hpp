@@ -0,0 +1,94 @@
+#pragma once
+
+#include "details/flat_base_multimap.hpp"
+#include "details/gapped_flat_base.hpp"
+
+namespace Ubpa {
+    // a sorted map with gaps between its elements (packed memory array) for large maps under a mix of inserts and lookups,
+    // inserts move amortized O(log^2(n)) elements, iteration skips the gaps, see details::gapped_flat_base
+    // require
+    // - Key and T are default constructible
+    template<template<typename>class Vector, typename Key, typename T, typename Compare = std::less<Key>>
+    class basic_gapped_flat_map : public details::gapped_flat_base<Vector, std::pair<Key, T>, std::pair<const Key, T>, details::flat_base_multimap_comp<Key, T, Compare>> {
+        using mybase = details::gapped_flat_base<Vector, std::pair<Key, T>, std::pair<const Key, T>, details::flat_base_multimap_comp<Key, T, Compare>>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using typename mybase::key_type;
+        using mapped_type = T;
+        using typename mybase::value_type;
+        using typename mybase::iterator;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        using mybase::mybase;
+
+        //
+        // Element access
+        ///////////////////
+
+        mapped_type& at(const key_type& key) {
+            auto target = mybase::find(key);
+            if (target == mybase::end())
+                throw std::out_of_range("invalid basic_gapped_flat_map subscript");
+            return target->second;
+        }
+
+        const mapped_type& at(const key_type& key) const { return const_cast<basic_gapped_flat_map*>(this)->at(key); }
+
+        mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        //
+        // Modifiers
+        //////////////
+
+        using mybase::insert;
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, std::move(value.second)); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            std::pair<Key, T> value(std::forward<Args>(args)...);
+            return mybase::insert_unique(value.first, [&]() { return std::move(value); });
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& m) { return insert_or_assign_impl(k, std::forward<M>(m)); }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M&& m) { return insert_or_assign_impl(std::move(k), std::forward<M>(m)); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args)
+        { return try_emplace_impl(k, std::forward<Args>(args)...); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args)
+        { return try_emplace_impl(std::move(k), std::forward<Args>(args)...); }
+
+    private:
+        // k and args are only consumed if k is inserted
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+            return mybase::insert_unique(k, [&]() {
+                return std::pair<Key, T>(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template<typename K, typename M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& k, M&& m) {
+            auto rst = try_emplace_impl(std::forward<K>(k), std::forward<M>(m));
+            if (!rst.second)
+                rst.first->second = std::forward<M>(m);
+            return rst;
+        }
+    };
+}
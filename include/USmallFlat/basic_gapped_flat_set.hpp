@@ -0,0 +1,42 @@
+#pragma once
+
+#include "details/gapped_flat_base.hpp"
+
+namespace Ubpa {
+    // a sorted set with gaps between its elements (packed memory array) for large sets under a mix of inserts and lookups,
+    // inserts move amortized O(log^2(n)) elements, iteration skips the gaps, see details::gapped_flat_base
+    // require
+    // - Key is default constructible
+    template<template<typename>class Vector, typename Key, typename Compare = std::less<Key>>
+    class basic_gapped_flat_set : public details::gapped_flat_base<Vector, Key, Key, Compare> {
+        using mybase = details::gapped_flat_base<Vector, Key, Key, Compare>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using typename mybase::value_type;
+        using typename mybase::iterator;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        using mybase::mybase;
+
+        //
+        // Modifiers
+        //////////////
+
+        using mybase::insert;
+
+        std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+        std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            value_type value(std::forward<Args>(args)...);
+            return mybase::insert_unique(value, [&]() { return std::move(value); });
+        }
+    };
+}
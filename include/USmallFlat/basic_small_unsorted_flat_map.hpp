@@ -0,0 +1,302 @@
+#pragma once
+
+#include "details/flat_base_multimap.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Ubpa {
+    // a flat map for many tiny maps under inserts
+    // - up to N elements: unsorted in append order, inserts are O(1) appends and lookups are linear scans
+    // - the insert past N sorts the elements once, from then on it is a sorted flat map until clear()
+    // with a small_vector of N inline elements the sort happens exactly when the elements spill to the heap
+    // require
+    // - Vector<std::pair<Key, T>> is contiguous
+    template<template<typename>class Vector, typename Key, typename T, typename Compare = std::less<Key>, std::size_t N = 8>
+    class basic_small_unsorted_flat_map : private details::flat_base_multimap_comp_storage<Compare> {
+        using comp_storage = details::flat_base_multimap_comp_storage<Compare>;
+        using slot_type = std::pair<Key, T>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using container_type = Vector<slot_type>;
+
+        static constexpr std::size_t unsorted_capacity = N;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        basic_small_unsorted_flat_map() : comp_storage(Compare()) {}
+
+        explicit basic_small_unsorted_flat_map(const Compare& comp) : comp_storage(comp) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        basic_small_unsorted_flat_map(Iter first, Iter last, const Compare& comp = Compare()) : comp_storage(comp) { insert(first, last); }
+
+        basic_small_unsorted_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : basic_small_unsorted_flat_map(ilist.begin(), ilist.end(), comp) {}
+
+        basic_small_unsorted_flat_map(const basic_small_unsorted_flat_map&) = default;
+
+        basic_small_unsorted_flat_map(basic_small_unsorted_flat_map&& other) noexcept :
+            comp_storage(static_cast<comp_storage&&>(other)),
+            m_storage(std::move(other.m_storage)),
+            m_sorted(other.m_sorted)
+        {
+            other.clear();
+        }
+
+        basic_small_unsorted_flat_map& operator=(const basic_small_unsorted_flat_map&) = default;
+
+        basic_small_unsorted_flat_map& operator=(basic_small_unsorted_flat_map&& rhs) noexcept {
+            static_cast<comp_storage&>(*this) = static_cast<comp_storage&&>(rhs);
+            m_storage = std::move(rhs.m_storage);
+            m_sorted = rhs.m_sorted;
+            rhs.clear();
+            return *this;
+        }
+
+        //
+        // Element access
+        ///////////////////
+
+        mapped_type& at(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                throw std::out_of_range("invalid basic_small_unsorted_flat_map subscript");
+            return target->second;
+        }
+
+        const mapped_type& at(const key_type& key) const { return const_cast<basic_small_unsorted_flat_map*>(this)->at(key); }
+
+        mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        //
+        // Iterators
+        //////////////
+        // in key order if sorted(), else in insertion order until an erase
+
+        iterator begin() noexcept { return reinterpret_cast<iterator>(m_storage.data()); }
+        const_iterator begin() const noexcept { return reinterpret_cast<const_iterator>(m_storage.data()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return begin() + m_storage.size(); }
+        const_iterator end() const noexcept { return begin() + m_storage.size(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        //
+        // Capacity
+        /////////////
+
+        [[nodiscard]] bool empty() const noexcept { return m_storage.empty(); }
+
+        size_type size() const noexcept { return m_storage.size(); }
+
+        size_type max_size() const noexcept { return m_storage.max_size(); }
+
+        // whether the elements are in key order (once more than N elements were inserted)
+        bool sorted() const noexcept { return m_sorted; }
+
+        //
+        // Modifiers
+        //////////////
+
+        // back to the unsorted mode
+        void clear() noexcept {
+            m_storage.clear();
+            m_sorted = false;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, std::move(value.second)); }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            slot_type value(std::forward<Args>(args)...);
+            return insert_unique(value.first, [&]() -> slot_type&& { return std::move(value); });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) { return try_emplace_impl(k, std::forward<Args>(args)...); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) { return try_emplace_impl(std::move(k), std::forward<Args>(args)...); }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& m) { return insert_or_assign_impl(k, std::forward<M>(m)); }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M&& m) { return insert_or_assign_impl(std::move(k), std::forward<M>(m)); }
+
+        // unsorted: the last element is moved to pos, returns pos (or end())
+        // sorted: returns the iterator following the removed element
+        iterator erase(const_iterator pos) {
+            const auto index = static_cast<size_type>(pos - begin());
+            if (m_sorted)
+                m_storage.erase(m_storage.begin() + index);
+            else {
+                if (index != size() - 1)
+                    m_storage[index] = std::move(m_storage.back());
+                m_storage.pop_back();
+            }
+            return begin() + index;
+        }
+
+        size_type erase(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                return 0;
+            erase(target);
+            return 1;
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        iterator find(const key_type& key) {
+            if (!m_sorted) {
+                if constexpr (enable_branchless_search_v<Key, Compare>) {
+                    // scans all of the at most N keys without an early exit, a select instead of a mispredicted branch
+                    size_type index = size();
+                    for (size_type i = size(); i-- > 0;)
+                        index = equal(m_storage[i].first, key) ? i : index;
+                    return begin() + index;
+                }
+                else
+                    return std::find_if(begin(), end(), [&](const value_type& value) { return equal(value.first, key); });
+            }
+            auto target = lower_bound(key);
+            return target != end() && !key_comp()(key, target->first) ? target : end();
+        }
+
+        const_iterator find(const key_type& key) const { return const_cast<basic_small_unsorted_flat_map*>(this)->find(key); }
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        bool contains(const key_type& key) const { return find(key) != end(); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return this->GetCompare(); }
+
+    private:
+        bool equal(const key_type& lhs, const key_type& rhs) const { return !key_comp()(lhs, rhs) && !key_comp()(rhs, lhs); }
+
+        // precondition: sorted()
+        iterator lower_bound(const key_type& key) {
+            constexpr auto proj = [](const value_type& value) -> const Key& { return value.first; };
+            if constexpr (enable_branchless_search_v<Key, Compare>)
+                return details::fast_lower_bound<Key, Compare>(begin(), end(), key, proj);
+            else {
+                return std::lower_bound(begin(), end(), key,
+                    [&](const value_type& value, const key_type& k) { return this->GetCompare()(value.first, k); });
+            }
+        }
+
+        // inserts make_slot() if no element is equal to key
+        template<typename MakeSlot>
+        std::pair<iterator, bool> insert_unique(const key_type& key, MakeSlot&& make_slot) {
+            if (!m_sorted) {
+                if (auto target = find(key); target != end())
+                    return { target, false };
+                if (size() < N) {
+                    m_storage.push_back(std::forward<MakeSlot>(make_slot)());
+                    return { end() - 1, true };
+                }
+                // the insert past N, sorts once
+                std::sort(m_storage.begin(), m_storage.end(),
+                    [&](const slot_type& lhs, const slot_type& rhs) { return this->GetCompare()(lhs.first, rhs.first); });
+                m_sorted = true;
+            }
+            auto target = lower_bound(key);
+            if (target != end() && !key_comp()(key, target->first))
+                return { target, false };
+            const auto index = target - begin();
+            m_storage.insert(m_storage.begin() + index, std::forward<MakeSlot>(make_slot)());
+            return { begin() + index, true };
+        }
+
+        // k and args are only consumed if k is inserted
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+            return insert_unique(k, [&]() {
+                return slot_type(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template<typename K, typename M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& k, M&& m) {
+            auto rst = insert_unique(k, [&]() { return slot_type(std::forward<K>(k), std::forward<M>(m)); });
+            if (!rst.second)
+                rst.first->second = std::forward<M>(m);
+            return rst;
+        }
+
+        container_type m_storage;
+        bool m_sorted{ false };
+    };
+
+    // equal as maps, regardless of the order of the elements
+    template<template<typename>class Vector, typename Key, typename T, typename Compare, std::size_t N>
+    bool operator==(const basic_small_unsorted_flat_map<Vector, Key, T, Compare, N>& lhs, const basic_small_unsorted_flat_map<Vector, Key, T, Compare, N>& rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        if (lhs.sorted() && rhs.sorted())
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+        for (const auto& [key, value] : lhs) {
+            auto target = rhs.find(key);
+            if (target == rhs.end() || !(target->second == value))
+                return false;
+        }
+        return true;
+    }
+
+    template<template<typename>class Vector, typename Key, typename T, typename Compare, std::size_t N>
+    bool operator!=(const basic_small_unsorted_flat_map<Vector, Key, T, Compare, N>& lhs, const basic_small_unsorted_flat_map<Vector, Key, T, Compare, N>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "static_vector.hpp"
+#include "small_vector_policy.hpp"
+#include "details/small_vector_buffer.hpp"
 
 #include <vector>
 #include <iterator>
@@ -8,10 +10,17 @@
 #include <limits>
 
 namespace Ubpa {
-    template <template<typename>class Vector, typename T, std::size_t N = 16>
+    // Vector: the heap part, a std::vector-like container or details::small_vector_buffer
+    //         (a raw allocator-owned buffer whose elements are counted by m_size)
+    // DemotePolicy: when the elements move back to the inline buffer, see small_vector_policy.hpp
+    // GrowthPolicy: the heap capacity when the elements don't fit, see small_vector_policy.hpp
+    template <template<typename>class Vector, typename T, std::size_t N = 16,
+        typename DemotePolicy = demote_eager, typename GrowthPolicy = grow_native>
     class basic_small_vector {
         using stack_type = static_vector<T, N>;
         using heap_type = Vector<T>;
+        static constexpr bool is_buffer = details::is_small_vector_buffer_v<heap_type>;
+        using heap_holder = std::conditional_t<is_buffer, heap_type, std::optional<heap_type>>;
     public:
         //////////////////
         // Member types //
@@ -35,137 +44,119 @@ namespace Ubpa {
 
         basic_small_vector() noexcept : m_first{ m_stack.begin() }, m_size{ m_stack.size() } {};
 
-        basic_small_vector(const Vector<T>& storage) : m_heap{ storage }, m_size{ storage.size() } {
-            if (m_heap->size() <= N)
+        basic_small_vector(const Vector<T>& storage) requires (!is_buffer) :
+            m_heap{ storage }, m_first{ m_heap->data() }, m_size{ m_heap->size() }
+        {
+            if (m_size <= N)
                 re_ctor_m_stackfrom_heap();
         }
 
-        basic_small_vector(Vector<T>&& storage) noexcept : m_heap{ std::move(storage) }, m_size{ storage.size() } {
-            if (m_heap->size() <= N)
+        basic_small_vector(Vector<T>&& storage) noexcept requires (!is_buffer) :
+            m_heap{ std::move(storage) }, m_first{ m_heap->data() }, m_size{ m_heap->size() }
+        {
+            if (m_size <= N)
                 re_ctor_m_stackfrom_heap();
         }
 
-        explicit basic_small_vector(size_type count) :
-            m_stack(static_cast<typename stack_type::size_type>(count <= N ? count : 0)),
-            m_size{ count }
-        {
-            if (count > N) {
-                m_heap = heap_type(count);
-                m_first = m_heap->data();
-            }
-            else
-                m_first = m_stack.begin();
+        explicit basic_small_vector(size_type count) : m_first{ m_stack.begin() } {
+            reserve(count);
+            resize(count);
         }
 
-        basic_small_vector(size_type count, const value_type& value) :
-            m_stack(static_cast<typename stack_type::size_type>(count <= N ? count : 0), value),
-            m_size{ count }
-        {
-            if (count > N) {
-                m_heap = heap_type(count, value);
-                m_first = m_heap->data();
-            }
-            else
-                m_first = m_stack.begin();
+        basic_small_vector(size_type count, const value_type& value) : m_first{ m_stack.begin() } {
+            reserve(count);
+            resize(count, value);
         }
 
         template<typename Iter> requires std::input_iterator<Iter>
-        basic_small_vector(Iter first, Iter last) :
-            basic_small_vector(first, last, typename std::iterator_traits<Iter>::iterator_category{}) {}
+        basic_small_vector(Iter first, Iter last) : m_first{ m_stack.begin() } { assign(first, last); }
 
-        basic_small_vector(const basic_small_vector& other) :
-            m_stack(other.m_stack),
-            m_heap{other.m_heap},
-            m_first{other.is_on_stack()?m_stack.begin():m_heap->data()},
-            m_size{ other.m_size }{}
+        basic_small_vector(const basic_small_vector& other) : m_first{ m_stack.begin() } { assign(other.begin(), other.end()); }
 
         basic_small_vector(basic_small_vector&& other) noexcept :
             m_stack( std::move(other.m_stack) ),
             m_heap{ std::move(other.m_heap) },
-            m_first{ other.is_on_stack() ? m_stack.begin() : m_heap->data() },
+            m_first{ other.is_on_stack() ? m_stack.begin() : heap_data() },
             m_size{ other.m_size }
         {
-            other.m_first = m_stack.begin();
+            other.m_first = other.m_stack.begin();
+            other.m_size = 0;
         }
 
-        basic_small_vector(std::initializer_list<T> ilist) :
-            m_stack(ilist.size() <= N ? ilist : std::initializer_list<T>{}),
-            m_size{ ilist.size() }
-        {
-            if (ilist.size() > N) {
-                m_heap = heap_type(ilist);
-                m_first = m_heap->data();
+        basic_small_vector(std::initializer_list<T> ilist) : m_first{ m_stack.begin() } { assign(ilist); }
+
+        ~basic_small_vector() {
+            if constexpr (is_buffer) {
+                if (!is_on_stack())
+                    std::destroy(m_first, m_first + m_size);
             }
-            else
-                m_first = m_stack.begin();
         }
 
         basic_small_vector& operator=(const basic_small_vector& rhs) {
-            if (this != &rhs) {
-                m_stack = rhs.m_stack;
-                m_heap = rhs.m_heap;
-                if (rhs.is_on_stack())
-                    m_first = m_stack.begin();
-                else
-                    m_first = m_heap->data();
-                m_size = rhs.m_size;
-            }
+            if (this != &rhs)
+                assign(rhs.begin(), rhs.end());
             return *this;
         }
 
-        basic_small_vector& operator=(basic_small_vector&& rhs) noexcept {
+        // the inline elements are moved one by one, and a heap buffer too unless its allocator propagates or is equal
+        basic_small_vector& operator=(basic_small_vector&& rhs) noexcept(
+            std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T> && is_nothrow_heap_move_assignable())
+        {
             if (this != &rhs) {
-                m_stack = std::move(rhs.m_stack);
-                m_heap = std::move(rhs.m_heap);
-                if (rhs.is_on_stack())
-                    m_first = m_stack.begin();
-                else
-                    m_first = m_heap->data();
-                rhs.m_first = m_stack.begin();
-                m_size = rhs.m_size;
+                if constexpr (is_buffer) {
+                    using alloc_traits = std::allocator_traits<typename heap_type::allocator_type>;
+                    if (!rhs.is_on_stack()
+                        && (alloc_traits::propagate_on_container_move_assignment::value || m_heap.get_allocator() == rhs.m_heap.get_allocator()))
+                    {
+                        clear();
+                        m_heap = std::move(rhs.m_heap);
+                        m_first = m_heap.data();
+                        m_size = rhs.m_size;
+                    }
+                    else {
+                        assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+                        rhs.clear();
+                    }
+                }
+                else {
+                    m_stack = std::move(rhs.m_stack);
+                    m_heap = std::move(rhs.m_heap);
+                    if (rhs.is_on_stack())
+                        m_first = m_stack.begin();
+                    else
+                        m_first = m_heap->data();
+                    m_size = rhs.m_size;
+                }
+                rhs.m_first = rhs.m_stack.begin();
                 rhs.m_size = 0;
             }
             return *this;
         }
 
         basic_small_vector& operator=(std::initializer_list<value_type> rhs) {
-            if (rhs.size() <= N) {
-                if (m_heap.has_value())
-                    m_heap->clear();
-
-                m_stack = rhs;
-                m_first = m_stack.begin();
-            }
-            else {
-                m_stack.clear();
-                if (m_heap.has_value())
-                    *m_heap = rhs;
-                else
-                    m_heap.emplace(rhs);
-                m_first = m_heap->data();
-                m_size = rhs.m_size;
-                rhs.m_size = 0;
-            }
+            assign(rhs);
             return *this;
         }
 
         void assign(size_type count, const value_type& value) {
             if (count <= N) {
+                m_stack.assign(static_cast<typename stack_type::size_type>(count), value); // empty in heap mode
                 if (!is_on_stack())
-                    m_heap->clear();
-                m_stack.assign(static_cast<typename stack_type::size_type>(count), value);
+                    heap_clear();
                 m_first = m_stack.begin();
+                m_size = count;
             }
             else {
-                if (is_on_stack())
-                    m_stack.clear();
-                if (m_heap.has_value())
-                    m_heap->assign(count, value);
+                const value_type tmp(value); // value may refer to an element
+                clear();
+                heap_reserve(count);
+                if constexpr (is_buffer)
+                    std::uninitialized_fill_n(m_heap.data(), count, tmp);
                 else
-                    m_heap = heap_type(count, value);
-                m_first = m_heap->data();
+                    m_heap->assign(count, tmp);
+                m_first = heap_data();
+                m_size = count;
             }
-            m_size = count;
         }
 
         template<class Iter> requires std::input_iterator<Iter>
@@ -253,75 +244,97 @@ namespace Ubpa {
         size_type max_size() const noexcept { return std::numeric_limits<size_type>::max(); }
 
         void resize(size_type count) {
-            if (count <= N) {
-                if (size() > N) {
-                    m_stack.assign(std::make_move_iterator(m_heap->begin()), std::make_move_iterator(m_heap->end()));
-                    m_heap->clear();
-                    m_first = m_stack.begin();
-                }
-                else {
-                    m_stack.resize(static_cast<typename stack_type::size_type>(count));
-                }
+            if (is_on_stack() && count <= N) {
+                m_stack.resize(static_cast<typename stack_type::size_type>(count));
+                m_size = count;
             }
             else {
-                if (is_on_stack())
-                    move_stack_to_empty_heap();
-                m_heap->resize(count);
-                m_first = m_heap->data();
+                make_room_on_heap(count);
+                if constexpr (is_buffer) {
+                    if (count > m_size)
+                        std::uninitialized_value_construct(m_first + m_size, m_first + count);
+                    else
+                        std::destroy(m_first + count, m_first + m_size);
+                }
+                else
+                    m_heap->resize(count);
+                m_size = count;
+                heap_shrunk();
             }
-            m_size = count;
         }
 
         void resize(size_type count, const T& value) {
-            if (count <= N) {
-                if (size() > N) {
-                    m_stack.assign(std::make_move_iterator(m_heap->begin()), std::make_move_iterator(m_heap->end()));
-                    m_heap->clear();
-                    m_first = m_stack.begin();
-                }
-                else {
-                    m_stack.resize(static_cast<typename stack_type::size_type>(count), value);
+            if (is_on_stack() && count <= N) {
+                m_stack.resize(static_cast<typename stack_type::size_type>(count), value);
+                m_size = count;
+            }
+            else {
+                const value_type tmp(value); // value may refer to an element
+                make_room_on_heap(count);
+                if constexpr (is_buffer) {
+                    if (count > m_size)
+                        std::uninitialized_fill(m_first + m_size, m_first + count, tmp);
+                    else
+                        std::destroy(m_first + count, m_first + m_size);
                 }
+                else
+                    m_heap->resize(count, tmp);
+                m_size = count;
+                heap_shrunk();
+            }
+        }
+
+        // like resize(count), but the new elements are default-initialized (left indeterminate for trivial types),
+        // to be overwritten through data()
+        void resize_default_init(size_type count) {
+            if (is_on_stack() && count <= N) {
+                m_stack.resize_default_init(static_cast<typename stack_type::size_type>(count));
+                m_size = count;
             }
             else {
-                if (is_on_stack())
-                    move_stack_to_empty_heap();
-                m_heap->resize(count, value);
-                m_first = m_heap->data();
+                make_room_on_heap(count);
+                if constexpr (is_buffer) {
+                    if (count > m_size)
+                        std::uninitialized_default_construct(m_first + m_size, m_first + count);
+                    else
+                        std::destroy(m_first + count, m_first + m_size);
+                }
+                else
+                    m_heap->resize(count); // a std::vector-like container value-initializes
+                m_size = count;
+                heap_shrunk();
             }
-            m_size = count;
         }
 
         size_type capacity() const noexcept {
             if (is_on_stack())
                 return N;
             else
-                return m_heap->capacity();
+                return heap_capacity();
         }
 
         void reserve(size_type new_cap) {
-            if (is_on_stack()){
-                if (m_heap.has_value())
-                    m_heap->reserve(new_cap);
-                else if (new_cap > N) {
-                    m_heap = heap_type();
-                    m_heap->reserve(new_cap);
-                }
-            }
-            else {
-                m_heap->reserve(new_cap);
-                m_first = m_heap->data();
+            if (new_cap > capacity()) {
+                heap_reserve(new_cap);
+                make_room_on_heap(new_cap);
             }
         }
 
         void shrink_to_fit() {
-            if (m_heap.has_value()) {
-                if (is_on_stack())
-                    m_heap->shrink_to_fit();
-                else {
-                    m_heap->shrink_to_fit();
-                    m_first = m_heap->data();
+            if (is_on_stack())
+                heap_release();
+            else if (DemotePolicy::demote_on_shrink_to_fit && m_size <= N) {
+                re_ctor_m_stackfrom_heap();
+                heap_release();
+            }
+            else {
+                if constexpr (is_buffer) {
+                    if (m_size < m_heap.capacity())
+                        m_heap.reallocate(m_size, m_size);
                 }
+                else
+                    m_heap->shrink_to_fit();
+                m_first = heap_data();
             }
         }
 
@@ -333,7 +346,7 @@ namespace Ubpa {
             if (is_on_stack())
                 m_stack.clear();
             else
-                m_heap->clear();
+                heap_clear();
             m_first = m_stack.begin();
             m_size = 0;
         }
@@ -348,13 +361,20 @@ namespace Ubpa {
 
         iterator insert(const_iterator pos, size_type count, const value_type& value) {
             assert(begin() <= pos && pos <= end());
-            if (size() + count > N) {
-                auto offset = pos - m_first;
-                if (is_on_stack())
-                    move_stack_to_empty_heap();
-                m_heap->insert(m_heap->begin() + offset, count, value);
-                m_first = m_heap->data();
-                m_size = m_heap->size();
+            if (!is_on_stack() || size() + count > N) {
+                const auto offset = pos - m_first;
+                const value_type tmp(value); // value may refer to an element
+                make_room_on_heap(size() + count);
+                if constexpr (is_buffer) {
+                    details::uninitialized_insert(m_first + offset, m_first + m_size, count,
+                        [&](pointer dest) { std::uninitialized_fill_n(dest, count, tmp); });
+                    m_size += count;
+                }
+                else {
+                    m_heap->insert(m_heap->begin() + offset, count, tmp);
+                    m_first = m_heap->data();
+                    m_size = m_heap->size();
+                }
                 return m_first + offset;
             }
             else {
@@ -376,16 +396,21 @@ namespace Ubpa {
         template<typename... Args>
         iterator emplace(const_iterator pos, Args&&... args) {
             iterator rst;
-            const auto oldsize = size();
-            if (oldsize < N)
+            if (is_on_stack() && size() < N)
                 rst = m_stack.emplace(pos, std::forward<Args>(args)...);
             else {
                 assert(begin() <= pos && pos <= end());
-                auto offset = pos - m_first;
-                if (oldsize == N)
-                    move_stack_to_empty_heap();
-                m_heap->emplace(m_heap->begin() + offset, std::forward<Args>(args)...);
-                m_first = m_heap->data();
+                const auto offset = pos - m_first;
+                value_type tmp(std::forward<Args>(args)...); // args may refer to an element
+                make_room_on_heap(size() + 1);
+                if constexpr (is_buffer) {
+                    details::uninitialized_insert(m_first + offset, m_first + m_size, 1,
+                        [&](pointer dest) { std::construct_at(dest, std::move(tmp)); });
+                }
+                else {
+                    m_heap->insert(m_heap->begin() + offset, std::move(tmp));
+                    m_first = m_heap->data();
+                }
                 rst = m_first + offset;
             }
             ++m_size;
@@ -393,22 +418,8 @@ namespace Ubpa {
         }
 
         iterator erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
-            iterator rst;
-            if (is_on_stack())
-                rst = m_stack.erase(pos);
-            else {
-                assert(begin() <= pos && pos < end());
-                auto offset = pos - m_first;
-                m_heap->erase(m_heap->begin() + offset);
-                if (m_heap->size() == N)
-                    re_ctor_m_stackfrom_heap();
-                else
-                    m_first = m_heap->data();
-
-                rst = m_first + offset;
-            }
-            --m_size;
-            return rst;
+            assert(begin() <= pos && pos < end());
+            return erase(pos, pos + 1);
         }
 
         iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
@@ -418,67 +429,111 @@ namespace Ubpa {
                 m_size = m_stack.size();
             }
             else {
-                auto offset = first - m_first;
-                m_heap->erase(m_heap->begin() + offset, m_heap->begin() + (last - m_heap->data()));
-                m_size = m_heap->size();
-                if (m_heap->size() <= N)
-                    re_ctor_m_stackfrom_heap();
-                else
-                    m_first = m_heap->data();
+                assert(begin() <= first && first <= last && last <= end());
+                const auto offset = first - m_first;
+                if constexpr (is_buffer)
+                    m_size = static_cast<size_type>(details::erase_range(m_first + offset, m_first + (last - m_first), end()) - m_first);
+                else {
+                    m_heap->erase(m_heap->begin() + offset, m_heap->begin() + (last - m_first));
+                    m_size = m_heap->size();
+                }
+                heap_shrunk();
 
                 rst = m_first + offset;
             }
             return rst;
         }
 
-        void push_back(const value_type& value) {
-            const auto oldsize = size();
-            if (oldsize < N)
-                m_stack.push_back(value);
-            else {
-                if (oldsize == N)
-                    move_stack_to_empty_heap();
-                m_heap->push_back(value);
-                m_first = m_heap->data();
+        void push_back(const value_type& value) { emplace_back(value); }
+
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        template<typename... Args>
+        void emplace_back(Args&&... args) {
+            if (is_on_stack()) {
+                if (m_size < N) {
+                    m_stack.emplace_back(std::forward<Args>(args)...);
+                    ++m_size;
+                    return;
+                }
+            }
+            else if (m_size < heap_capacity()) {
+                if constexpr (is_buffer)
+                    std::construct_at(m_first + m_size, std::forward<Args>(args)...);
+                else
+                    m_heap->emplace_back(std::forward<Args>(args)...);
+                ++m_size;
+                return;
             }
-            ++m_size;
-        }
 
-        void push_back(T&& value) {
-            const auto oldsize = size();
-            if (oldsize < N)
-                m_stack.push_back(std::move(value));
+            value_type tmp(std::forward<Args>(args)...); // args may refer to an element
+            make_room_on_heap(size() + 1);
+            if constexpr (is_buffer)
+                std::construct_at(m_first + m_size, std::move(tmp));
             else {
-                if (oldsize == N)
-                    move_stack_to_empty_heap();
-                m_heap->push_back(std::move(value));
+                m_heap->push_back(std::move(tmp));
                 m_first = m_heap->data();
             }
             ++m_size;
         }
 
+        // precondition: size() < capacity(), e.g. after reserve()
+        void push_back_unchecked(const value_type& value) { emplace_back_unchecked(value); }
+
+        void push_back_unchecked(T&& value) { emplace_back_unchecked(std::move(value)); }
+
         template<typename... Args>
-        void emplace_back(Args&&... args) {
-            const auto oldsize = size();
-            if (oldsize < N)
+        reference emplace_back_unchecked(Args&&... args) {
+            assert(m_size < capacity());
+            if (is_on_stack())
                 m_stack.emplace_back(std::forward<Args>(args)...);
-            else {
-                if (oldsize == N)
-                    move_stack_to_empty_heap();
+            else if constexpr (is_buffer)
+                std::construct_at(m_first + m_size, std::forward<Args>(args)...);
+            else
                 m_heap->emplace_back(std::forward<Args>(args)...);
-                m_first = m_heap->data();
+            return m_first[m_size++];
+        }
+
+        // insert(end(), first, last) without the shifting, a sized range grows at most once
+        template<typename Iter> requires std::input_iterator<Iter>
+        void append(Iter first, Iter last) {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>) {
+                const auto count = convert_size(std::distance(first, last));
+                if (is_on_stack() && m_size + count <= N)
+                    m_stack.append(first, last);
+                else {
+                    make_room_on_heap(m_size + count);
+                    if constexpr (is_buffer)
+                        std::uninitialized_copy(first, last, m_first + m_size);
+                    else {
+                        m_heap->insert(m_heap->end(), first, last);
+                        m_first = m_heap->data();
+                    }
+                }
+                m_size += count;
+            }
+            else {
+                for (; first != last; ++first)
+                    emplace_back(*first);
             }
-            ++m_size;
         }
 
+        void append(std::initializer_list<value_type> ilist) { append(ilist.begin(), ilist.end()); }
+
         void pop_back() {
-            if (is_on_stack())
+            assert(!empty());
+            if (is_on_stack()) {
                 m_stack.pop_back();
-            else if (size() == N + 1)
-                re_ctor_m_stackfrom_heap();
-            else
-                m_heap->pop_back();
-            --m_size;
+                --m_size;
+            }
+            else {
+                if constexpr (is_buffer)
+                    std::destroy_at(m_first + m_size - 1);
+                else
+                    m_heap->pop_back();
+                --m_size;
+                heap_shrunk();
+            }
         }
 
         void swap(basic_small_vector& other) noexcept {
@@ -490,12 +545,12 @@ namespace Ubpa {
             if (rhs_on_stack)
                 m_first = m_stack.begin();
             else
-                m_first = m_heap->data();
+                m_first = heap_data();
 
             if (lhs_on_stack)
-                other.m_first = m_stack.begin();
+                other.m_first = other.m_stack.begin();
             else
-                other.m_first = other.m_heap->data();
+                other.m_first = other.heap_data();
 
             std::swap(m_size, other.m_size);
         };
@@ -512,65 +567,11 @@ namespace Ubpa {
             return static_cast<size_type>(s);
         }
 
-        template<typename Iter>
-        void emplace_range(Iter first, Iter last) {
-            for (; first != last && m_stack.size() < N; ++first)
-                m_stack.emplace_back(*first);
-
-            if (first != last) {
-                move_stack_to_empty_heap();
-
-                for (; first != last; ++first)
-                    m_heap->emplace_back(*first);
-
-                m_first = m_heap->data();
-                m_size = m_heap->size();
-            }
-            else{
-                m_first = m_stack.begin();
-                m_size = m_stack.size();
-            }
-        }
-
-        template<typename Iter>
-        basic_small_vector(Iter first, Iter last, std::input_iterator_tag) { emplace_range(first, last); }
-
-        template<typename Iter>
-        basic_small_vector(Iter first, Iter last, std::forward_iterator_tag) {
-            m_size = convert_size(std::distance(first, last));
-            if (m_size > N) {
-                m_heap = heap_type(first, last);
-                m_first = m_heap->data();
-            }
-            else {
-                m_stack.assign(first, last);
-                m_first = m_stack.begin();
-            }
-        }
-
         template<typename Iter>
         void assign_range(Iter first, Iter last, std::input_iterator_tag) { // assign input range [first, last)
-            size_type cnt = 0;
-            while (first != last) {
-                if (cnt < m_stack.max_size()) {
-                    if (cnt < m_stack.m_size)
-                        m_stack[cnt] = *first;
-                    else
-                        std::construct_at(m_stack.data() + cnt, *first);
-                }
-                else if (cnt == m_stack.max_size()) {
-                    move_stack_to_empty_heap();
-                    m_heap->insert(m_heap->end(), first, last);
-                    m_size = m_heap->size();
-                    return;
-                }
-
-                ++cnt;
-                ++first;
-            }
-            if (cnt < m_size)
-                m_stack.erase(m_stack.begin() + cnt, m_stack.end());
-            m_size = cnt;
+            clear();
+            for (; first != last; ++first)
+                emplace_back(*first);
         }
 
         template <class Iter>
@@ -578,17 +579,17 @@ namespace Ubpa {
             const auto newsize = convert_size(std::distance(first, last));
             
             if (newsize > N) {
-                m_stack.clear();
-                if (m_heap.has_value())
-                    m_heap->assign(first, last);
+                clear();
+                heap_reserve(newsize);
+                if constexpr (is_buffer)
+                    std::uninitialized_copy(first, last, m_heap.data());
                 else
-                    m_heap = heap_type(first, last);
-
-                m_first = m_heap->data();
+                    m_heap->assign(first, last);
+                m_first = heap_data();
             }
             else {
-                if (m_heap.has_value())
-                    m_heap->clear();
+                if (!is_on_stack())
+                    clear();
                 m_stack.assign(first, last);
                 m_first = m_stack.begin();
             }
@@ -603,106 +604,188 @@ namespace Ubpa {
                 return const_cast<iterator>(pos); // nothing to do, avoid invalidating iterators
 
             const auto whereoff = static_cast<size_type>(pos - m_first);
-            if (is_on_stack()) {
-                const auto oldsize = size();
+            const auto oldsize = size();
+            for (; first != last; ++first)
+                emplace_back(*first);
+            std::rotate(m_first + whereoff, m_first + oldsize, end());
 
-                for (; first != last && m_stack.size() < N; ++first)
-                    m_stack.emplace_back(*first);
+            return m_first + whereoff;
+        }
 
-                if (first != last) {
-                    move_stack_to_empty_heap();
+        template<typename Iter>
+        iterator insert_range(const_iterator pos, Iter first, Iter last, std::forward_iterator_tag) {
+            const auto count = convert_size(std::distance(first, last));
+            auto offset = pos - m_first;
+            if (!is_on_stack() || size() + count > N) {
+                assert(begin() <= pos && pos <= end());
+                make_room_on_heap(size() + count);
 
-                    for (; first != last; ++first)
-                        m_heap->emplace_back(*first);
-                    m_first = m_heap->data();
-                    m_size = m_heap->size();
-                    std::rotate(m_heap->begin() + whereoff, m_heap->begin() + oldsize, m_heap->end());
+                if constexpr (is_buffer) {
+                    details::uninitialized_insert(m_first + offset, m_first + m_size, count,
+                        [&](pointer dest) { std::uninitialized_copy(first, last, dest); });
+                    m_size += count;
                 }
                 else {
-                    m_size = m_stack.size();
-                    std::rotate(m_first + whereoff, m_first + oldsize, m_stack.end());
+                    m_heap->insert(m_heap->begin() + offset, first, last);
+                    m_first = m_heap->data();
+                    m_size = m_heap->size();
                 }
             }
             else {
-                m_heap->insert(m_heap->begin() + whereoff, first, last);
-                m_first = m_heap->data();
-                m_size = m_heap->size();
+                m_stack.insert(pos, first, last);
+                m_size = m_stack.size();
             }
+            return m_first + offset;
+        }
 
-            return m_first + whereoff;
+        //
+        // Heap part
+        //////////////
+        // in heap mode the heap part holds the m_size elements, otherwise it holds none
+
+        pointer heap_data() noexcept {
+            if constexpr (is_buffer)
+                return m_heap.data();
+            else
+                return m_heap->data();
         }
 
-        template<typename Iter>
-        iterator insert_range(const_iterator pos, Iter first, Iter last, std::forward_iterator_tag) {
-            const auto count = convert_size(std::distance(first, last));
-            auto offset = pos - m_first;
-            if (size() + count > N) {
-                if (is_on_stack()) {
-                    assert(m_stack.begin() <= pos && pos <= m_stack.end());
-                    move_stack_to_empty_heap();
-                }
+        size_type heap_capacity() const noexcept {
+            if constexpr (is_buffer)
+                return m_heap.capacity();
+            else
+                return m_heap.has_value() ? m_heap->capacity() : 0;
+        }
 
-                m_heap->insert(m_heap->begin() + offset, first, last);
-                m_first = m_heap->data();
-                m_size = m_heap->size();
+        // whether move assignment takes over the heap part of rhs without allocating
+        static constexpr bool is_nothrow_heap_move_assignable() noexcept {
+            if constexpr (is_buffer) {
+                using alloc_traits = std::allocator_traits<typename heap_type::allocator_type>;
+                return alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value;
+            }
+            else
+                return std::is_nothrow_move_assignable_v<heap_holder>;
+        }
+
+        // destroys the elements in heap mode, the caller updates m_first and m_size
+        void heap_clear() noexcept {
+            if constexpr (is_buffer)
+                std::destroy(m_first, m_first + m_size);
+            else
+                m_heap->clear();
+        }
+
+        // frees the heap memory while the elements are inline
+        void heap_release() noexcept {
+            if constexpr (is_buffer)
+                m_heap.release();
+            else if (m_heap.has_value())
+                m_heap->shrink_to_fit();
+        }
+
+        // exactly new_cap
+        void heap_reserve(size_type new_cap) {
+            if constexpr (is_buffer) {
+                if (new_cap > m_heap.capacity())
+                    m_heap.reallocate(is_on_stack() ? 0 : m_size, new_cap);
             }
             else {
-                m_stack.insert(pos, first, last);
-                m_size = m_stack.size();
+                if (!m_heap.has_value())
+                    m_heap.emplace();
+                m_heap->reserve(new_cap);
             }
-            return m_first + offset;
+            if (!is_on_stack())
+                m_first = heap_data();
+        }
+
+        // at least required, as GrowthPolicy decides (a buffer defaults to doubling)
+        void heap_grow(size_type required) {
+            if (required <= heap_capacity())
+                return;
+
+            if constexpr (is_buffer) {
+                if constexpr (std::is_same_v<GrowthPolicy, grow_native>)
+                    heap_reserve(std::max(required, 2 * capacity()));
+                else
+                    heap_reserve(GrowthPolicy::grow(capacity(), required, N));
+            }
+            else if constexpr (!std::is_same_v<GrowthPolicy, grow_native>)
+                heap_reserve(GrowthPolicy::grow(capacity(), required, N));
+        }
+
+        // the heap part lost elements (m_size is up to date), ask DemotePolicy whether to move back
+        void heap_shrunk() noexcept {
+            if (DemotePolicy::demote(m_size, N))
+                re_ctor_m_stackfrom_heap();
+            else
+                m_first = heap_data();
         }
 
         void re_ctor_m_stackfrom_heap() noexcept {
-            assert(m_stack.empty());
-            new(&m_stack)stack_type(std::make_move_iterator(m_first), std::make_move_iterator(m_first + std::min(m_heap->size(), N)));
-            m_heap->clear();
+            assert(m_stack.empty() && m_size <= N);
+            new(&m_stack)stack_type(std::make_move_iterator(m_first), std::make_move_iterator(m_first + m_size));
+            heap_clear();
             m_first = m_stack.begin();
         }
 
-        void move_stack_to_empty_heap() {
-            if (m_heap.has_value()) {
+        // switches to heap mode with room for at least required elements, m_first points at the heap part
+        void make_room_on_heap(size_type required) {
+            if (is_on_stack())
+                move_stack_to_empty_heap(required);
+            else
+                heap_grow(required);
+            m_first = heap_data();
+        }
+
+        void move_stack_to_empty_heap(size_type required) {
+            if constexpr (is_buffer) {
+                heap_grow(required);
+                details::uninitialized_relocate(m_stack.begin(), m_stack.end(), m_heap.data());
+                new(&m_stack)stack_type(); // the elements are relocated, don't destroy them
+            }
+            else {
+                if (!m_heap.has_value())
+                    m_heap.emplace();
                 assert(m_heap->empty());
+                heap_grow(required);
                 m_heap->assign(std::make_move_iterator(m_stack.begin()), std::make_move_iterator(m_stack.end()));
+                m_stack.clear();
             }
-            else
-                m_heap = heap_type(std::make_move_iterator(m_stack.begin()), std::make_move_iterator(m_stack.end()));
-            m_stack.clear();
         }
 
         stack_type m_stack;
-        std::optional<heap_type> m_heap;
+        heap_holder m_heap;
         pointer m_first{ nullptr };
         size_type m_size{ 0 };
     };
 
-    template<template<typename>class Vector, typename T, std::size_t N>
-    bool operator==(const basic_small_vector<Vector, T, N>& lhs, const basic_small_vector<Vector, T, N>& rhs) {
+    template<template<typename>class Vector, typename T, std::size_t N, typename DemotePolicy, typename GrowthPolicy>
+    bool operator==(const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& lhs, const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& rhs) {
         return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template<template<typename>class Vector, typename T, std::size_t N>
-    bool operator<(const basic_small_vector<Vector, T, N>& lhs, const basic_small_vector<Vector, T, N>& rhs) {
+    template<template<typename>class Vector, typename T, std::size_t N, typename DemotePolicy, typename GrowthPolicy>
+    bool operator<(const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& lhs, const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& rhs) {
         return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template<template<typename>class Vector, typename T, std::size_t N>
-    bool operator!=(const basic_small_vector<Vector, T, N>& lhs, const basic_small_vector<Vector, T, N>& rhs) {
+    template<template<typename>class Vector, typename T, std::size_t N, typename DemotePolicy, typename GrowthPolicy>
+    bool operator!=(const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& lhs, const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& rhs) {
         return !(lhs == rhs);
     }
 
-    template<template<typename>class Vector, typename T, std::size_t N>
-    bool operator>(const basic_small_vector<Vector, T, N>& lhs, const basic_small_vector<Vector, T, N>& rhs) {
+    template<template<typename>class Vector, typename T, std::size_t N, typename DemotePolicy, typename GrowthPolicy>
+    bool operator>(const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& lhs, const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& rhs) {
         return rhs < lhs;
     }
 
-    template<template<typename>class Vector, typename T, std::size_t N>
-    bool operator<=(const basic_small_vector<Vector, T, N>& lhs, const basic_small_vector<Vector, T, N>& rhs) {
+    template<template<typename>class Vector, typename T, std::size_t N, typename DemotePolicy, typename GrowthPolicy>
+    bool operator<=(const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& lhs, const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& rhs) {
         return !(rhs < lhs);
     }
 
-    template<template<typename>class Vector, typename T, std::size_t N>
-    bool operator>=(const basic_small_vector<Vector, T, N>& lhs, const basic_small_vector<Vector, T, N>& rhs) {
+    template<template<typename>class Vector, typename T, std::size_t N, typename DemotePolicy, typename GrowthPolicy>
+    bool operator>=(const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& lhs, const basic_small_vector<Vector, T, N, DemotePolicy, GrowthPolicy>& rhs) {
         return !(lhs < rhs);
     }
 }
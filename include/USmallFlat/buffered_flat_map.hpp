@@ -0,0 +1,18 @@
+#pragma once
+
+#include "basic_buffered_flat_map.hpp"
+
+#include "details/vector_bind.hpp"
+
+namespace Ubpa {
+    template<typename Key, typename T, std::size_t N = 64, typename Compare = std::less<Key>, template<typename>class TAllocator = std::allocator>
+    class buffered_flat_map : public basic_buffered_flat_map<details::Tvector_bind<TAllocator>::template Ttype, Key, T, Compare, N> {
+        using mybase = basic_buffered_flat_map<details::Tvector_bind<TAllocator>::template Ttype, Key, T, Compare, N>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        buffered_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : mybase(ilist, comp) {}
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "basic_buffered_flat_set.hpp"
+
+#include "details/vector_bind.hpp"
+
+namespace Ubpa {
+    template<typename Key, std::size_t N = 64, typename Compare = std::less<Key>, template<typename>class TAllocator = std::allocator>
+    class buffered_flat_set : public basic_buffered_flat_set<details::Tvector_bind<TAllocator>::template Ttype, Key, Compare, N> {
+        using mybase = basic_buffered_flat_set<details::Tvector_bind<TAllocator>::template Ttype, Key, Compare, N>;
+    public:
+        using mybase::mybase;
+
+        buffered_flat_set(std::initializer_list<Key> ilist, const Compare& comp = Compare())
+            : mybase(ilist, comp) {}
+    };
+}
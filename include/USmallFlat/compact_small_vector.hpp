@@ -0,0 +1,679 @@
+#pragma once
+
+#include "details/relocate.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <iterator>
+#include <concepts>
+#include <type_traits>
+#include <limits>
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 26495 )
+#endif
+
+namespace Ubpa::details {
+    template<typename Allocator, bool = std::is_empty_v<Allocator> && !std::is_final_v<Allocator>>
+    class compact_small_vector_base : private Allocator {
+    protected:
+        template<typename Alloc>
+        constexpr compact_small_vector_base(Alloc&& a) noexcept(std::is_nothrow_constructible_v<Allocator, Alloc>) :
+            Allocator{ std::forward<Alloc>(a) } {}
+
+        constexpr Allocator& GetAllocator() noexcept { return *this; }
+        constexpr const Allocator& GetAllocator() const noexcept { return *this; }
+    };
+
+    template<typename Allocator>
+    class compact_small_vector_base<Allocator, false> {
+    protected:
+        template<typename Alloc>
+        constexpr compact_small_vector_base(Alloc&& a) noexcept(std::is_nothrow_constructible_v<Allocator, Alloc>) :
+            alloc{ std::forward<Alloc>(a) } {}
+
+        constexpr Allocator& GetAllocator() noexcept { return alloc; }
+        constexpr const Allocator& GetAllocator() const noexcept { return alloc; }
+    private:
+        Allocator alloc;
+    };
+
+    // the inline buffer and the heap pointer share storage, so the whole object is
+    // max(sizeof(T) * N, sizeof(T*)) plus a size and a capacity (plus a stateful allocator)
+    template<typename T, std::size_t N>
+    constexpr std::size_t compact_small_vector_size =
+        (std::max(sizeof(T) * N, sizeof(T*)) + alignof(std::size_t) - 1) / alignof(std::size_t) * alignof(std::size_t)
+        + 2 * sizeof(std::size_t);
+}
+
+namespace Ubpa {
+    // small vector whose inline buffer overlaps the heap pointer
+    // - capacity() == N <=> elements are inline
+    // - never moves back to the inline buffer, except shrink_to_fit()
+    template <typename T, std::size_t N = 16, typename Allocator = std::allocator<T>>
+    class compact_small_vector : private details::compact_small_vector_base<Allocator> {
+        static_assert(N > 0);
+        using mybase = details::compact_small_vector_base<Allocator>;
+        using alloc_traits = std::allocator_traits<Allocator>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        compact_small_vector() noexcept(std::is_nothrow_default_constructible_v<Allocator>) : mybase(Allocator()) {}
+
+        explicit compact_small_vector(const Allocator& alloc) noexcept : mybase(alloc) {}
+
+        // the constructors that build elements delegate, so the destructor frees the buffer if one throws
+        explicit compact_small_vector(size_type count, const Allocator& alloc = Allocator()) : compact_small_vector(alloc) {
+            reserve(count);
+            std::uninitialized_value_construct_n(data(), count);
+            m_size = count;
+        }
+
+        compact_small_vector(size_type count, const value_type& value, const Allocator& alloc = Allocator()) : compact_small_vector(alloc) {
+            reserve(count);
+            std::uninitialized_fill_n(data(), count, value);
+            m_size = count;
+        }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        compact_small_vector(Iter first, Iter last, const Allocator& alloc = Allocator()) : compact_small_vector(alloc) {
+            insert_range(end(), first, last, typename std::iterator_traits<Iter>::iterator_category{});
+        }
+
+        compact_small_vector(const compact_small_vector& other) :
+            compact_small_vector(alloc_traits::select_on_container_copy_construction(other.GetAllocator()))
+        {
+            reserve(other.m_size);
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            m_size = other.m_size;
+        }
+
+        // the inline elements are moved one by one
+        compact_small_vector(compact_small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) :
+            mybase(std::move(other.GetAllocator()))
+        {
+            if (other.is_inline()) {
+                details::uninitialized_relocate(other.begin(), other.end(), data());
+                m_size = other.m_size;
+                other.m_size = 0;
+            }
+            else {
+                m_heap = other.m_heap;
+                m_size = other.m_size;
+                m_capacity = other.m_capacity;
+                other.m_size = 0;
+                other.m_capacity = N;
+            }
+        }
+
+        compact_small_vector(std::initializer_list<value_type> ilist, const Allocator& alloc = Allocator()) :
+            compact_small_vector(ilist.begin(), ilist.end(), alloc) {}
+
+        ~compact_small_vector() {
+            static_assert(!std::is_empty_v<Allocator> || alignof(T) > alignof(std::size_t)
+                || sizeof(compact_small_vector) == details::compact_small_vector_size<T, N>);
+            std::destroy(begin(), end());
+            if (!is_inline())
+                deallocate(m_heap, m_capacity);
+        }
+
+        compact_small_vector& operator=(const compact_small_vector& rhs) {
+            if (this != &rhs)
+                assign(rhs.begin(), rhs.end());
+            return *this;
+        }
+
+        // steals the heap buffer of rhs if the allocators propagate or are equal,
+        // otherwise moves the elements one by one (which allocates for a heap rhs and unequal allocators)
+        compact_small_vector& operator=(compact_small_vector&& rhs) noexcept(
+            (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+            && std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)
+        {
+            if (this != &rhs) {
+                if (!rhs.is_inline()
+                    && (alloc_traits::propagate_on_container_move_assignment::value || this->GetAllocator() == rhs.GetAllocator()))
+                {
+                    std::destroy(begin(), end());
+                    if (!is_inline())
+                        deallocate(m_heap, m_capacity);
+                    if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+                        this->GetAllocator() = std::move(rhs.GetAllocator());
+                    m_heap = rhs.m_heap;
+                    m_size = rhs.m_size;
+                    m_capacity = rhs.m_capacity;
+                    rhs.m_size = 0;
+                    rhs.m_capacity = N;
+                }
+                else {
+                    assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+                    rhs.clear();
+                }
+            }
+            return *this;
+        }
+
+        compact_small_vector& operator=(std::initializer_list<value_type> rhs) {
+            assign(rhs.begin(), rhs.end());
+            return *this;
+        }
+
+        void assign(size_type count, const value_type& value) {
+            if (count > m_capacity) {
+                compact_small_vector tmp(count, value, this->GetAllocator());
+                swap(tmp);
+                return;
+            }
+
+            if (count > m_size) {
+                std::fill(begin(), end(), value);
+                std::uninitialized_fill(end(), begin() + count, value);
+            }
+            else {
+                std::fill(begin(), begin() + count, value);
+                std::destroy(begin() + count, end());
+            }
+            m_size = count;
+        }
+
+        template<class Iter> requires std::input_iterator<Iter>
+        void assign(Iter first, Iter last) {
+            assign_range(first, last, typename std::iterator_traits<Iter>::iterator_category{});
+        }
+
+        void assign(std::initializer_list<T> ilist) {
+            assign_range(ilist.begin(), ilist.end(), std::random_access_iterator_tag{});
+        }
+
+        allocator_type get_allocator() const noexcept { return this->GetAllocator(); }
+
+        //
+        // Element access
+        ///////////////////
+
+        reference at(size_type pos) {
+            if (pos >= size())
+                throw_out_of_range();
+            return data()[pos];
+        }
+
+        const_reference at(size_type pos) const {
+            if (pos >= size())
+                throw_out_of_range();
+            return data()[pos];
+        }
+
+        reference operator[](size_type pos) noexcept {
+            assert(pos < m_size);
+            return data()[pos];
+        }
+
+        const_reference operator[](size_type pos) const noexcept {
+            assert(pos < m_size);
+            return data()[pos];
+        }
+
+        pointer data() noexcept { return is_inline() ? reinterpret_cast<pointer>(&m_storage) : m_heap; }
+        const_pointer data() const noexcept { return is_inline() ? reinterpret_cast<const_pointer>(&m_storage) : m_heap; }
+
+        reference front() noexcept {
+            assert(!empty());
+            return *data();
+        }
+
+        const_reference front() const noexcept {
+            assert(!empty());
+            return *data();
+        }
+
+        reference back() noexcept {
+            assert(!empty());
+            return *(end() - 1);
+        }
+
+        const_reference back() const noexcept {
+            assert(!empty());
+            return *(end() - 1);
+        }
+
+        //
+        // Iterators
+        //////////////
+
+        iterator begin() noexcept { return data(); }
+        iterator end() noexcept { return data() + m_size; }
+
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator end() const noexcept { return data() + m_size; }
+
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator{ end() }; }
+        reverse_iterator rend() noexcept { return reverse_iterator{ begin() }; }
+
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{ end() }; }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator{ begin() }; }
+
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        //
+        // Capacity
+        /////////////
+
+        bool empty() const noexcept { return m_size == 0; }
+
+        size_type size() const noexcept { return m_size; }
+
+        size_type max_size() const noexcept {
+            return std::min<size_type>(alloc_traits::max_size(this->GetAllocator()), std::numeric_limits<difference_type>::max());
+        }
+
+        size_type capacity() const noexcept { return m_capacity; }
+
+        void reserve(size_type new_cap) {
+            if (new_cap > m_capacity)
+                reallocate(new_cap);
+        }
+
+        void shrink_to_fit() {
+            if (is_inline() || m_size == m_capacity)
+                return;
+
+            if (m_size <= N) {
+                pointer heap = m_heap;
+                const size_type heap_capacity = m_capacity;
+                details::uninitialized_relocate(heap, heap + m_size, reinterpret_cast<pointer>(&m_storage));
+                m_capacity = N;
+                deallocate(heap, heap_capacity);
+            }
+            else
+                reallocate(m_size);
+        }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            std::destroy(begin(), end());
+            m_size = 0;
+        }
+
+        iterator insert(const_iterator pos, const value_type& value) {
+            return emplace(pos, value);
+        }
+
+        iterator insert(const_iterator pos, value_type&& value) {
+            return emplace(pos, std::move(value));
+        }
+
+        iterator insert(const_iterator pos, size_type count, const value_type& value) {
+            assert(cbegin() <= pos && pos <= cend());
+            const auto offset = static_cast<size_type>(pos - cbegin());
+            if (count == 0)
+                return begin() + offset;
+
+            if (m_size + count > m_capacity) {
+                const size_type new_cap = next_capacity(m_size + count);
+                pointer new_data = allocate(new_cap);
+                try {
+                    std::uninitialized_fill_n(new_data + offset, count, value);
+                }
+                catch (...) {
+                    deallocate(new_data, new_cap);
+                    throw;
+                }
+                relocate_around(new_data, new_cap, offset, count);
+            }
+            else if constexpr (is_trivially_relocatable_v<value_type>) {
+                const value_type tmp(value); // value may refer to an element
+                const pointer posptr = begin() + offset;
+                const pointer oldlast = end();
+                details::relocate_overlapping(posptr, oldlast, posptr + count);
+                try {
+                    std::uninitialized_fill_n(posptr, count, tmp);
+                }
+                catch (...) {
+                    details::relocate_overlapping(posptr + count, oldlast + count, posptr);
+                    throw;
+                }
+                m_size += count;
+            }
+            else {
+                const pointer oldlast = end();
+                std::uninitialized_fill_n(oldlast, count, value);
+                m_size += count;
+                std::rotate(begin() + offset, oldlast, end());
+            }
+            return begin() + offset;
+        }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        iterator insert(const_iterator pos, Iter first, Iter last) {
+            return insert_range(pos, first, last, typename std::iterator_traits<Iter>::iterator_category{});
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+            return insert(pos, ilist.begin(), ilist.end());
+        }
+
+        template<typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args) {
+            assert(cbegin() <= pos && pos <= cend());
+            const auto offset = static_cast<size_type>(pos - cbegin());
+
+            if (m_size == m_capacity) {
+                const size_type new_cap = next_capacity(m_size + 1);
+                pointer new_data = allocate(new_cap);
+                try {
+                    std::construct_at(new_data + offset, std::forward<Args>(args)...);
+                }
+                catch (...) {
+                    deallocate(new_data, new_cap);
+                    throw;
+                }
+                relocate_around(new_data, new_cap, offset, 1);
+                return m_heap + offset;
+            }
+
+            const pointer posptr = begin() + offset;
+            const pointer last = end();
+            if (posptr == last)
+                std::construct_at(last, std::forward<Args>(args)...);
+            else if constexpr (is_trivially_relocatable_v<value_type>) {
+                // args may refer to an element, so build the value at last before shifting
+                std::construct_at(last, std::forward<Args>(args)...);
+                details::relocate_last_to(posptr, last);
+            }
+            else {
+                // args may refer to an element, so build the value before shifting
+                value_type tmp(std::forward<Args>(args)...);
+                std::construct_at(last, std::move(*(last - 1)));
+                std::move_backward(posptr, last - 1, last);
+                *posptr = std::move(tmp);
+            }
+            ++m_size;
+            return posptr;
+        }
+
+        iterator erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
+            assert(cbegin() <= pos && pos < cend());
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
+            assert(cbegin() <= first && first <= last && last <= cend());
+            const pointer firstptr = begin() + (first - cbegin());
+            const pointer lastptr = begin() + (last - cbegin());
+            if (firstptr != lastptr) {
+                if constexpr (is_trivially_relocatable_v<value_type>) {
+                    std::destroy(firstptr, lastptr);
+                    details::relocate_overlapping(lastptr, end(), firstptr);
+                    m_size -= static_cast<size_type>(lastptr - firstptr);
+                }
+                else {
+                    const pointer newlast = std::move(lastptr, end(), firstptr);
+                    std::destroy(newlast, end());
+                    m_size = static_cast<size_type>(newlast - begin());
+                }
+            }
+            return firstptr;
+        }
+
+        void push_back(const value_type& value) { emplace_back(value); }
+
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args) {
+            if (m_size == m_capacity)
+                return *emplace(cend(), std::forward<Args>(args)...);
+
+            pointer addr = end();
+            std::construct_at(addr, std::forward<Args>(args)...);
+            ++m_size;
+            return *addr;
+        }
+
+        void pop_back() {
+            assert(!empty());
+            --m_size;
+            std::destroy_at(end());
+        }
+
+        void resize(size_type count) {
+            if (count > m_size) {
+                reserve(count);
+                std::uninitialized_value_construct(end(), begin() + count);
+                m_size = count;
+            }
+            else
+                erase(begin() + count, end());
+        }
+
+        void resize(size_type count, const T& value) {
+            if (count > m_size)
+                insert(cend(), count - m_size, value);
+            else
+                erase(begin() + count, end());
+        }
+
+        void swap(compact_small_vector& other) noexcept(std::is_nothrow_move_constructible_v<value_type>) {
+            if (this == &other)
+                return;
+
+            if (!is_inline() && !other.is_inline()) {
+                std::swap(m_heap, other.m_heap);
+                std::swap(m_size, other.m_size);
+                std::swap(m_capacity, other.m_capacity);
+                return;
+            }
+
+            compact_small_vector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+    private:
+        bool is_inline() const noexcept { return m_capacity == N; }
+        [[noreturn]] void throw_out_of_range() const { throw std::out_of_range("invalid compact_small_vector subscript"); }
+        [[noreturn]] void throw_length_error() const { throw std::length_error("compact_small_vector too long"); }
+
+        pointer allocate(size_type n) { return alloc_traits::allocate(this->GetAllocator(), n); }
+        void deallocate(pointer p, size_type n) noexcept { alloc_traits::deallocate(this->GetAllocator(), p, n); }
+
+        size_type next_capacity(size_type needed) const {
+            const size_type maxsize = max_size();
+            if (needed > maxsize)
+                throw_length_error();
+            if (m_capacity > maxsize - m_capacity)
+                return maxsize;
+            return std::max(needed, 2 * m_capacity);
+        }
+
+        // new_data[offset, offset + count) is already constructed,
+        // relocate the elements around it and adopt new_data as the heap buffer
+        void relocate_around(pointer new_data, size_type new_cap, size_type offset, size_type count) noexcept {
+            const pointer first = begin();
+            details::uninitialized_relocate(first, first + offset, new_data);
+            details::uninitialized_relocate(first + offset, first + m_size, new_data + offset + count);
+            if (!is_inline())
+                deallocate(m_heap, m_capacity);
+            m_heap = new_data;
+            m_capacity = new_cap;
+            m_size += count;
+        }
+
+        void reallocate(size_type new_cap) {
+            assert(new_cap > N && new_cap >= m_size);
+            if (new_cap > max_size())
+                throw_length_error();
+            pointer new_data = allocate(new_cap);
+            relocate_around(new_data, new_cap, m_size, 0);
+        }
+
+        template<typename Iter>
+        void assign_range(Iter first, Iter last, std::input_iterator_tag) {
+            pointer cursor = begin();
+            const pointer mylast = end();
+
+            for (; first != last && cursor != mylast; ++first, ++cursor)
+                *cursor = *first;
+
+            erase(cursor, mylast);
+
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        template<typename Iter>
+        void assign_range(Iter first, Iter last, std::forward_iterator_tag) {
+            const auto newsize = static_cast<size_type>(std::distance(first, last));
+
+            if (newsize > m_capacity) {
+                clear();
+                reallocate(next_capacity(newsize));
+            }
+
+            if (newsize > m_size) {
+                const Iter mid = std::next(first, static_cast<difference_type>(m_size));
+                std::copy(first, mid, begin());
+                std::uninitialized_copy(mid, last, end());
+            }
+            else {
+                const pointer newlast = std::copy(first, last, begin());
+                std::destroy(newlast, end());
+            }
+            m_size = newsize;
+        }
+
+        template<typename Iter>
+        iterator insert_range(const_iterator pos, Iter first, Iter last, std::input_iterator_tag) {
+            assert(cbegin() <= pos && pos <= cend());
+            const auto offset = static_cast<size_type>(pos - cbegin());
+            const auto oldsize = m_size;
+
+            for (; first != last; ++first)
+                emplace_back(*first);
+
+            std::rotate(begin() + offset, begin() + oldsize, end());
+            return begin() + offset;
+        }
+
+        template<typename Iter>
+        iterator insert_range(const_iterator pos, Iter first, Iter last, std::forward_iterator_tag) {
+            assert(cbegin() <= pos && pos <= cend());
+            const auto offset = static_cast<size_type>(pos - cbegin());
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (count == 0)
+                return begin() + offset;
+
+            if (m_size + count > m_capacity) {
+                const size_type new_cap = next_capacity(m_size + count);
+                pointer new_data = allocate(new_cap);
+                try {
+                    std::uninitialized_copy(first, last, new_data + offset);
+                }
+                catch (...) {
+                    deallocate(new_data, new_cap);
+                    throw;
+                }
+                relocate_around(new_data, new_cap, offset, count);
+            }
+            else if constexpr (is_trivially_relocatable_v<value_type>) {
+                const pointer posptr = begin() + offset;
+                const pointer oldlast = end();
+                details::relocate_overlapping(posptr, oldlast, posptr + count);
+                try {
+                    std::uninitialized_copy(first, last, posptr);
+                }
+                catch (...) {
+                    details::relocate_overlapping(posptr + count, oldlast + count, posptr);
+                    throw;
+                }
+                m_size += count;
+            }
+            else {
+                const pointer oldlast = end();
+                std::uninitialized_copy(first, last, oldlast);
+                m_size += count;
+                std::rotate(begin() + offset, oldlast, end());
+            }
+            return begin() + offset;
+        }
+
+        union {
+            pointer m_heap;
+            std::aligned_storage_t<sizeof(T) * N, alignof(T)> m_storage;
+        };
+        size_type m_size{ 0 };
+        size_type m_capacity{ N };
+    };
+
+    // no self-pointers, the inline elements and the allocator are copied bytewise
+    template<typename T, std::size_t N, typename Allocator>
+    struct is_trivially_relocatable<compact_small_vector<T, N, Allocator>>
+        : std::bool_constant<is_trivially_relocatable_v<T>
+            && (std::is_empty_v<Allocator> || is_trivially_relocatable_v<Allocator>)> {};
+
+    template<typename T, std::size_t N, typename Allocator>
+    bool operator==(const compact_small_vector<T, N, Allocator>& lhs, const compact_small_vector<T, N, Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename T, std::size_t N, typename Allocator>
+    bool operator<(const compact_small_vector<T, N, Allocator>& lhs, const compact_small_vector<T, N, Allocator>& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template<typename T, std::size_t N, typename Allocator>
+    bool operator!=(const compact_small_vector<T, N, Allocator>& lhs, const compact_small_vector<T, N, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, std::size_t N, typename Allocator>
+    bool operator>(const compact_small_vector<T, N, Allocator>& lhs, const compact_small_vector<T, N, Allocator>& rhs) {
+        return rhs < lhs;
+    }
+
+    template<typename T, std::size_t N, typename Allocator>
+    bool operator<=(const compact_small_vector<T, N, Allocator>& lhs, const compact_small_vector<T, N, Allocator>& rhs) {
+        return !(rhs < lhs);
+    }
+
+    template<typename T, std::size_t N, typename Allocator>
+    bool operator>=(const compact_small_vector<T, N, Allocator>& lhs, const compact_small_vector<T, N, Allocator>& rhs) {
+        return !(lhs < rhs);
+    }
+
+    static_assert(sizeof(compact_small_vector<int, 4>) == details::compact_small_vector_size<int, 4>);
+    static_assert(sizeof(compact_small_vector<void*, 1>) == details::compact_small_vector_size<void*, 1>);
+    static_assert(sizeof(compact_small_vector<char, 8>) == details::compact_small_vector_size<char, 8>);
+}
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "../static_vector.hpp"
+#include "branchless_search.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace Ubpa {
+    // the current representation of an adaptive container
+    enum class adaptive_mode {
+        linear, // inline static_vector, linear scan
+        sorted, // sorted flat container, binary search
+        hashed  // open addressing table
+    };
+}
+
+namespace Ubpa::details {
+    // switches between three representations by size
+    // - linear: up to N elements in a static_vector in insertion order
+    // - sorted: Sorted (basic_flat_set / basic_flat_map) up to M elements
+    // - hashed: Hashed (basic_flat_unordered_set / basic_flat_unordered_map) past M elements
+    // it goes back to sorted below M / 2 elements and to linear at N / 2 elements, the gaps keep an insert / erase pair
+    // at a threshold from converting every time
+    // Slot: stored element, Value: element seen through iterators (std::pair<Key, T> as std::pair<const Key, T>)
+    // Compare (the order of Sorted), Hash and KeyEqual (of Hashed) are default constructed
+    template<typename Key, typename Slot, typename Value, std::size_t N, std::size_t M, typename Compare, typename Sorted, typename Hashed>
+    class adaptive_base {
+        static_assert(N > 0 && N < M);
+        static constexpr bool is_set = std::is_same_v<Slot, Value>;
+        using linear_type = static_vector<Slot, N>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = std::conditional_t<is_set, const value_type*, value_type*>;
+        using const_pointer = const value_type*;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+        using key_compare = Compare;
+        using sorted_type = Sorted;
+        using hashed_type = Hashed;
+
+        static constexpr std::size_t linear_capacity = N;
+        static constexpr std::size_t sorted_capacity = M;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        adaptive_base() = default;
+
+        adaptive_base(const adaptive_base&) = default;
+
+        adaptive_base(adaptive_base&& other) noexcept : m_rep(std::move(other.m_rep)) { other.clear(); }
+
+        adaptive_base& operator=(const adaptive_base&) = default;
+
+        adaptive_base& operator=(adaptive_base&& rhs) noexcept {
+            m_rep = std::move(rhs.m_rep);
+            rhs.clear();
+            return *this;
+        }
+
+        //
+        // Iterators
+        //////////////
+        // unspecified order: insertion order while linear or hashed (until an erase), key order while sorted
+
+        iterator begin() noexcept {
+            switch (m_rep.index()) {
+            case 0: return reinterpret_cast<iterator>(std::get<0>(m_rep).data());
+            case 1: return std::get<1>(m_rep).empty() ? nullptr : &*std::get<1>(m_rep).begin();
+            default: return std::get<2>(m_rep).begin();
+            }
+        }
+        const_iterator begin() const noexcept { return const_cast<adaptive_base*>(this)->begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return begin() + size(); }
+        const_iterator end() const noexcept { return begin() + size(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        //
+        // Capacity
+        /////////////
+
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+        size_type size() const noexcept { return std::visit([](const auto& rep) { return static_cast<size_type>(rep.size()); }, m_rep); }
+
+        adaptive_mode mode() const noexcept { return static_cast<adaptive_mode>(m_rep.index()); }
+
+        //
+        // Modifiers
+        //////////////
+
+        // back to linear
+        void clear() noexcept { m_rep.template emplace<0>(); }
+
+        // keeps the representation (so an iteration can go on), the erased element is replaced by
+        // - linear / hashed: the last element, returns pos (or end())
+        // - sorted: the following elements, returns pos
+        iterator erase(const_iterator pos) {
+            const auto index = pos - begin();
+            switch (m_rep.index()) {
+            case 0: {
+                auto& rep = std::get<0>(m_rep);
+                if (pos != end() - 1)
+                    rep[index] = std::move(rep.back());
+                rep.pop_back();
+                break;
+            }
+            case 1: std::get<1>(m_rep).erase(std::get<1>(m_rep).begin() + index); break;
+            default: std::get<2>(m_rep).erase(pos); break;
+            }
+            return begin() + index;
+        }
+
+        // may switch to a smaller representation
+        size_type erase(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                return 0;
+            erase(target);
+            shrink();
+            return 1;
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        iterator find(const key_type& key) {
+            switch (m_rep.index()) {
+            case 0: {
+                auto& rep = std::get<0>(m_rep);
+                const auto n = static_cast<size_type>(rep.size());
+                size_type index = n;
+                if constexpr (enable_branchless_search_v<Key, Compare>) {
+                    // scans all of the at most N keys without an early exit, like basic_small_unsorted_flat_map
+                    for (size_type i = n; i-- > 0;)
+                        index = equal(slot_key(rep[i]), key) ? i : index;
+                }
+                else {
+                    for (size_type i = 0; i < n; i++) {
+                        if (equal(slot_key(rep[i]), key)) {
+                            index = i;
+                            break;
+                        }
+                    }
+                }
+                return reinterpret_cast<iterator>(rep.data()) + index;
+            }
+            case 1: {
+                auto& rep = std::get<1>(m_rep);
+                auto target = rep.find(key);
+                return target == rep.end() ? end() : &*target;
+            }
+            default: return std::get<2>(m_rep).find(key);
+            }
+        }
+
+        const_iterator find(const key_type& key) const { return const_cast<adaptive_base*>(this)->find(key); }
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        bool contains(const key_type& key) const { return find(key) != end(); }
+
+    protected:
+        static const Key& key_of(const Value& value) noexcept {
+            if constexpr (is_set)
+                return value;
+            else
+                return value.first;
+        }
+
+        // inserts make_slot() if no element is equal to key, may switch to a larger representation
+        template<typename MakeSlot>
+        std::pair<iterator, bool> insert_unique(const key_type& key, MakeSlot&& make_slot) {
+            if (auto* rep = std::get_if<0>(&m_rep)) {
+                if (auto target = find(key); target != end())
+                    return { target, false };
+                if (rep->size() < N) {
+                    rep->push_back(std::forward<MakeSlot>(make_slot)());
+                    return { end() - 1, true };
+                }
+                to_sorted();
+            }
+            if (auto* rep = std::get_if<1>(&m_rep)) {
+                auto hint = rep->lower_bound(key);
+                if (hint != rep->end() && !Compare{}(key, key_of(*hint)))
+                    return { &*hint, false };
+                if (rep->size() < M)
+                    return { &*rep->emplace_hint(hint, std::forward<MakeSlot>(make_slot)()), true };
+                to_hashed();
+            }
+            auto& rep = std::get<2>(m_rep);
+            if (auto target = rep.find(key); target != rep.end())
+                return { target, false };
+            return rep.emplace(std::forward<MakeSlot>(make_slot)());
+        }
+
+    private:
+        static const Key& slot_key(const Slot& slot) noexcept {
+            if constexpr (is_set)
+                return slot;
+            else
+                return slot.first;
+        }
+
+        static bool equal(const key_type& lhs, const key_type& rhs) {
+            const Compare comp;
+            return !comp(lhs, rhs) && !comp(rhs, lhs);
+        }
+
+        // from linear or hashed
+        void to_sorted() {
+            auto rebuild = [&](auto&& elems) {
+                Sorted rep(std::make_move_iterator(elems.begin()), std::make_move_iterator(elems.end()));
+                m_rep.template emplace<1>(std::move(rep));
+            };
+            if (auto* rep = std::get_if<0>(&m_rep))
+                rebuild(std::move(*rep));
+            else
+                rebuild(std::move(std::get<2>(m_rep)).extract());
+        }
+
+        void to_hashed() {
+            auto elems = std::move(std::get<1>(m_rep)).extract();
+            Hashed rep;
+            rep.reserve(elems.size() + 1);
+            for (auto& elem : elems)
+                rep.emplace(std::move(elem));
+            m_rep.template emplace<2>(std::move(rep));
+        }
+
+        void to_linear() {
+            auto elems = std::move(std::get<1>(m_rep)).extract();
+            linear_type rep;
+            for (auto& elem : elems)
+                rep.push_back(std::move(elem));
+            m_rep.template emplace<0>(std::move(rep));
+        }
+
+        void shrink() {
+            if (m_rep.index() == 2 && size() < M / 2)
+                to_sorted();
+            if (m_rep.index() == 1 && size() <= N / 2)
+                to_linear();
+        }
+
+        std::variant<linear_type, Sorted, Hashed> m_rep;
+    };
+
+    // equal as sets / maps, regardless of the representations
+    template<typename Key, typename Slot, typename Value, std::size_t N, std::size_t M, typename Compare, typename Sorted, typename Hashed>
+    bool operator==(const adaptive_base<Key, Slot, Value, N, M, Compare, Sorted, Hashed>& lhs, const adaptive_base<Key, Slot, Value, N, M, Compare, Sorted, Hashed>& rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (const auto& elem : lhs) {
+            auto target = [&]() {
+                if constexpr (std::is_same_v<Slot, Value>)
+                    return rhs.find(elem);
+                else
+                    return rhs.find(elem.first);
+            }();
+            if (target == rhs.end() || !(*target == elem))
+                return false;
+        }
+        return true;
+    }
+
+    template<typename Key, typename Slot, typename Value, std::size_t N, std::size_t M, typename Compare, typename Sorted, typename Hashed>
+    bool operator!=(const adaptive_base<Key, Slot, Value, N, M, Compare, Sorted, Hashed>& lhs, const adaptive_base<Key, Slot, Value, N, M, Compare, Sorted, Hashed>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "../overflow_policy.hpp"
+#include "flat_base_multiset.hpp"
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace Ubpa::details {
+    // applies Overflow (not overflow_assert) to a flat container of at most N elements,
+    // before an insert would overflow its storage
+    // the inserting functions of Base are hidden by the ones of bounded_flat_set / bounded_flat_map:
+    // hints are ignored and the transparent overloads are unavailable
+    template<typename Base, std::size_t N, typename Overflow>
+    class bounded_flat_base : public Base {
+        static_assert(!std::is_same_v<Overflow, overflow_assert>);
+    public:
+        using Base::Base;
+
+    protected:
+        // whether an element with key fits, may evict another one to make room
+        template<typename K>
+        bool make_room(const K& key) {
+            if (this->size() < N || this->contains(key))
+                return true;
+            if constexpr (std::is_same_v<Overflow, overflow_throw>)
+                throw_length_error();
+            else if constexpr (std::is_same_v<Overflow, overflow_reject>)
+                return false;
+            else {
+                if constexpr (std::is_same_v<Overflow, overflow_evict_smallest>)
+                    Base::erase(this->begin());
+                else if constexpr (std::is_same_v<Overflow, overflow_evict_largest>)
+                    Base::erase(std::prev(this->end()));
+                else
+                    Base::erase(this->begin() + static_cast<std::ptrdiff_t>(m_overflow(this->size())));
+                return true;
+            }
+        }
+
+        // overflow_throw: count elements must fit
+        static void check_size(std::size_t count) {
+            if (count > N)
+                throw_length_error();
+        }
+
+    private:
+        [[noreturn]] static void throw_length_error() { throw std::length_error("static flat container overflow"); }
+
+        [[no_unique_address]] Overflow m_overflow;
+    };
+
+    template<typename Base, typename Compare, std::size_t N, typename Overflow>
+    class bounded_flat_set : public bounded_flat_base<Base, N, Overflow> {
+        using mybase = bounded_flat_base<Base, N, Overflow>;
+    public:
+        using typename Base::key_type;
+        using typename Base::value_type;
+        using typename Base::iterator;
+        using typename Base::const_iterator;
+
+        using mybase::mybase;
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        bounded_flat_set(Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp) { insert(first, last); }
+
+        bounded_flat_set(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : bounded_flat_set(ilist.begin(), ilist.end(), comp) {}
+
+        std::pair<iterator, bool> insert(const value_type& value) {
+            if (!mybase::make_room(value))
+                return { this->end(), false };
+            return Base::insert(value);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value) {
+            if (!mybase::make_room(value))
+                return { this->end(), false };
+            return Base::insert(std::move(value));
+        }
+
+        iterator insert(const_iterator, const value_type& value) { return insert(value).first; }
+        iterator insert(const_iterator, value_type&& value) { return insert(std::move(value)).first; }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                emplace(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) { return insert(value_type(std::forward<Args>(args)...)); }
+
+        template<typename... Args>
+        iterator emplace_hint(const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+
+        //
+        // Set operations
+        ///////////////////
+        // overflow_throw checks first that the storage holds size() plus the elements taken (see flat_base_multiset),
+        // the set is unchanged if it throws
+        // the other policies insert the elements one by one, merge leaves the ones not inserted in source
+        // set_symmetric_difference would have to choose the elements to drop: overflow_throw only
+
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void merge(flat_base_multiset<OtherImpl, OtherMulti, OtherVector, key_type, Compare, OtherRKey>& source) {
+            if (static_cast<const void*>(&source) == this)
+                return;
+            if constexpr (std::is_same_v<Overflow, overflow_throw>) {
+                mybase::check_size(this->size() + this->template count_taken<true, false>(source.begin(), source.end()));
+                Base::merge(source);
+            }
+            else {
+                auto out = source.begin();
+                for (auto iter = source.begin(); iter != source.end(); ++iter) {
+                    if (!this->contains(*iter) && mybase::make_room(*iter))
+                        Base::insert(std::move(*iter));
+                    else {
+                        if (out != iter)
+                            *out = std::move(*iter);
+                        ++out;
+                    }
+                }
+                source.erase(out, source.end());
+            }
+        }
+
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void merge(flat_base_multiset<OtherImpl, OtherMulti, OtherVector, key_type, Compare, OtherRKey>&& source) { merge(source); }
+
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void set_union(const flat_base_multiset<OtherImpl, OtherMulti, OtherVector, key_type, Compare, OtherRKey>& other) {
+            if constexpr (std::is_same_v<Overflow, overflow_throw>) {
+                mybase::check_size(this->size() + this->template count_taken<true, false>(other.begin(), other.end()));
+                Base::set_union(other);
+            }
+            else {
+                for (const auto& value : other) {
+                    if (!this->contains(value) && mybase::make_room(value))
+                        Base::insert(value);
+                }
+            }
+        }
+
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void set_symmetric_difference(const flat_base_multiset<OtherImpl, OtherMulti, OtherVector, key_type, Compare, OtherRKey>& other)
+            requires std::is_same_v<Overflow, overflow_throw>
+        {
+            mybase::check_size(this->size() + this->template count_taken<false, false>(other.begin(), other.end()));
+            Base::set_symmetric_difference(other);
+        }
+    };
+
+    // the storage of a bounded container, overflow_throw also guards the insertions bounded_flat_set / bounded_flat_map don't wrap
+    template<typename Overflow>
+    using bounded_storage_overflow_t = std::conditional_t<std::is_same_v<Overflow, overflow_throw>, overflow_throw, overflow_assert>;
+
+    template<typename Base, typename Compare, std::size_t N, typename Overflow>
+    class bounded_flat_map : public bounded_flat_base<Base, N, Overflow> {
+        using mybase = bounded_flat_base<Base, N, Overflow>;
+    public:
+        using typename Base::key_type;
+        using typename Base::mapped_type;
+        using typename Base::value_type;
+        using typename Base::iterator;
+        using typename Base::const_iterator;
+
+        using mybase::mybase;
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        bounded_flat_map(Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp) { insert(first, last); }
+
+        bounded_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : bounded_flat_map(ilist.begin(), ilist.end(), comp) {}
+
+        //
+        // Element access
+        ///////////////////
+        // overflow_reject has no element to return
+
+        mapped_type& operator[](const key_type& key) requires (!std::is_same_v<Overflow, overflow_reject>) {
+            mybase::make_room(key);
+            return Base::operator[](key);
+        }
+
+        mapped_type& operator[](key_type&& key) requires (!std::is_same_v<Overflow, overflow_reject>) {
+            mybase::make_room(key);
+            return Base::operator[](std::move(key));
+        }
+
+        //
+        // Modifiers
+        //////////////
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, std::move(value.second)); }
+
+        iterator insert(const_iterator, const value_type& value) { return insert(value).first; }
+        iterator insert(const_iterator, value_type&& value) { return insert(std::move(value)).first; }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                emplace(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            std::pair<key_type, mapped_type> value(std::forward<Args>(args)...);
+            return try_emplace(std::move(value.first), std::move(value.second));
+        }
+
+        template<typename... Args>
+        iterator emplace_hint(const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) {
+            if (!mybase::make_room(k))
+                return { this->end(), false };
+            return Base::try_emplace(k, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) {
+            if (!mybase::make_room(k))
+                return { this->end(), false };
+            return Base::try_emplace(std::move(k), std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        iterator try_emplace(const_iterator, const key_type& k, Args&&... args) { return try_emplace(k, std::forward<Args>(args)...).first; }
+
+        template<typename... Args>
+        iterator try_emplace(const_iterator, key_type&& k, Args&&... args) { return try_emplace(std::move(k), std::forward<Args>(args)...).first; }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& m) {
+            if (!mybase::make_room(k))
+                return { this->end(), false };
+            return Base::insert_or_assign(k, std::forward<M>(m));
+        }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M&& m) {
+            if (!mybase::make_room(k))
+                return { this->end(), false };
+            return Base::insert_or_assign(std::move(k), std::forward<M>(m));
+        }
+
+        template<typename M>
+        iterator insert_or_assign(const_iterator, const key_type& k, M&& m) { return insert_or_assign(k, std::forward<M>(m)).first; }
+
+        template<typename M>
+        iterator insert_or_assign(const_iterator, key_type&& k, M&& m) { return insert_or_assign(std::move(k), std::forward<M>(m)).first; }
+    };
+
+    // Base itself for overflow_assert
+    template<typename Base, typename Compare, std::size_t N, typename Overflow>
+    using bounded_flat_set_t = std::conditional_t<std::is_same_v<Overflow, overflow_assert>, Base, bounded_flat_set<Base, Compare, N, Overflow>>;
+
+    template<typename Base, typename Compare, std::size_t N, typename Overflow>
+    using bounded_flat_map_t = std::conditional_t<std::is_same_v<Overflow, overflow_assert>, Base, bounded_flat_map<Base, Compare, N, Overflow>>;
+}
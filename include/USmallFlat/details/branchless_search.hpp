@@ -0,0 +1,131 @@
+#pragma once
+
+#include "prefetch.hpp"
+#include "simd_scan.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace Ubpa {
+    // flat containers search arithmetic keys ordered by std::less / std::greater without data-dependent branches,
+    // specialize it as std::false_type to opt out for a key / compare pair
+    template<typename Key, typename Compare>
+    struct enable_branchless_search : std::false_type {};
+
+    template<typename Key> requires std::is_arithmetic_v<Key>
+    struct enable_branchless_search<Key, std::less<Key>> : std::true_type {};
+    template<typename Key> requires std::is_arithmetic_v<Key>
+    struct enable_branchless_search<Key, std::less<>> : std::true_type {};
+    template<typename Key> requires std::is_arithmetic_v<Key>
+    struct enable_branchless_search<Key, std::greater<Key>> : std::true_type {};
+    template<typename Key> requires std::is_arithmetic_v<Key>
+    struct enable_branchless_search<Key, std::greater<>> : std::true_type {};
+
+    template<typename Key, typename Compare>
+    inline constexpr bool enable_branchless_search_v = enable_branchless_search<Key, Compare>::value;
+
+    // contiguous arrays of at most this many 32 / 64-bit keys are scanned with SIMD compares instead of searched,
+    // specialize it as 0 to always search (the defaults are the AVX2 crossovers of src/test/02_benchmark)
+    template<typename Key>
+    struct simd_scan_threshold : std::integral_constant<std::size_t,
+        !details::is_simd_scan_key_v<Key> ? 0 : sizeof(Key) == 4 ? 64 : 16> {};
+
+    template<typename Key>
+    inline constexpr std::size_t simd_scan_threshold_v = simd_scan_threshold<Key>::value;
+}
+
+namespace Ubpa::details {
+    // the key and the key order of a flat container element,
+    // flat_base_multimap specializes it for its pair elements
+    template<typename Value, typename Compare>
+    struct flat_search_traits {
+        using key_type = Value;
+        using key_compare = Compare;
+        static constexpr const Value& key(const Value& value) noexcept { return value; }
+        static constexpr const Compare& compare(const Compare& comp) noexcept { return comp; }
+    };
+
+    template<typename Compare>
+    struct is_std_greater : std::false_type {};
+    template<typename T>
+    struct is_std_greater<std::greater<T>> : std::true_type {};
+    template<typename Compare>
+    inline constexpr bool is_std_greater_v = is_std_greater<Compare>::value;
+
+    // below it the binary search is a couple of steps, faster than the scan
+    inline constexpr std::size_t simd_scan_min_size = 8;
+
+    // below it the searched range fits in the cache
+    inline constexpr std::ptrdiff_t prefetch_threshold = 1 << 14;
+
+    template<typename Iter>
+    constexpr void prefetch_search_step(Iter first, std::iter_difference_t<Iter> half) noexcept {
+        if constexpr (std::contiguous_iterator<Iter>) {
+            if (std::is_constant_evaluated())
+                return;
+            prefetch(std::to_address(first + half / 2));
+            prefetch(std::to_address(first + half + half / 2));
+        }
+    }
+
+    template<typename Key, typename Iter, typename K>
+    inline constexpr bool use_simd_scan = simd_scan_threshold_v<Key> > 0 && std::contiguous_iterator<Iter>
+        && std::is_same_v<std::iter_value_t<Iter>, Key> && std::is_same_v<K, Key>;
+
+    // the trip count only depends on last - first, each step is a conditional move
+    template<typename Iter, typename K, typename Less, typename Proj>
+    constexpr Iter branchless_lower_bound(Iter first, Iter last, const K& key, Less less, Proj proj) {
+        auto len = last - first;
+        if (len == 0)
+            return first;
+        while (len > 1) {
+            const auto half = len / 2;
+            if (len >= prefetch_threshold) // both candidates of the next step
+                prefetch_search_step(first, half);
+            first = less(proj(first[half]), key) ? first + half : first;
+            len -= half;
+        }
+        return first + static_cast<std::iter_difference_t<Iter>>(less(proj(*first), key));
+    }
+
+    template<typename Iter, typename K, typename Less, typename Proj>
+    constexpr Iter branchless_upper_bound(Iter first, Iter last, const K& key, Less less, Proj proj) {
+        auto len = last - first;
+        if (len == 0)
+            return first;
+        while (len > 1) {
+            const auto half = len / 2;
+            if (len >= prefetch_threshold) // both candidates of the next step
+                prefetch_search_step(first, half);
+            first = !less(key, proj(first[half])) ? first + half : first;
+            len -= half;
+        }
+        return first + static_cast<std::iter_difference_t<Iter>>(!less(key, proj(*first)));
+    }
+
+    // [first, last) of elements with keys proj(elem) ordered by Compare, enable_branchless_search_v<Key, Compare> is true
+    // - small contiguous key arrays: SIMD scan
+    // - else: branchless binary search
+    template<typename Key, typename Compare, typename Iter, typename K, typename Proj>
+    constexpr Iter fast_lower_bound(Iter first, Iter last, const K& key, Proj proj) {
+        if constexpr (use_simd_scan<Key, Iter, K>) {
+            const auto n = static_cast<std::size_t>(last - first);
+            if (n >= simd_scan_min_size && n <= simd_scan_threshold_v<Key>)
+                return first + static_cast<std::iter_difference_t<Iter>>(simd_lower_rank<is_std_greater_v<Compare>>(std::to_address(first), n, key));
+        }
+        return branchless_lower_bound(first, last, key, Compare{}, proj);
+    }
+
+    template<typename Key, typename Compare, typename Iter, typename K, typename Proj>
+    constexpr Iter fast_upper_bound(Iter first, Iter last, const K& key, Proj proj) {
+        if constexpr (use_simd_scan<Key, Iter, K>) {
+            const auto n = static_cast<std::size_t>(last - first);
+            if (n >= simd_scan_min_size && n <= simd_scan_threshold_v<Key>)
+                return first + static_cast<std::iter_difference_t<Iter>>(simd_upper_rank<is_std_greater_v<Compare>>(std::to_address(first), n, key));
+        }
+        return branchless_upper_bound(first, last, key, Compare{}, proj);
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "prefetch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace Ubpa::details {
+    // the keys of a sorted range in Eytzinger (BFS) order: node k has the children 2k and 2k+1, the root is 1,
+    // so the first levels share cache lines and a search prefetches a few levels ahead without branching
+    template<typename Key, typename Compare>
+    class eytzinger_index {
+    public:
+        using size_type = std::size_t;
+
+        eytzinger_index() = default;
+
+        // [first, last) is sorted by comp, proj(*iter) is the key
+        template<typename Iter, typename Proj = std::identity>
+        eytzinger_index(Iter first, Iter last, Proj proj = {}) {
+            const auto n = static_cast<size_type>(std::distance(first, last));
+            m_size = n;
+            m_ranks.assign(n + 1, n);
+            if (n == 0)
+                return;
+
+            std::vector<Iter> sorted;
+            sorted.reserve(n);
+            for (; first != last; ++first)
+                sorted.push_back(first);
+
+            // node k of the BFS order gets the in-order rank
+            std::vector<size_type> order(n + 1);
+            size_type rank = 0;
+            build(order, rank, 1, n);
+            m_keys.reserve(n + 1);
+            m_keys.push_back(proj(*sorted.front())); // slot 0 is never compared, the keys needn't be default constructible
+            for (size_type k = 1; k <= n; k++) {
+                m_keys.push_back(proj(*sorted[order[k]]));
+                m_ranks[k] = order[k];
+            }
+        }
+
+        size_type size() const noexcept { return m_size; }
+
+        // sorted rank of the first key not less than key, size() if none
+        template<typename K>
+        size_type lower_bound(const K& key, const Compare& comp) const {
+            return m_ranks[lower_bound_node(key, comp)];
+        }
+
+        // sorted rank of the first key greater than key, size() if none
+        template<typename K>
+        size_type upper_bound(const K& key, const Compare& comp) const {
+            return m_ranks[descend(key, [&](const Key& node) { return !comp(key, node); })];
+        }
+
+        // sorted rank of a key equivalent to key, size() if none
+        template<typename K>
+        size_type find(const K& key, const Compare& comp) const {
+            const size_type k = lower_bound_node(key, comp);
+            return k != 0 && !comp(key, m_keys[k]) ? m_ranks[k] : size();
+        }
+
+        // compares within the index only, the sorted elements aren't touched
+        template<typename K>
+        bool contains(const K& key, const Compare& comp) const {
+            const size_type k = lower_bound_node(key, comp);
+            return k != 0 && !comp(key, m_keys[k]);
+        }
+
+    private:
+        template<typename K>
+        size_type lower_bound_node(const K& key, const Compare& comp) const {
+            return descend(key, [&](const Key& node) { return comp(node, key); });
+        }
+
+        // keys per cache line, a prefetch of node k * stride covers its descendants log2(stride) levels below
+        static constexpr size_type stride = std::max<size_type>(1, 64 / sizeof(Key));
+
+        static void build(std::vector<size_type>& order, size_type& rank, size_type k, size_type n) {
+            if (k > n)
+                return;
+            build(order, rank, 2 * k, n);
+            order[k] = rank++;
+            build(order, rank, 2 * k + 1, n);
+        }
+
+        // go_right(node) is true while node is before the target,
+        // returns the BFS node of the target or 0 (past the end)
+        template<typename K, typename GoRight>
+        size_type descend(const K&, GoRight go_right) const {
+            const Key* keys = m_keys.data();
+            const size_type n = size();
+            size_type k = 1;
+            while (k <= n) {
+                prefetch(keys + std::min(k * stride, n));
+                k = 2 * k + static_cast<size_type>(go_right(keys[k]));
+            }
+            // the target is the last node where the search went left
+            k >>= std::countr_one(k) + 1;
+            return k;
+        }
+
+        std::vector<Key> m_keys;
+        std::vector<size_type> m_ranks{ 0 }; // m_ranks[0] == size()
+        size_type m_size{ 0 };
+    };
+}
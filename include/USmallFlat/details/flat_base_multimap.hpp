@@ -14,6 +14,8 @@ namespace Ubpa::details {
         constexpr flat_base_multimap_comp_storage(T&& t) noexcept(std::is_nothrow_constructible_v<Compare, T>) :
             Compare{ std::forward<T>(t) } {}
 
+        constexpr const Compare& key_compare() const noexcept { return *this; }
+
     protected:
         constexpr Compare& GetCompare() noexcept { return *this; }
         constexpr const Compare& GetCompare() const noexcept { return *this; }
@@ -26,6 +28,8 @@ namespace Ubpa::details {
         constexpr flat_base_multimap_comp_storage(T&& t) noexcept(std::is_nothrow_constructible_v<Compare, T>) :
             comp{ std::forward<T>(t) } {}
 
+        constexpr const Compare& key_compare() const noexcept { return comp; }
+
     protected:
         constexpr Compare& GetCompare() noexcept { return comp; }
         constexpr const Compare& GetCompare() const noexcept { return comp; }
@@ -105,6 +109,16 @@ namespace Ubpa::details {
         using is_transparent = int;
     };
 
+    template<typename Key, typename T, typename Compare, bool value_as_base, bool transparent>
+    struct flat_search_traits<std::pair<Key, T>, flat_base_multimap_comp<Key, T, Compare, value_as_base, transparent>> {
+        using key_type = Key;
+        using key_compare = Compare;
+        template<typename Value> // std::pair<Key, T> or std::pair<const Key, T>
+        static constexpr const Key& key(const Value& value) noexcept { return value.first; }
+        static constexpr const Compare& compare(const flat_base_multimap_comp<Key, T, Compare, value_as_base, transparent>& comp) noexcept
+        { return comp.key_compare(); }
+    };
+
     // require
     // - Vector<std::pair<const Key, T>>::iterator <=> Vector<std::pair<Key, T>>::iterator
     // - Vector<std::pair<const Key, T>>::const_iterator <=> Vector<std::pair<Key, T>>::const_iterator
@@ -133,28 +147,42 @@ namespace Ubpa::details {
         using reverse_iterator = std::reverse_iterator<iterator>;
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+        using sorted_t = typename mybase::sorted_t;
+
         static_assert(std::random_access_iterator<iterator>);
 
         //////////////////////
         // Member functions //
         //////////////////////
 
-        flat_base_multimap() : mybase(Compare()) {}
+        constexpr flat_base_multimap() : mybase(Compare()) {}
 
-        explicit flat_base_multimap(const container_type& sorted_storage, const Compare& comp = Compare())
+        constexpr explicit flat_base_multimap(const container_type& sorted_storage, const Compare& comp = Compare())
             : mybase(sorted_storage, comp) {}
 
-        explicit flat_base_multimap(container_type&& sorted_storage, const Compare& comp = Compare())
+        constexpr explicit flat_base_multimap(container_type&& sorted_storage, const Compare& comp = Compare())
             : mybase(std::move(sorted_storage), comp) {}
 
-        explicit flat_base_multimap(const Compare& comp) : mybase(comp) {}
+        constexpr explicit flat_base_multimap(const Compare& comp) : mybase(comp) {}
 
         template<typename Iter> requires std::input_iterator<Iter>
         flat_base_multimap(Iter first, Iter last, const Compare& comp = Compare()) : mybase(first, last, comp) {}
 
-        flat_base_multimap(const flat_base_multimap&) = default;
+        constexpr flat_base_multimap(sorted_t tag, const container_type& sorted_storage, const Compare& comp = Compare())
+            : mybase(tag, sorted_storage, comp) {}
 
-        flat_base_multimap(flat_base_multimap&&) noexcept = default;
+        constexpr flat_base_multimap(sorted_t tag, container_type&& sorted_storage, const Compare& comp = Compare())
+            : mybase(tag, std::move(sorted_storage), comp) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        flat_base_multimap(sorted_t tag, Iter first, Iter last, const Compare& comp = Compare()) : mybase(tag, first, last, comp) {}
+
+        flat_base_multimap(sorted_t tag, std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : flat_base_multimap(tag, ilist.begin(), ilist.end(), comp) {}
+
+        constexpr flat_base_multimap(const flat_base_multimap&) = default;
+
+        constexpr flat_base_multimap(flat_base_multimap&&) noexcept = default;
 
         flat_base_multimap(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
             : flat_base_multimap(ilist.begin(), ilist.end(), comp) {}
@@ -226,10 +254,16 @@ namespace Ubpa::details {
         template<typename P> requires std::is_constructible_v<value_type, P&&>
         std::pair<iterator, bool> insert(const_iterator hint, P&& value) { return emplace_hint(hint, std::forward<P>(value)); }
 
-        // FIXME
         template<typename InputIt>
         void insert(InputIt first, InputIt last) { mybase::insert(first, last); }
 
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename InputIt>
+        void insert(sorted_t tag, InputIt first, InputIt last) { mybase::insert(tag, first, last); }
+
+        void insert(sorted_t tag, std::initializer_list<value_type> ilist) { insert(tag, ilist.begin(), ilist.end()); }
+
         template<typename... Args>
         iterator emplace(Args&&... args) { return cast_iterator(mybase::emplace(std::forward<Args>(args)...).first); }
 
@@ -240,26 +274,29 @@ namespace Ubpa::details {
         iterator erase(const_iterator pos) { return cast_iterator(mybase::erase(cast_iterator(pos))); }
         iterator erase(iterator pos) { return cast_iterator(mybase::erase(cast_iterator(pos))); }
         iterator erase(const_iterator first, const_iterator last) { return cast_iterator(mybase::erase(cast_iterator(first), cast_iterator(last))); }
-        size_type erase(const key_type& key) {
-            if constexpr (is_multi) {
-                auto [begin_iter, end_iter] = equal_range(key);
-                size_type cnt = std::distance(begin_iter, end_iter);
-                iterator cursor = begin_iter;
-                for (size_type i = 0; i < cnt; ++i)
-                    cursor = erase(cursor);
-                return cnt;
-            }
-            else {
-                auto iter = find(key);
-                if (iter == end())
-                    return 0;
-                else {
-                    erase(iter);
-                    return 1;
-                }
-            }
+        size_type erase(const key_type& key) { return mybase::erase(key); }
+
+        template<typename K, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>
+            && !std::is_convertible_v<K&&, iterator> && !std::is_convertible_v<K&&, const_iterator>, typename Comp_::is_transparent>>
+        size_type erase(K&& x) { return mybase::erase(x); }
+
+        // pred takes value_type&
+        template<typename Pred>
+        size_type erase_if(Pred pred) {
+            return mybase::erase_if([&](typename container_type::value_type& elem) {
+                return pred(reinterpret_cast<value_type&>(elem));
+            });
         }
 
+        template<std::ranges::forward_range Keys>
+        size_type erase_many(const Keys& keys) { return mybase::erase_many(keys); }
+
+        // the storage holds std::pair<Key, T>
+        container_type extract() && { return static_cast<mybase&&>(*this).extract(); }
+
+        void replace(container_type&& sorted_storage) { mybase::replace(std::move(sorted_storage)); }
+        void replace(sorted_t tag, container_type&& sorted_storage) { mybase::replace(tag, std::move(sorted_storage)); }
+
         //
         // Lookup
         ///////////
@@ -298,6 +335,16 @@ namespace Ubpa::details {
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
         bool contains(const K& key) const { return mybase::contains(key); }
 
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        std::pair<iterator, iterator> equal_range(const K& key)
+        { return cast_iterator(mybase::equal_range(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+        { return cast_iterator(mybase::equal_range(key)); }
+
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
         iterator lower_bound(const K& key)
@@ -318,6 +365,24 @@ namespace Ubpa::details {
         const_iterator upper_bound(const K& key) const
         { return cast_iterator(mybase::upper_bound(key)); }
 
+        // -- batched
+
+        template<std::ranges::forward_range Keys, typename OutputIt>
+        OutputIt find_many(const Keys& keys, OutputIt out) {
+            mybase::lookup_many(keys, [&](typename container_type::iterator iter) { *out++ = cast_iterator(iter); });
+            return out;
+        }
+
+        template<std::ranges::forward_range Keys, typename OutputIt>
+        OutputIt find_many(const Keys& keys, OutputIt out) const {
+            const_cast<flat_base_multimap*>(this)->lookup_many(keys,
+                [&](typename container_type::iterator iter) { *out++ = cast_iterator(typename container_type::const_iterator(iter)); });
+            return out;
+        }
+
+        template<std::ranges::forward_range Keys, typename OutputIt>
+        OutputIt contains_many(const Keys& keys, OutputIt out) const { return mybase::contains_many(keys, out); }
+
         //
         // Observers
         //////////////
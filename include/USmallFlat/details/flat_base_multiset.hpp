@@ -1,9 +1,16 @@
 #pragma once
 
+#include "../sorted_tags.hpp"
+#include "branchless_search.hpp"
+#include "gallop_search.hpp"
+
 #include <cassert>
 #include <algorithm>
 #include <concepts>
+#include <iterator>
+#include <ranges>
 #include <type_traits>
+#include <utility>
 
 namespace Ubpa::details {
     template<typename Compare, bool = std::is_empty_v<Compare> && !std::is_final_v<Compare>>
@@ -56,31 +63,50 @@ namespace Ubpa::details {
         using reverse_iterator = typename container_type::reverse_iterator;
         using const_reverse_iterator = typename container_type::const_reverse_iterator;
 
+        // sorted_unique_t or sorted_equivalent_t
+        using sorted_t = std::conditional_t<is_multi, sorted_equivalent_t, sorted_unique_t>;
+
         static_assert(std::random_access_iterator<iterator>);
 
         //////////////////////
         // Member functions //
         //////////////////////
 
-        flat_base_multiset() : mybase(Compare()) {}
+        constexpr flat_base_multiset() : mybase(Compare()) {}
 
-        explicit flat_base_multiset(const container_type& sorted_storage, const Compare& comp = Compare())
+        constexpr explicit flat_base_multiset(const container_type& sorted_storage, const Compare& comp = Compare())
             : mybase(comp), storage(sorted_storage)
         { assert(std::is_sorted(begin(), end(), this->GetCompare())); }
 
-        explicit flat_base_multiset(container_type&& sorted_storage, const Compare& comp = Compare())
+        constexpr explicit flat_base_multiset(container_type&& sorted_storage, const Compare& comp = Compare())
             : mybase(comp), storage(std::move(sorted_storage))
         { assert(std::is_sorted(begin(), end(), this->GetCompare())); }
 
-        explicit flat_base_multiset(const Compare& comp) : mybase(comp) {}
+        constexpr explicit flat_base_multiset(const Compare& comp) : mybase(comp) {}
 
         template<typename Iter> requires std::input_iterator<Iter>
         flat_base_multiset(Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp)
         { insert(first, last); }
 
-        flat_base_multiset(const flat_base_multiset&) = default;
+        constexpr flat_base_multiset(sorted_t, const container_type& sorted_storage, const Compare& comp = Compare())
+            : mybase(comp), storage(sorted_storage)
+        { assert(is_sorted_range(begin(), end())); }
+
+        constexpr flat_base_multiset(sorted_t, container_type&& sorted_storage, const Compare& comp = Compare())
+            : mybase(comp), storage(std::move(sorted_storage))
+        { assert(is_sorted_range(begin(), end())); }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        flat_base_multiset(sorted_t, Iter first, Iter last, const Compare& comp = Compare())
+            : mybase(comp), storage(first, last)
+        { assert(is_sorted_range(begin(), end())); }
+
+        flat_base_multiset(sorted_t tag, std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : flat_base_multiset(tag, ilist.begin(), ilist.end(), comp) {}
+
+        constexpr flat_base_multiset(const flat_base_multiset&) = default;
 
-        flat_base_multiset(flat_base_multiset&&) noexcept = default;
+        constexpr flat_base_multiset(flat_base_multiset&&) noexcept = default;
 
         flat_base_multiset(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
             : flat_base_multiset(ilist.begin(), ilist.end(), comp) {}
@@ -105,46 +131,46 @@ namespace Ubpa::details {
         // Iterators
         //////////////
 
-        iterator begin() noexcept { return storage.begin(); }
-        const_iterator begin() const noexcept { return storage.begin(); }
-        const_iterator cbegin() const noexcept { return storage.cbegin(); }
+        constexpr iterator begin() noexcept { return storage.begin(); }
+        constexpr const_iterator begin() const noexcept { return storage.begin(); }
+        constexpr const_iterator cbegin() const noexcept { return storage.cbegin(); }
 
-        iterator end() noexcept { return storage.end(); }
-        const_iterator end() const noexcept { return storage.end(); }
-        const_iterator cend() const noexcept { return storage.cend(); }
+        constexpr iterator end() noexcept { return storage.end(); }
+        constexpr const_iterator end() const noexcept { return storage.end(); }
+        constexpr const_iterator cend() const noexcept { return storage.cend(); }
 
-        reverse_iterator rbegin() noexcept { return storage.rbegin(); }
-        const_reverse_iterator rbegin() const noexcept { return storage.rbegin(); }
-        const_reverse_iterator crbegin() const noexcept { return storage.crbegin(); }
+        constexpr reverse_iterator rbegin() noexcept { return storage.rbegin(); }
+        constexpr const_reverse_iterator rbegin() const noexcept { return storage.rbegin(); }
+        constexpr const_reverse_iterator crbegin() const noexcept { return storage.crbegin(); }
 
-        reverse_iterator rend() noexcept { return storage.rend(); }
-        const_reverse_iterator rend() const noexcept { return storage.rend(); }
-        const_reverse_iterator crend() const noexcept { return storage.crend(); }
+        constexpr reverse_iterator rend() noexcept { return storage.rend(); }
+        constexpr const_reverse_iterator rend() const noexcept { return storage.rend(); }
+        constexpr const_reverse_iterator crend() const noexcept { return storage.crend(); }
 
         //
         // Element access
         ///////////////////
 
-        pointer data() noexcept { return storage.data(); }
-        const_pointer data() const noexcept { return storage.data(); }
+        constexpr pointer data() noexcept { return storage.data(); }
+        constexpr const_pointer data() const noexcept { return storage.data(); }
 
-        reference front() { return storage.front(); }
-        const_reference front() const { return storage.front(); }
+        constexpr reference front() { return storage.front(); }
+        constexpr const_reference front() const { return storage.front(); }
 
-        reference back() { return storage.back(); }
-        const_reference back() const { return storage.back(); }
+        constexpr reference back() { return storage.back(); }
+        constexpr const_reference back() const { return storage.back(); }
 
         //
         // Capacity
         /////////////
 
-        bool empty() const noexcept { return storage.empty(); }
+        constexpr bool empty() const noexcept { return storage.empty(); }
 
-        size_type size() const noexcept { return storage.size(); }
+        constexpr size_type size() const noexcept { return storage.size(); }
 
-        size_type max_size() const noexcept { return storage.max_size(); }
+        constexpr size_type max_size() const noexcept { return storage.max_size(); }
 
-        size_type capacity() const noexcept { return storage.capacity(); }
+        constexpr size_type capacity() const noexcept { return storage.capacity(); }
 
         void shrink_to_fit() { return storage.shrink_to_fit(); }
 
@@ -162,14 +188,20 @@ namespace Ubpa::details {
 
         iterator insert(const_iterator hint, value_type&& value) { return emplace_hint(hint, std::move(value)); }
 
+        // appends [first, last), sorts the appended part and merges it in, O(n + m log m);
+        // among equivalent elements, the earlier ones are kept (unique) or stay in front (multi)
         template<typename InputIt>
-        void insert(InputIt first, InputIt last) {
-            for (; first != last; ++first)
-                insert(*first);
-        }
+        void insert(InputIt first, InputIt last) { insert_range(first, last, false); }
 
         void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
 
+        // [first, last) is sorted (and unique for a unique container),
+        // a plain append when it follows the elements, otherwise a linear merge
+        template<typename InputIt>
+        void insert(sorted_t, InputIt first, InputIt last) { insert_range(first, last, true); }
+
+        void insert(sorted_t tag, std::initializer_list<value_type> ilist) { insert(tag, ilist.begin(), ilist.end()); }
+
         template<typename... Args>
         std::pair<iterator, bool> emplace(Args&&... args) {
             return emplace_impl(std::forward<Args>(args)...);
@@ -183,31 +215,129 @@ namespace Ubpa::details {
         iterator erase(const_iterator pos) { return storage.erase(pos); }
         iterator erase(iterator pos) { return storage.erase(pos); }
         iterator erase(const_iterator first, const_iterator last) { return storage.erase(first, last); }
-        size_type erase(const key_type& key) {
-            if constexpr (is_multi) {
-                auto [begin_iter, end_iter] = equal_range(key);
-                size_type cnt = std::distance(begin_iter, end_iter);
-                iterator cursor = begin_iter;
-                for (size_type i = 0; i < cnt; ++i)
-                    cursor = erase(cursor);
-                return cnt;
-            }
-            else {
-                auto iter = find(key);
-                if (iter == end())
-                    return 0;
+        size_type erase(const key_type& key) { return erase_key(key); }
+
+        // -- is_transparent
+        // x is not converted to key_type
+
+        template<typename K, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>
+            && !std::is_convertible_v<K&&, iterator> && !std::is_convertible_v<K&&, const_iterator>, typename Comp_::is_transparent>>
+        size_type erase(K&& x) { return erase_key(x); }
+
+        // value_type is only constructed from x if x is inserted
+        template<typename K, typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>
+            && !is_multi && !std::is_convertible_v<K&&, value_type>, typename Comp_::is_transparent>>
+        std::pair<iterator, bool> insert(K&& x) {
+            auto lb = lower_bound(x); // x <= lb
+            if (lb != end() && !this->GetCompare()(x, *lb)) // x == lb
+                return { lb, false };
+            return { storage.emplace(lb, std::forward<K>(x)), true };
+        }
+
+        // erases the elements with pred(elem) in one pass, returns the count
+        template<typename Pred>
+        size_type erase_if(Pred pred) {
+            const auto oldsize = size();
+            storage.erase(std::remove_if(begin(), end(), pred), end());
+            return oldsize - size();
+        }
+
+        // erases the elements equivalent to any of keys (sorted by key_comp()) in one pass, returns the count
+        template<std::ranges::forward_range Keys>
+        size_type erase_many(const Keys& keys) {
+            auto& comp = this->GetCompare();
+            auto kfirst = std::ranges::begin(keys);
+            auto klast = std::ranges::end(keys);
+            assert(std::is_sorted(kfirst, klast, search_traits::compare(comp)));
+
+            const auto oldsize = size();
+            auto first = begin();
+            auto last = end();
+            auto out = first;
+            while (first != last && kfirst != klast) {
+                if (comp(*first, *kfirst)) { // kept up to the next key
+                    auto run_last = gallop_lower_bound(std::next(first), last, *kfirst, comp);
+                    out = out == first ? run_last : std::move(first, run_last, out);
+                    first = run_last;
+                }
                 else {
-                    erase(iter);
-                    return 1;
+                    if (!comp(*kfirst, *first)) // erased
+                        first = gallop_upper_bound(first, last, *kfirst, comp);
+                    ++kfirst;
                 }
             }
+            if (out != first)
+                out = std::move(first, last, out);
+            else
+                out = last;
+            storage.erase(out, end());
+            return oldsize - size();
         }
 
+        // moves the storage out to mutate it in bulk (e.g. a parallel sort), leaves *this empty
+        container_type extract() && {
+            container_type rst = std::move(storage);
+            storage.clear();
+            return rst;
+        }
+
+        // moves sorted_storage in, the requirements of the constructors taking a container
+        void replace(container_type&& sorted_storage) {
+            storage = std::move(sorted_storage);
+            assert(std::is_sorted(begin(), end(), this->GetCompare()));
+        }
+
+        void replace(sorted_t, container_type&& sorted_storage) {
+            storage = std::move(sorted_storage);
+            assert(is_sorted_range(begin(), end()));
+        }
+
+        //
+        // Set operations
+        ///////////////////
+        // in place, O(size() + other.size()), with the multiplicities of std::set_union etc.
+        // if one side is gallop_ratio times larger, its runs are skipped by galloping instead of stepped through
+        // merge, set_union and set_symmetric_difference don't allocate beyond growing the storage:
+        // it holds size() plus the elements taken from other while merging (asserted to fit max_size()),
+        // at most size() + other.size(), even if set_symmetric_difference drops some of them afterwards
+
+        // moves the elements missing in *this from source (all of them if *this is a multiset), like std::set::merge
+        // source keeps the elements of *this (and repeats of a key)
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void merge(flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& source) {
+            if (static_cast<const void*>(&source) == this)
+                return;
+            merge_runs<true, is_multi>(source.begin(), source.end(), &source);
+        }
+
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void merge(flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>&& source) { merge(source); }
+
+        // the elements of *this or other
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void set_union(const flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& other)
+        { merge_runs<true, false>(other.begin(), other.end()); }
+
+        // the elements of *this and other
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void set_intersection(const flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& other)
+        { set_operation<false, true>(other.begin(), other.end()); }
+
+        // the elements of *this not in other
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void set_difference(const flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& other)
+        { set_operation<true, false>(other.begin(), other.end()); }
+
+        // the elements in exactly one of *this and other
+        template<typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename OtherRKey>
+        void set_symmetric_difference(const flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& other)
+        { merge_runs<false, false>(other.begin(), other.end()); }
+
         //
         // Lookup
         ///////////
 
-        size_type count(const key_type& key) const {
+        constexpr size_type count(const key_type& key) const {
             if constexpr (is_multi) {
                 auto [begin_iter, end_iter] = equal_range(key);
                 return std::distance(begin_iter, end_iter);
@@ -216,40 +346,40 @@ namespace Ubpa::details {
                 return static_cast<size_type>(find(key) != end());
         }
 
-        iterator find(const key_type& key) { return t_find(key); }
+        constexpr iterator find(const key_type& key) { return t_find(key); }
 
-        const_iterator find(const key_type& key) const { return const_cast<flat_base_multiset*>(this)->find(key); }
+        constexpr const_iterator find(const key_type& key) const { return const_cast<flat_base_multiset*>(this)->find(key); }
 
-        bool contains(const key_type& key) const { return find(key) != end(); }
+        constexpr bool contains(const key_type& key) const { return find(key) != end(); }
 
-        std::pair<iterator, iterator> equal_range(const key_type& key)
-        { return std::equal_range(begin(), end(), key, this->GetCompare()); }
-        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
-        { return std::equal_range(begin(), end(), key, this->GetCompare()); }
+        constexpr std::pair<iterator, iterator> equal_range(const key_type& key)
+        { return equal_range_in(begin(), end(), key); }
+        constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+        { return equal_range_in(begin(), end(), key); }
 
-        iterator lower_bound(const key_type& key)
-        { return std::lower_bound(begin(), end(), key, this->GetCompare()); }
-        const_iterator lower_bound(const key_type& key) const
-        { return std::lower_bound(begin(), end(), key, this->GetCompare()); }
+        constexpr iterator lower_bound(const key_type& key)
+        { return lower_bound_in(begin(), end(), key); }
+        constexpr const_iterator lower_bound(const key_type& key) const
+        { return lower_bound_in(begin(), end(), key); }
 
-        iterator upper_bound(const key_type& key)
-        { return std::upper_bound(begin(), end(), key, this->GetCompare()); }
-        const_iterator upper_bound(const key_type& key) const
-        { return std::upper_bound(begin(), end(), key, this->GetCompare()); }
+        constexpr iterator upper_bound(const key_type& key)
+        { return upper_bound_in(begin(), end(), key); }
+        constexpr const_iterator upper_bound(const key_type& key) const
+        { return upper_bound_in(begin(), end(), key); }
         
         // -- is_transparent
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        iterator find(const K& key) { return t_find(key); }
+        constexpr iterator find(const K& key) { return t_find(key); }
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        const_iterator find(const K& key) const { return const_cast<flat_base_multiset*>(this)->find(key); }
+        constexpr const_iterator find(const K& key) const { return const_cast<flat_base_multiset*>(this)->find(key); }
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        size_type count(const K& key) const {
+        constexpr size_type count(const K& key) const {
             if constexpr (is_multi) {
                 auto [begin_iter, end_iter] = equal_range(key);
                 return std::distance(begin_iter, end_iter);
@@ -260,34 +390,66 @@ namespace Ubpa::details {
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        bool contains(const K& key) const { return find(key) != end(); }
+        constexpr bool contains(const K& key) const { return find(key) != end(); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        constexpr std::pair<iterator, iterator> equal_range(const K& key)
+        { return equal_range_in(begin(), end(), key); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        constexpr std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+        { return equal_range_in(begin(), end(), key); }
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        iterator lower_bound(const K& key)
-        { return std::lower_bound(begin(), end(), key, this->GetCompare()); }
+        constexpr iterator lower_bound(const K& key)
+        { return lower_bound_in(begin(), end(), key); }
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        const_iterator lower_bound(const K& key) const
-        { return std::lower_bound(begin(), end(), key, this->GetCompare()); }
+        constexpr const_iterator lower_bound(const K& key) const
+        { return lower_bound_in(begin(), end(), key); }
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        iterator upper_bound(const K& key)
-        { return std::upper_bound(begin(), end(), key, this->GetCompare()); }
+        constexpr iterator upper_bound(const K& key)
+        { return upper_bound_in(begin(), end(), key); }
 
         template<typename K,
             typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
-        const_iterator upper_bound(const K& key) const
-        { return std::upper_bound(begin(), end(), key, this->GetCompare()); }
+        constexpr const_iterator upper_bound(const K& key) const
+        { return upper_bound_in(begin(), end(), key); }
+
+        // -- batched
+        // the result of each key in order to out, like find(key) / contains(key)
+
+        template<std::ranges::forward_range Keys, typename OutputIt>
+        OutputIt find_many(const Keys& keys, OutputIt out) {
+            lookup_many(keys, [&](iterator iter) { *out++ = iter; });
+            return out;
+        }
+
+        template<std::ranges::forward_range Keys, typename OutputIt>
+        OutputIt find_many(const Keys& keys, OutputIt out) const {
+            const_cast<flat_base_multiset*>(this)->lookup_many(keys, [&](iterator iter) { *out++ = const_iterator(iter); });
+            return out;
+        }
+
+        template<std::ranges::forward_range Keys, typename OutputIt>
+        OutputIt contains_many(const Keys& keys, OutputIt out) const {
+            const auto e = end();
+            const_cast<flat_base_multiset*>(this)->lookup_many(keys, [&](iterator iter) { *out++ = iter != e; });
+            return out;
+        }
 
         //
         // Observers
         //////////////
 
-        key_compare key_comp() const { return this->GetCompare(); }
-        value_compare value_comp() const { return this->GetCompare(); }
+        constexpr key_compare key_comp() const { return this->GetCompare(); }
+        constexpr value_compare value_comp() const { return this->GetCompare(); }
 
     protected:
         ////////////////////
@@ -296,9 +458,339 @@ namespace Ubpa::details {
 
         container_type storage;
 
+        //
+        // Search kernels
+        ///////////////////
+        // std::lower_bound / std::upper_bound, or for arithmetic keys (see enable_branchless_search)
+        // a SIMD scan of small sets and a branchless binary search of the rest
+
+        using search_traits = flat_search_traits<value_type, Compare>;
+
+        static constexpr auto project_key = [](const auto& value) -> decltype(auto) { return search_traits::key(value); };
+
+        template<typename K>
+        static constexpr bool use_branchless_search = std::is_arithmetic_v<K>
+            && enable_branchless_search_v<typename search_traits::key_type, typename search_traits::key_compare>;
+
+        template<typename Iter, typename K>
+        constexpr Iter lower_bound_in(Iter first, Iter last, const K& key) const {
+            if constexpr (use_branchless_search<K>)
+                return fast_lower_bound<typename search_traits::key_type, typename search_traits::key_compare>(first, last, key, project_key);
+            else
+                return std::lower_bound(first, last, key, this->GetCompare());
+        }
+
+        template<typename Iter, typename K>
+        constexpr Iter upper_bound_in(Iter first, Iter last, const K& key) const {
+            if constexpr (use_branchless_search<K>)
+                return fast_upper_bound<typename search_traits::key_type, typename search_traits::key_compare>(first, last, key, project_key);
+            else
+                return std::upper_bound(first, last, key, this->GetCompare());
+        }
+
+        template<typename Iter, typename K>
+        constexpr std::pair<Iter, Iter> equal_range_in(Iter first, Iter last, const K& key) const {
+            if constexpr (use_branchless_search<K>) {
+                auto lb = lower_bound_in(first, last, key);
+                return { lb, upper_bound_in(lb, last, key) };
+            }
+            else
+                return std::equal_range(first, last, key, this->GetCompare());
+        }
+
+        //
+        // Batched lookup
+        ///////////////////
+        // f(find(key)) for each key in order
+        // - dense sorted keys: one walk over the elements, galloping from the last result
+        // - else: a group of binary searches advance in lockstep, so their cache misses overlap
+
+        // the walk wins while there are at most this many elements per key
+        static constexpr std::size_t lookup_walk_max_gap = 16;
+
+        template<typename Keys, typename F>
+        void lookup_many(const Keys& keys, F&& f) {
+            const auto& key_less = search_traits::compare(this->GetCompare());
+            auto first = std::ranges::begin(keys);
+            auto last = std::ranges::end(keys);
+            const auto cnt = static_cast<std::size_t>(std::ranges::distance(keys));
+            if (size() <= cnt * lookup_walk_max_gap && std::is_sorted(first, last, key_less))
+                lookup_sorted(first, last, f);
+            else {
+                while (first != last)
+                    first = lookup_group(first, last, f);
+            }
+        }
+
+        template<typename KeyIter, typename KeySentinel, typename F>
+        void lookup_sorted(KeyIter first, KeySentinel last, F& f) {
+            auto& comp = this->GetCompare();
+            auto cursor = begin();
+            const auto e = end();
+            for (; first != last; ++first) {
+                cursor = gallop_lower_bound(cursor, e, *first, comp); // key <= cursor
+                f(cursor == e || comp(*first, *cursor) ? e : cursor);
+            }
+        }
+
+        // searches up to lookup_group_size keys, returns the first key left
+        template<typename KeyIter, typename KeySentinel, typename F>
+        KeyIter lookup_group(KeyIter first, KeySentinel last, F& f) {
+            static constexpr std::size_t lookup_group_size = 16;
+            auto& comp = this->GetCompare();
+
+            KeyIter keys[lookup_group_size];
+            iterator bases[lookup_group_size];
+            std::size_t cnt = 0;
+            for (; cnt < lookup_group_size && first != last; ++first) {
+                keys[cnt] = first;
+                bases[cnt] = begin();
+                cnt++;
+            }
+
+            const auto e = end();
+            auto len = e - begin();
+            if (len == 0) {
+                for (std::size_t i = 0; i < cnt; i++)
+                    f(e);
+                return first;
+            }
+
+            while (len > 1) {
+                const auto half = len / 2;
+                if (len >= prefetch_threshold) {
+                    for (std::size_t i = 0; i < cnt; i++)
+                        prefetch_search_step(bases[i], half);
+                }
+                for (std::size_t i = 0; i < cnt; i++)
+                    bases[i] = comp(bases[i][half], *keys[i]) ? bases[i] + half : bases[i];
+                len -= half;
+            }
+
+            for (std::size_t i = 0; i < cnt; i++) {
+                const auto lb = bases[i] + static_cast<difference_type>(comp(*bases[i], *keys[i])); // key <= lb
+                f(lb == e || comp(*keys[i], *lb) ? e : lb);
+            }
+            return first;
+        }
+
+        // the number of elements merge_runs<KeepBoth, TakeBoth> takes from [ofirst, olast)
+        template<bool KeepBoth, bool TakeBoth, typename OtherIter>
+        std::size_t count_taken(OtherIter ofirst, OtherIter olast) const {
+            auto& comp = this->GetCompare();
+            std::size_t taken = 0;
+            const value_type* prev = nullptr; // the last element of the result
+            set_walk<true, KeepBoth, TakeBoth>(begin(), end(), ofirst, olast,
+                [&](const_iterator, const_iterator run_last) { prev = std::to_address(std::prev(run_last)); },
+                [&](OtherIter run_first, OtherIter run_last) {
+                    for (; run_first != run_last; ++run_first) {
+                        if (is_multi || !prev || comp(*prev, *run_first)) { // a unique set takes a key once
+                            prev = std::to_address(run_first);
+                            taken++;
+                        }
+                    }
+                });
+            return taken;
+        }
+
     private:
+        template<typename, bool, template<typename>class, typename, typename, typename>
+        friend class flat_base_multiset;
+
+        static constexpr std::size_t gallop_ratio = 8;
+
+        template<typename K>
+        size_type erase_key(const K& key) {
+            if constexpr (is_multi) {
+                auto [begin_iter, end_iter] = equal_range(key);
+                const auto cnt = static_cast<size_type>(std::distance(begin_iter, end_iter));
+                erase(begin_iter, end_iter);
+                return cnt;
+            }
+            else {
+                auto iter = find(key);
+                if (iter == end())
+                    return 0;
+                else {
+                    erase(iter);
+                    return 1;
+                }
+            }
+        }
+
+        // one pass over [first, last) (elements of *this) and [ofirst, olast), both sorted, the runs come in merge order
+        // - on_this(run_first, run_last): a run to keep, only in *this if KeepThis, in both if KeepBoth
+        // - on_other(run_first, run_last): a run only in [ofirst, olast), or in both if TakeBoth
+        template<bool KeepThis, bool KeepBoth, bool TakeBoth, typename ThisIter, typename OtherIter, typename OnThis, typename OnOther>
+        void set_walk(ThisIter first, ThisIter last, OtherIter ofirst, OtherIter olast, OnThis&& on_this, OnOther&& on_other) const {
+            auto& comp = this->GetCompare();
+            const auto n = static_cast<std::size_t>(std::distance(first, last));
+            const auto m = static_cast<std::size_t>(std::distance(ofirst, olast));
+            const bool gallop_this = n > gallop_ratio * m;
+            const bool gallop_other = m > gallop_ratio * n;
+
+            while (first != last && ofirst != olast) {
+                if (comp(*first, *ofirst)) { // a run only in *this
+                    auto run_last = gallop_this ? gallop_lower_bound(std::next(first), last, *ofirst, comp) : std::next(first);
+                    if constexpr (KeepThis)
+                        on_this(first, run_last);
+                    first = run_last;
+                }
+                else if (comp(*ofirst, *first)) { // a run only in other
+                    auto run_last = gallop_other ? gallop_lower_bound(std::next(ofirst), olast, *first, comp) : std::next(ofirst);
+                    on_other(ofirst, run_last);
+                    ofirst = run_last;
+                }
+                else { // in both
+                    if constexpr (KeepBoth)
+                        on_this(first, std::next(first));
+                    if constexpr (TakeBoth)
+                        on_other(ofirst, std::next(ofirst));
+                    ++first;
+                    ++ofirst;
+                }
+            }
+            if constexpr (KeepThis) {
+                if (first != last)
+                    on_this(first, last);
+            }
+            if (ofirst != olast)
+                on_other(ofirst, olast);
+        }
+
+        // keeps the elements only in *this if KeepThis, the ones in both if KeepBoth (the one of *this)
+        template<bool KeepThis, bool KeepBoth, typename OtherIter>
+        void set_operation(OtherIter ofirst, OtherIter olast) {
+            auto out = begin();
+            set_walk<KeepThis, KeepBoth, false>(begin(), end(), ofirst, olast,
+                [&](iterator run_first, iterator run_last) { out = out == run_first ? run_last : std::move(run_first, run_last, out); },
+                [](OtherIter, OtherIter) {});
+            storage.erase(out, end());
+        }
+
+        // merges in the elements only in [ofirst, olast) (all of them if TakeBoth), keeps the ones in both if KeepBoth
+        // (a unique *this takes a key once), copied or moved out of *source (which is compacted), without a buffer:
+        // - counts the elements to take, the storage grows by as many placeholders
+        // - the elements of *this are moved behind the placeholders
+        // - a forward merge into the front never passes the unread elements of *this,
+        //   once the placeholders are used up the rest of *this is already in place and isn't moved
+        template<bool KeepBoth, bool TakeBoth, typename OtherIter, typename Source = const void>
+        void merge_runs(OtherIter ofirst, OtherIter olast, Source* source = nullptr) {
+            constexpr bool move_out = !std::is_const_v<Source>;
+            auto& comp = this->GetCompare();
+            auto is_new = [&](const value_type* prev, const value_type& value) { return is_multi || !prev || comp(*prev, value); };
+
+            const std::size_t k = count_taken<KeepBoth, TakeBoth>(ofirst, olast);
+            if (k == 0) {
+                if constexpr (!KeepBoth)
+                    set_operation<true, false>(ofirst, olast);
+                return;
+            }
+            assert(static_cast<std::size_t>(size()) + k <= static_cast<std::size_t>(max_size()));
+
+            const std::size_t n = size();
+            auto placeholder = ofirst;
+            for (std::size_t i = 0; i < k; ++i, ++placeholder) {
+                if constexpr (move_out) { // source is left unchanged
+                    storage.push_back(std::move(*placeholder));
+                    using std::swap;
+                    swap(storage.back(), *placeholder);
+                }
+                else
+                    storage.push_back(*placeholder);
+            }
+            std::move_backward(begin(), begin() + static_cast<difference_type>(n), end());
+
+            auto out = begin();
+            auto kept = ofirst; // the compacted source
+            auto cursor = ofirst; // source is compacted up to here
+            auto keep_in_source = [&](OtherIter iter) {
+                if constexpr (move_out) {
+                    if (kept != iter)
+                        *kept = std::move(*iter);
+                    ++kept;
+                }
+            };
+            set_walk<true, KeepBoth, TakeBoth>(begin() + static_cast<difference_type>(k), end(), ofirst, olast,
+                [&](iterator run_first, iterator run_last) { out = out == run_first ? run_last : std::move(run_first, run_last, out); },
+                [&](OtherIter run_first, OtherIter run_last) {
+                    for (; cursor != run_first; ++cursor)
+                        keep_in_source(cursor);
+                    for (; cursor != run_last; ++cursor) {
+                        if (is_new(out == begin() ? nullptr : std::to_address(std::prev(out)), *cursor)) {
+                            if constexpr (move_out)
+                                *out = std::move(*cursor);
+                            else
+                                *out = *cursor;
+                            ++out;
+                        }
+                        else
+                            keep_in_source(cursor);
+                    }
+                });
+            storage.erase(out, end());
+            if constexpr (move_out) {
+                for (; cursor != olast; ++cursor)
+                    keep_in_source(cursor);
+                source->storage.erase(kept, source->end());
+            }
+        }
+
+        template<typename Iter>
+        constexpr bool is_sorted_range(Iter first, Iter last) const {
+            auto& comp = this->GetCompare();
+            if constexpr (is_multi)
+                return std::is_sorted(first, last, comp);
+            else // strictly increasing
+                return std::adjacent_find(first, last, [&](const value_type& lhs, const value_type& rhs) { return !comp(lhs, rhs); }) == last;
+        }
+
+        template<typename InputIt>
+        void insert_range(InputIt first, InputIt last, bool sorted) {
+            const auto oldsize = size();
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+                // in std::size_t, the size_type of a static_vector may be narrower than the range
+                if (static_cast<std::size_t>(std::distance(first, last)) <= static_cast<std::size_t>(max_size() - oldsize)) {
+                    storage.insert(storage.end(), first, last);
+                    merge_appended(oldsize, sorted);
+                    return;
+                }
+            }
+            // a fixed capacity storage can't hold the duplicates, append while there is room
+            for (; first != last && size() < max_size(); ++first)
+                storage.emplace_back(*first);
+            merge_appended(oldsize, sorted);
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        // [begin(), begin() + oldsize) is sorted, sort the rest (unless sorted) and merge them (deduplicated if unique)
+        void merge_appended(size_type oldsize, bool sorted) {
+            auto& comp = this->GetCompare();
+            const auto mid = begin() + oldsize;
+            if (sorted)
+                assert(is_sorted_range(mid, end()));
+            else
+                std::stable_sort(mid, end(), comp);
+
+            auto checked = begin(); // duplicates can only start from here
+            if (mid != begin() && mid != end()) {
+                if (comp(*mid, *std::prev(mid)))
+                    std::inplace_merge(begin(), mid, end(), comp);
+                else
+                    checked = std::prev(mid); // already in order
+            }
+
+            if constexpr (!is_multi) {
+                auto equivalent = [&](const value_type& lhs, const value_type& rhs) { return !comp(lhs, rhs); };
+                auto first_dup = std::adjacent_find(checked, end(), equivalent);
+                if (first_dup != end())
+                    storage.erase(std::unique(first_dup, end(), equivalent), end());
+            }
+        }
+
         template<typename K>
-        iterator t_find(const K& key) {
+        constexpr iterator t_find(const K& key) {
             auto lb = lower_bound(key); // key <= lb
             auto e = end();
             if (lb == e || this->GetCompare()(key, *lb)) // key < lb
@@ -322,7 +814,7 @@ namespace Ubpa::details {
                         if (!comp(*hint, value)) // value <= hint
                             return storage.insert(hint, std::forward<V>(value));
                         else { // value > hint
-                            auto lb = std::lower_bound(std::next(hint), cend(), value, comp); // value <= lb
+                            auto lb = lower_bound_in(std::next(hint), cend(), value); // value <= lb
                             return storage.insert(lb, std::forward<V>(value));
                         }
                     }
@@ -345,7 +837,7 @@ namespace Ubpa::details {
                 last = hint;
             }
 
-            auto lb = std::lower_bound(first, last, value, comp); // value <= lb
+            auto lb = lower_bound_in(first, last, value); // value <= lb
 
             if constexpr (is_multi)
                 return storage.insert(lb, std::forward<V>(value));
@@ -369,6 +861,11 @@ namespace Ubpa::details {
         
         template<typename V> requires std::is_same<value_type, std::remove_cvref_t<V>>::value
         std::pair<iterator, bool> emplace_impl(V&& value) {
+            if constexpr (is_multi) {
+                auto ub = upper_bound(value); // key < ub
+                return { storage.insert(ub, std::forward<V>(value)), true };
+            }
+
             auto lb = lower_bound(value); // key <= lb
             if (lb == end() || this->GetCompare()(value, *lb)) // key < lb
                 return { storage.insert(lb, std::forward<V>(value)), true };
@@ -386,32 +883,69 @@ namespace Ubpa::details {
     };
 
     template <typename Impl, bool IsMulti, template<typename>class Vector, typename Key, typename Compare>
-    bool operator==(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
+    constexpr bool operator==(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
         return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
     template <typename Impl, bool IsMulti, template<typename>class Vector, typename Key, typename Compare>
-    bool operator<(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
+    constexpr bool operator<(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
         return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
     template <typename Impl, bool IsMulti, template<typename>class Vector, typename Key, typename Compare>
-    bool operator!=(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
+    constexpr bool operator!=(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
         return !(lhs == rhs);
     }
 
     template <typename Impl, bool IsMulti, template<typename>class Vector, typename Key, typename Compare>
-    bool operator>(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
+    constexpr bool operator>(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
         return rhs < lhs;
     }
 
     template <typename Impl, bool IsMulti, template<typename>class Vector, typename Key, typename Compare>
-    bool operator<=(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
+    constexpr bool operator<=(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
         return !(rhs < lhs);
     }
 
     template <typename Impl, bool IsMulti, template<typename>class Vector, typename Key, typename Compare>
-    bool operator>=(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
+    constexpr bool operator>=(const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& lhs, const flat_base_multiset<Impl, IsMulti, Vector, Key, Compare>& rhs) {
         return !(lhs < rhs);
     }
 }
+
+namespace Ubpa {
+    // erases the elements with pred(elem) in one pass, for the flat sets and maps
+    template<typename Container, typename Pred>
+        requires requires(Container& c, Pred pred) { c.erase_if(pred); }
+    typename Container::size_type erase_if(Container& c, Pred pred) { return c.erase_if(std::move(pred)); }
+
+    // set algebra on a copy of lhs, see the set operations of details::flat_base_multiset
+
+    template<typename Set, typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename Key, typename Compare, typename OtherRKey>
+        requires requires(Set& lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) { lhs.set_union(rhs); }
+    Set set_union(Set lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) {
+        lhs.set_union(rhs);
+        return lhs;
+    }
+
+    template<typename Set, typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename Key, typename Compare, typename OtherRKey>
+        requires requires(Set& lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) { lhs.set_intersection(rhs); }
+    Set set_intersection(Set lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) {
+        lhs.set_intersection(rhs);
+        return lhs;
+    }
+
+    template<typename Set, typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename Key, typename Compare, typename OtherRKey>
+        requires requires(Set& lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) { lhs.set_difference(rhs); }
+    Set set_difference(Set lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) {
+        lhs.set_difference(rhs);
+        return lhs;
+    }
+
+    template<typename Set, typename OtherImpl, bool OtherMulti, template<typename>class OtherVector, typename Key, typename Compare, typename OtherRKey>
+        requires requires(Set& lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) { lhs.set_symmetric_difference(rhs); }
+    Set set_symmetric_difference(Set lhs, const details::flat_base_multiset<OtherImpl, OtherMulti, OtherVector, Key, Compare, OtherRKey>& rhs) {
+        lhs.set_symmetric_difference(rhs);
+        return lhs;
+    }
+}
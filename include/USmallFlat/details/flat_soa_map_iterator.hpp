@@ -0,0 +1,67 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace Ubpa::details {
+    // zips a key iterator and a mapped iterator,
+    // dereferences to the proxy std::pair<const Key&, T&> (or std::pair<const Key&, const T&>)
+    template<typename KeyIter, typename MappedIter>
+    class flat_soa_map_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<std::iter_value_t<KeyIter>, std::iter_value_t<MappedIter>>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<std::iter_reference_t<KeyIter>, std::iter_reference_t<MappedIter>>;
+
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept { return &ref; }
+        };
+
+        flat_soa_map_iterator() = default;
+
+        flat_soa_map_iterator(KeyIter key_iter, MappedIter mapped_iter) noexcept :
+            m_key_iter{ key_iter }, m_mapped_iter{ mapped_iter } {}
+
+        // iterator -> const_iterator
+        template<typename OtherMappedIter> requires
+            (!std::is_same_v<OtherMappedIter, MappedIter>) && std::is_convertible_v<OtherMappedIter, MappedIter>
+        flat_soa_map_iterator(const flat_soa_map_iterator<KeyIter, OtherMappedIter>& other) noexcept :
+            m_key_iter{ other.key_iter() }, m_mapped_iter{ other.mapped_iter() } {}
+
+        KeyIter key_iter() const noexcept { return m_key_iter; }
+        MappedIter mapped_iter() const noexcept { return m_mapped_iter; }
+
+        reference operator*() const noexcept { return { *m_key_iter, *m_mapped_iter }; }
+        pointer operator->() const noexcept { return { **this }; }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        flat_soa_map_iterator& operator++() noexcept { ++m_key_iter; ++m_mapped_iter; return *this; }
+        flat_soa_map_iterator operator++(int) noexcept { auto rst = *this; ++*this; return rst; }
+        flat_soa_map_iterator& operator--() noexcept { --m_key_iter; --m_mapped_iter; return *this; }
+        flat_soa_map_iterator operator--(int) noexcept { auto rst = *this; --*this; return rst; }
+
+        flat_soa_map_iterator& operator+=(difference_type n) noexcept { m_key_iter += n; m_mapped_iter += n; return *this; }
+        flat_soa_map_iterator& operator-=(difference_type n) noexcept { m_key_iter -= n; m_mapped_iter -= n; return *this; }
+
+        friend flat_soa_map_iterator operator+(flat_soa_map_iterator iter, difference_type n) noexcept { return iter += n; }
+        friend flat_soa_map_iterator operator+(difference_type n, flat_soa_map_iterator iter) noexcept { return iter += n; }
+        friend flat_soa_map_iterator operator-(flat_soa_map_iterator iter, difference_type n) noexcept { return iter -= n; }
+        friend difference_type operator-(const flat_soa_map_iterator& lhs, const flat_soa_map_iterator& rhs) noexcept
+        { return lhs.m_key_iter - rhs.m_key_iter; }
+
+        // the key iterators alone decide the position
+        friend bool operator==(const flat_soa_map_iterator& lhs, const flat_soa_map_iterator& rhs) noexcept
+        { return lhs.m_key_iter == rhs.m_key_iter; }
+        friend std::strong_ordering operator<=>(const flat_soa_map_iterator& lhs, const flat_soa_map_iterator& rhs) noexcept
+        { return (lhs.m_key_iter - rhs.m_key_iter) <=> 0; }
+
+    private:
+        KeyIter m_key_iter{};
+        MappedIter m_mapped_iter{};
+    };
+}
@@ -0,0 +1,450 @@
+#pragma once
+
+#include "simd_scan.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace Ubpa::details {
+    // Swiss table metadata: one control byte per slot, probed 16 at a time
+    namespace flat_unordered_ctrl {
+        inline constexpr std::uint8_t empty = 0x80;
+        inline constexpr std::uint8_t deleted = 0xFE;
+        inline constexpr std::size_t group_width = 16;
+
+        // bit i: ctrl[i] == h2
+        inline std::uint32_t match(const std::uint8_t* ctrl, std::uint8_t h2) noexcept {
+#ifdef UBPA_USMALLFLAT_SIMD_SCAN_X64
+            const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(h2)))));
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < group_width; i++)
+                mask |= static_cast<std::uint32_t>(ctrl[i] == h2) << i;
+            return mask;
+#endif
+        }
+
+        inline std::uint32_t match_empty(const std::uint8_t* ctrl) noexcept { return match(ctrl, empty); }
+
+        // empty and deleted are the only control bytes with the sign bit
+        inline std::uint32_t match_empty_or_deleted(const std::uint8_t* ctrl) noexcept {
+#ifdef UBPA_USMALLFLAT_SIMD_SCAN_X64
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < group_width; i++)
+                mask |= static_cast<std::uint32_t>(ctrl[i] >> 7) << i;
+            return mask;
+#endif
+        }
+    }
+
+    // the table size for n elements under the 7/8 max load factor
+    constexpr std::size_t flat_unordered_table_capacity(std::size_t n) noexcept {
+        const std::size_t capacity = std::bit_ceil((8 * n + 6) / 7);
+        return capacity < flat_unordered_ctrl::group_width ? flat_unordered_ctrl::group_width : capacity;
+    }
+
+    template<typename T, int Tag, bool = std::is_empty_v<T> && !std::is_final_v<T>>
+    class flat_unordered_functor : private T {
+    protected:
+        flat_unordered_functor(const T& t) : T(t) {}
+        const T& get() const noexcept { return *this; }
+    };
+
+    template<typename T, int Tag>
+    class flat_unordered_functor<T, Tag, false> {
+    protected:
+        flat_unordered_functor(const T& t) : value(t) {}
+        const T& get() const noexcept { return value; }
+    private:
+        T value;
+    };
+
+    // the elements are contiguous in Vector<Slot> in insertion order (erase moves the last element into the hole),
+    // an open addressing table in TableVector maps hashes to their positions:
+    // control bytes (empty, deleted, or the low 7 bits of the hash) and element indices, probed by groups of 16 bytes
+    // Slot: stored element, Value: element seen through iterators (std::pair<Key, T> as std::pair<const Key, T>)
+    template<template<typename>class Vector, template<typename>class TableVector,
+        typename Key, typename Slot, typename Value, typename Hash, typename KeyEqual>
+    class flat_unordered_base :
+        private flat_unordered_functor<Hash, 0>,
+        private flat_unordered_functor<KeyEqual, 1>
+    {
+        using hash_base = flat_unordered_functor<Hash, 0>;
+        using equal_base = flat_unordered_functor<KeyEqual, 1>;
+        static constexpr bool is_set = std::is_same_v<Slot, Value>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = std::conditional_t<is_set, const value_type*, value_type*>;
+        using const_pointer = const value_type*;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+        using container_type = Vector<Slot>;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        flat_unordered_base() : flat_unordered_base(Hash(), KeyEqual()) {}
+
+        explicit flat_unordered_base(const Hash& hash, const KeyEqual& equal = KeyEqual())
+            : hash_base(hash), equal_base(equal) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        flat_unordered_base(Iter first, Iter last, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : hash_base(hash), equal_base(equal)
+        { insert(first, last); }
+
+        flat_unordered_base(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : flat_unordered_base(ilist.begin(), ilist.end(), hash, equal) {}
+
+        flat_unordered_base(const flat_unordered_base&) = default;
+
+        flat_unordered_base(flat_unordered_base&& other) noexcept :
+            hash_base(static_cast<hash_base&&>(other)),
+            equal_base(static_cast<equal_base&&>(other)),
+            m_elems(std::move(other.m_elems)),
+            m_ctrl(std::move(other.m_ctrl)),
+            m_index(std::move(other.m_index)),
+            m_deleted(other.m_deleted)
+        {
+            other.clear();
+        }
+
+        flat_unordered_base& operator=(const flat_unordered_base&) = default;
+
+        flat_unordered_base& operator=(flat_unordered_base&& rhs) noexcept {
+            static_cast<hash_base&>(*this) = static_cast<hash_base&&>(rhs);
+            static_cast<equal_base&>(*this) = static_cast<equal_base&&>(rhs);
+            m_elems = std::move(rhs.m_elems);
+            m_ctrl = std::move(rhs.m_ctrl);
+            m_index = std::move(rhs.m_index);
+            m_deleted = rhs.m_deleted;
+            rhs.clear();
+            return *this;
+        }
+
+        //
+        // Iterators
+        //////////////
+        // in insertion order until an erase
+
+        iterator begin() noexcept { return reinterpret_cast<iterator>(m_elems.data()); }
+        const_iterator begin() const noexcept { return reinterpret_cast<const_iterator>(m_elems.data()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return begin() + m_elems.size(); }
+        const_iterator end() const noexcept { return begin() + m_elems.size(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        //
+        // Capacity
+        /////////////
+
+        [[nodiscard]] bool empty() const noexcept { return m_elems.empty(); }
+
+        size_type size() const noexcept { return m_elems.size(); }
+
+        size_type max_size() const noexcept { return m_elems.max_size(); }
+
+        //
+        // Bucket interface
+        /////////////////////
+
+        size_type bucket_count() const noexcept { return m_ctrl.size(); }
+
+        //
+        // Hash policy
+        ////////////////
+
+        float load_factor() const noexcept { return m_ctrl.empty() ? 0.f : static_cast<float>(size()) / static_cast<float>(m_ctrl.size()); }
+
+        static constexpr float max_load_factor() noexcept { return 7.f / 8.f; }
+
+        // a table for count elements, and room for count elements
+        void reserve(size_type count) {
+            if constexpr (requires { m_elems.reserve(count); })
+                m_elems.reserve(count);
+            if (flat_unordered_table_capacity(count) > m_ctrl.size())
+                rehash(flat_unordered_table_capacity(count));
+        }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            m_elems.clear();
+            m_ctrl.clear();
+            m_index.clear();
+            m_deleted = 0;
+        }
+
+        // moves the elements out (in iteration order), leaves *this empty
+        container_type extract() && {
+            container_type rst = std::move(m_elems);
+            clear();
+            return rst;
+        }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>)
+                reserve(size() + static_cast<size_type>(std::distance(first, last)));
+            for (; first != last; ++first) {
+                const auto& value = *first;
+                insert_unique(key_of(value), [&]() { return Slot(value); });
+            }
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        // the last element is moved to pos, returns pos (or end())
+        iterator erase(const_iterator pos) {
+            const auto index = static_cast<size_type>(pos - begin());
+            erase_at(find_slot_of(index), index);
+            return begin() + index;
+        }
+
+        size_type erase(const key_type& key) { return erase_key(key); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual,
+            typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>
+            && !std::is_convertible_v<K&&, iterator> && !std::is_convertible_v<K&&, const_iterator>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        size_type erase(K&& x) { return erase_key(x); }
+
+        //
+        // Lookup
+        ///////////
+
+        iterator find(const key_type& key) { return find_impl(key); }
+        const_iterator find(const key_type& key) const { return const_cast<flat_unordered_base*>(this)->find_impl(key); }
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        bool contains(const key_type& key) const { return find_slot(key, hash_of(key)) != npos; }
+
+        // -- is_transparent (Hash and KeyEqual)
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        iterator find(const K& x) { return find_impl(x); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        const_iterator find(const K& x) const { return const_cast<flat_unordered_base*>(this)->find_impl(x); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        size_type count(const K& x) const { return static_cast<size_type>(contains(x)); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        bool contains(const K& x) const { return find_slot(x, hash_of(x)) != npos; }
+
+        //
+        // Observers
+        //////////////
+
+        hasher hash_function() const { return hash_base::get(); }
+        key_equal key_eq() const { return equal_base::get(); }
+
+    protected:
+        // inserts make_slot() if no element is equal to key
+        template<typename K, typename MakeSlot>
+        std::pair<iterator, bool> insert_unique(const K& key, MakeSlot&& make_slot) {
+            const std::size_t hash = hash_of(key);
+            if (const size_type slot = find_slot(key, hash); slot != npos)
+                return { begin() + m_index[slot], false };
+
+            if (size() + m_deleted + 1 > max_load(m_ctrl.size())) {
+                const size_type capacity = flat_unordered_table_capacity(size() + 1);
+                rehash(capacity <= bucket_count() ? bucket_count() : std::max(capacity, 2 * bucket_count()));
+            }
+
+            m_elems.push_back(std::forward<MakeSlot>(make_slot)());
+            const size_type slot = find_insert_slot(hash);
+            if (m_ctrl[slot] == flat_unordered_ctrl::deleted)
+                --m_deleted;
+            m_ctrl[slot] = h2_of(hash);
+            m_index[slot] = static_cast<index_type>(size() - 1);
+            return { end() - 1, true };
+        }
+
+        static const Key& key_of(const Slot& slot) noexcept {
+            if constexpr (is_set)
+                return slot;
+            else
+                return slot.first;
+        }
+
+        static const Key& key_of(const Value& value) noexcept requires (!is_set) { return value.first; }
+
+    private:
+        using index_type = std::uint32_t;
+
+        static constexpr size_type npos = static_cast<size_type>(-1);
+        static constexpr size_type W = flat_unordered_ctrl::group_width;
+
+        static constexpr size_type max_load(size_type capacity) noexcept { return capacity - capacity / 8; }
+
+        // std::hash of integers is the identity, the multiplication spreads it over all bits
+        template<typename K>
+        std::size_t hash_of(const K& key) const {
+            const auto hash = static_cast<std::uint64_t>(hash_base::get()(key)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(hash ^ (hash >> 32));
+        }
+
+        static std::uint8_t h2_of(std::size_t hash) noexcept { return static_cast<std::uint8_t>(hash & 0x7F); }
+
+        // the group after the i-th probed one (i from 1), triangular numbers visit all groups of a power of two
+        static size_type probe_first(std::size_t hash, size_type groups) noexcept { return (hash >> 7) & (groups - 1); }
+        static size_type probe_next(size_type group, size_type i, size_type groups) noexcept { return (group + i) & (groups - 1); }
+
+        template<typename K>
+        size_type find_slot(const K& key, std::size_t hash) const {
+            if (m_ctrl.empty())
+                return npos;
+            const size_type groups = m_ctrl.size() / W;
+            const std::uint8_t h2 = h2_of(hash);
+            size_type group = probe_first(hash, groups);
+            for (size_type i = 1; ; i++) {
+                const std::uint8_t* ctrl = m_ctrl.data() + group * W;
+                for (auto mask = flat_unordered_ctrl::match(ctrl, h2); mask != 0; mask &= mask - 1) {
+                    const size_type slot = group * W + static_cast<size_type>(std::countr_zero(mask));
+                    if (equal_base::get()(key_of(m_elems[m_index[slot]]), key))
+                        return slot;
+                }
+                // the probe sequence of key ends at its first group with an empty slot
+                if (flat_unordered_ctrl::match_empty(ctrl) != 0)
+                    return npos;
+                group = probe_next(group, i, groups);
+            }
+        }
+
+        // the slot refering to m_elems[index]
+        size_type find_slot_of(size_type index) const {
+            const std::size_t hash = hash_of(key_of(m_elems[index]));
+            const size_type groups = m_ctrl.size() / W;
+            size_type group = probe_first(hash, groups);
+            for (size_type i = 1; ; i++) {
+                for (auto mask = flat_unordered_ctrl::match(m_ctrl.data() + group * W, h2_of(hash)); mask != 0; mask &= mask - 1) {
+                    const size_type slot = group * W + static_cast<size_type>(std::countr_zero(mask));
+                    if (m_index[slot] == index)
+                        return slot;
+                }
+                group = probe_next(group, i, groups);
+            }
+        }
+
+        // the first empty or deleted slot of the probe sequence
+        size_type find_insert_slot(std::size_t hash) const {
+            const size_type groups = m_ctrl.size() / W;
+            size_type group = probe_first(hash, groups);
+            for (size_type i = 1; ; i++) {
+                if (const auto mask = flat_unordered_ctrl::match_empty_or_deleted(m_ctrl.data() + group * W); mask != 0)
+                    return group * W + static_cast<size_type>(std::countr_zero(mask));
+                group = probe_next(group, i, groups);
+            }
+        }
+
+        // drops the deleted slots
+        void rehash(size_type capacity) {
+            m_ctrl.assign(capacity, flat_unordered_ctrl::empty);
+            m_index.assign(capacity, 0);
+            m_deleted = 0;
+            for (size_type i = 0; i < m_elems.size(); i++) {
+                const std::size_t hash = hash_of(key_of(m_elems[i]));
+                const size_type slot = find_insert_slot(hash);
+                m_ctrl[slot] = h2_of(hash);
+                m_index[slot] = static_cast<index_type>(i);
+            }
+        }
+
+        template<typename K>
+        iterator find_impl(const K& key) {
+            const size_type slot = find_slot(key, hash_of(key));
+            return slot == npos ? end() : begin() + m_index[slot];
+        }
+
+        template<typename K>
+        size_type erase_key(const K& key) {
+            const size_type slot = find_slot(key, hash_of(key));
+            if (slot == npos)
+                return 0;
+            erase_at(slot, m_index[slot]);
+            return 1;
+        }
+
+        void erase_at(size_type slot, size_type index) {
+            // a group with an empty slot never ended a probe sequence passing through it, so the slot can be empty again
+            if (flat_unordered_ctrl::match_empty(m_ctrl.data() + slot / W * W) != 0)
+                m_ctrl[slot] = flat_unordered_ctrl::empty;
+            else {
+                m_ctrl[slot] = flat_unordered_ctrl::deleted;
+                ++m_deleted;
+            }
+
+            const size_type last = size() - 1;
+            if (index != last) {
+                m_index[find_slot_of(last)] = static_cast<index_type>(index);
+                m_elems[index] = std::move(m_elems[last]);
+            }
+            m_elems.pop_back();
+        }
+
+        Vector<Slot> m_elems;
+        TableVector<std::uint8_t> m_ctrl;
+        TableVector<index_type> m_index;
+        size_type m_deleted{ 0 };
+    };
+
+    template<template<typename>class Vector, template<typename>class TableVector,
+        typename Key, typename Slot, typename Value, typename Hash, typename KeyEqual>
+    bool operator==(const flat_unordered_base<Vector, TableVector, Key, Slot, Value, Hash, KeyEqual>& lhs,
+        const flat_unordered_base<Vector, TableVector, Key, Slot, Value, Hash, KeyEqual>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (const auto& elem : lhs) {
+            auto target = [&]() {
+                if constexpr (std::is_same_v<Slot, Value>)
+                    return rhs.find(elem);
+                else
+                    return rhs.find(elem.first);
+            }();
+            if (target == rhs.end() || !(*target == elem))
+                return false;
+        }
+        return true;
+    }
+
+    template<template<typename>class Vector, template<typename>class TableVector,
+        typename Key, typename Slot, typename Value, typename Hash, typename KeyEqual>
+    bool operator!=(const flat_unordered_base<Vector, TableVector, Key, Slot, Value, Hash, KeyEqual>& lhs,
+        const flat_unordered_base<Vector, TableVector, Key, Slot, Value, Hash, KeyEqual>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+
+namespace Ubpa::details {
+    // std::lower_bound for a target expected near first:
+    // probes first + 1, + 2, + 4, ... then searches the last gap, O(log d) for a target d elements away
+    template<typename Iter, typename T, typename Comp>
+    constexpr Iter gallop_lower_bound(Iter first, Iter last, const T& value, Comp&& comp) {
+        if (first == last || !comp(*first, value)) // value <= first
+            return first;
+        std::iter_difference_t<Iter> step = 1;
+        while (step < last - first && comp(first[step], value)) { // first + step < value
+            first += step;
+            step *= 2;
+        }
+        return std::lower_bound(std::next(first), first + std::min(step + 1, last - first), value, comp);
+    }
+
+    // std::upper_bound for a target expected near first
+    template<typename Iter, typename T, typename Comp>
+    constexpr Iter gallop_upper_bound(Iter first, Iter last, const T& value, Comp&& comp) {
+        if (first == last || comp(value, *first)) // value < first
+            return first;
+        std::iter_difference_t<Iter> step = 1;
+        while (step < last - first && !comp(value, first[step])) { // first + step <= value
+            first += step;
+            step *= 2;
+        }
+        return std::upper_bound(std::next(first), first + std::min(step + 1, last - first), value, comp);
+    }
+}
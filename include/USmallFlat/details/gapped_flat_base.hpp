@@ -0,0 +1,484 @@
+#pragma once
+
+#include "flat_base_multiset.hpp"
+#include "gapped_iterator.hpp"
+
+#include <bit>
+#include <numeric>
+
+namespace Ubpa::details {
+    inline constexpr std::size_t gapped_segment_size = 64;
+
+    // packed memory array: the sorted elements are spread over segments of gapped_segment_size slots,
+    // each segment keeps its elements at the front followed by gaps, and no segment is empty
+    // - an insert shifts inside its segment, a full segment spreads the smallest enclosing window
+    //   (2, 4, 8, ... segments) under its upper density bound evenly, else the array is rebuilt half full,
+    //   amortized O(log^2(n)) moves instead of the O(n) of a contiguous flat set
+    // - an erase that empties a segment spreads the smallest window over its lower density bound
+    // - lookups binary search the first element of each segment, then search in one segment
+    // Slot: stored element, Value: element seen through iterators
+    // require
+    // - Slot is default constructible (the gaps) and move assignable
+    template<template<typename>class Vector, typename Slot, typename Value, typename Compare>
+    class gapped_flat_base : private flat_base_multiset_base<Compare> {
+        using mybase = flat_base_multiset_base<Compare>;
+        using search_traits = flat_search_traits<Slot, Compare>;
+        static constexpr bool is_set = std::is_same_v<Slot, Value>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = typename search_traits::key_type;
+        using value_type = Value;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = typename search_traits::key_compare;
+        using value_compare = Compare;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using iterator = gapped_iterator<std::conditional_t<is_set, const Value, Value>, std::conditional_t<is_set, const Slot, Slot>, gapped_segment_size>;
+        using const_iterator = gapped_iterator<const Value, const Slot, gapped_segment_size>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_type segment_size = gapped_segment_size;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        gapped_flat_base() : gapped_flat_base(key_compare()) {}
+
+        explicit gapped_flat_base(const key_compare& comp) : mybase(comp) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        gapped_flat_base(Iter first, Iter last, const key_compare& comp = key_compare()) : mybase(comp) { insert(first, last); }
+
+        gapped_flat_base(std::initializer_list<value_type> ilist, const key_compare& comp = key_compare())
+            : gapped_flat_base(ilist.begin(), ilist.end(), comp) {}
+
+        gapped_flat_base(const gapped_flat_base&) = default;
+
+        gapped_flat_base(gapped_flat_base&& other) noexcept :
+            mybase(static_cast<mybase&&>(other)),
+            m_slots(std::move(other.m_slots)),
+            m_counts(std::move(other.m_counts)),
+            m_size(other.m_size)
+        {
+            other.clear();
+        }
+
+        gapped_flat_base& operator=(const gapped_flat_base&) = default;
+
+        gapped_flat_base& operator=(gapped_flat_base&& rhs) noexcept {
+            static_cast<mybase&>(*this) = static_cast<mybase&&>(rhs);
+            m_slots = std::move(rhs.m_slots);
+            m_counts = std::move(rhs.m_counts);
+            m_size = rhs.m_size;
+            rhs.clear();
+            return *this;
+        }
+
+        //
+        // Iterators
+        //////////////
+
+        iterator begin() noexcept { return make_iterator(m_size == 0 ? m_slots.size() : 0); }
+        const_iterator begin() const noexcept { return make_iterator(m_size == 0 ? m_slots.size() : 0); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return make_iterator(m_slots.size()); }
+        const_iterator end() const noexcept { return make_iterator(m_slots.size()); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        //
+        // Capacity
+        /////////////
+
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+        size_type size() const noexcept { return m_size; }
+
+        size_type max_size() const noexcept { return m_slots.max_size(); }
+
+        // slots including the gaps
+        size_type capacity() const noexcept { return m_slots.size(); }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            m_slots.clear();
+            m_counts.clear();
+            m_size = 0;
+        }
+
+        // the new elements are sorted and merged with the old ones, then spread once, O(n + k log(k))
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            Vector<Slot> elems;
+            gather(elems, 0, segment_count());
+            const auto mid = static_cast<difference_type>(elems.size());
+            for (; first != last; ++first)
+                elems.emplace_back(*first);
+            std::stable_sort(elems.begin() + mid, elems.end(), this->GetCompare());
+            std::inplace_merge(elems.begin(), elems.begin() + mid, elems.end(), this->GetCompare());
+            // the first of equivalent elements is kept, old ones come first
+            elems.erase(std::unique(elems.begin(), elems.end(), [this](const Slot& lhs, const Slot& rhs) {
+                return !this->GetCompare()(lhs, rhs);
+            }), elems.end());
+            rebuild(elems, 0);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        iterator erase(const_iterator pos) { return make_iterator(erase_at(pos.index())); }
+
+        size_type erase(const key_type& key) {
+            const size_type index = find_index(key);
+            if (index == m_slots.size())
+                return 0;
+            erase_at(index);
+            return 1;
+        }
+
+        // erases the elements satisfying pred in one pass, returns the count
+        template<typename Pred>
+        size_type erase_if(Pred pred) {
+            Vector<Slot> elems;
+            gather(elems, 0, segment_count());
+            const auto last = std::remove_if(elems.begin(), elems.end(),
+                [&](Slot& elem) { return pred(reinterpret_cast<value_type&>(elem)); });
+            const auto cnt = static_cast<size_type>(std::distance(last, elems.end()));
+            elems.erase(last, elems.end());
+            rebuild(elems, 0);
+            return cnt;
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        size_type count(const K& x) const { return static_cast<size_type>(contains(x)); }
+
+        bool contains(const key_type& key) const { return find_index(key) != m_slots.size(); }
+
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        bool contains(const K& x) const { return find_index(x) != m_slots.size(); }
+
+        iterator find(const key_type& key) { return make_iterator(find_index(key)); }
+        const_iterator find(const key_type& key) const { return make_iterator(find_index(key)); }
+
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        iterator find(const K& x) { return make_iterator(find_index(x)); }
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        const_iterator find(const K& x) const { return make_iterator(find_index(x)); }
+
+        std::pair<iterator, iterator> equal_range(const key_type& key) { return { lower_bound(key), upper_bound(key) }; }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return { lower_bound(key), upper_bound(key) }; }
+
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        std::pair<iterator, iterator> equal_range(const K& x) { return { lower_bound(x), upper_bound(x) }; }
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        std::pair<const_iterator, const_iterator> equal_range(const K& x) const { return { lower_bound(x), upper_bound(x) }; }
+
+        iterator lower_bound(const key_type& key) { return make_iterator(lower_bound_index(key)); }
+        const_iterator lower_bound(const key_type& key) const { return make_iterator(lower_bound_index(key)); }
+
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        iterator lower_bound(const K& x) { return make_iterator(lower_bound_index(x)); }
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        const_iterator lower_bound(const K& x) const { return make_iterator(lower_bound_index(x)); }
+
+        iterator upper_bound(const key_type& key) { return make_iterator(upper_bound_index(key)); }
+        const_iterator upper_bound(const key_type& key) const { return make_iterator(upper_bound_index(key)); }
+
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        iterator upper_bound(const K& x) { return make_iterator(upper_bound_index(x)); }
+        template<typename K, typename Comp_ = key_compare, typename = std::enable_if_t<std::is_same_v<Comp_, key_compare>, typename Comp_::is_transparent>>
+        const_iterator upper_bound(const K& x) const { return make_iterator(upper_bound_index(x)); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return search_traits::compare(this->GetCompare()); }
+        value_compare value_comp() const { return this->GetCompare(); }
+
+    protected:
+        // inserts make_slot() if no element is equivalent to key
+        template<typename K, typename MakeSlot>
+        std::pair<iterator, bool> insert_unique(const K& key, MakeSlot&& make_slot) {
+            const size_type index = lower_bound_index(key);
+            if (index != m_slots.size() && !search_traits::compare(this->GetCompare())(key, key_at(index)))
+                return { make_iterator(index), false };
+            return { make_iterator(insert_at(index, std::forward<MakeSlot>(make_slot)())), true };
+        }
+
+    private:
+        static constexpr size_type S = gapped_segment_size;
+
+        static constexpr auto project_key = [](const auto& value) -> decltype(auto) { return search_traits::key(value); };
+
+        template<typename K>
+        static constexpr bool use_branchless_search = std::is_arithmetic_v<K> && enable_branchless_search_v<key_type, key_compare>;
+
+        iterator make_iterator(size_type index) noexcept { return { m_slots.data(), m_counts.data(), index }; }
+        const_iterator make_iterator(size_type index) const noexcept { return { m_slots.data(), m_counts.data(), index }; }
+
+        size_type segment_count() const noexcept { return m_counts.size(); }
+
+        const key_type& key_at(size_type index) const noexcept { return search_traits::key(m_slots[index]); }
+
+        //
+        // Search
+        ///////////
+
+        // the first segment s with !pred(s), pred is true for a prefix of the segments
+        template<typename K, typename Pred>
+        size_type partition_segments(Pred pred) const {
+            size_type first = 0;
+            size_type cnt = segment_count();
+            if constexpr (use_branchless_search<K>) {
+                if (cnt == 0)
+                    return 0;
+                while (cnt > 1) {
+                    const size_type half = cnt / 2;
+                    first = pred(first + half - 1) ? first + half : first;
+                    cnt -= half;
+                }
+                return first + static_cast<size_type>(pred(first));
+            }
+            else {
+                while (cnt > 0) {
+                    const size_type half = cnt / 2;
+                    if (pred(first + half)) {
+                        first += half + 1;
+                        cnt -= half + 1;
+                    }
+                    else
+                        cnt = half;
+                }
+                return first;
+            }
+        }
+
+        // the segments are searched by their first elements, the searched part of m_slots is one slot per segment
+
+        template<typename K>
+        size_type lower_bound_index(const K& key) const {
+            const auto& comp = search_traits::compare(this->GetCompare());
+            // lower bound is in the last segment whose first element is less than key, or the first of the next
+            const size_type next = partition_segments<K>([&](size_type s) { return comp(key_at(s * S), key); });
+            if (next == 0)
+                return segment_count() == 0 ? m_slots.size() : 0;
+            const size_type segment = next - 1;
+            const Slot* first = m_slots.data() + segment * S;
+            const Slot* last = first + m_counts[segment];
+            const Slot* rst;
+            if constexpr (use_branchless_search<K>)
+                rst = fast_lower_bound<key_type, key_compare>(first, last, key, project_key);
+            else
+                rst = std::lower_bound(first, last, key, this->GetCompare());
+            return rst == last ? next * S : segment * S + static_cast<size_type>(rst - first);
+        }
+
+        template<typename K>
+        size_type upper_bound_index(const K& key) const {
+            const auto& comp = search_traits::compare(this->GetCompare());
+            // upper bound is in the last segment whose first element is not greater than key, or the first of the next
+            const size_type next = partition_segments<K>([&](size_type s) { return !comp(key, key_at(s * S)); });
+            if (next == 0)
+                return segment_count() == 0 ? m_slots.size() : 0;
+            const size_type segment = next - 1;
+            const Slot* first = m_slots.data() + segment * S;
+            const Slot* last = first + m_counts[segment];
+            const Slot* rst;
+            if constexpr (use_branchless_search<K>)
+                rst = fast_upper_bound<key_type, key_compare>(first, last, key, project_key);
+            else
+                rst = std::upper_bound(first, last, key, this->GetCompare());
+            return rst == last ? next * S : segment * S + static_cast<size_type>(rst - first);
+        }
+
+        template<typename K>
+        size_type find_index(const K& key) const {
+            const size_type index = lower_bound_index(key);
+            if (index != m_slots.size() && search_traits::compare(this->GetCompare())(key, key_at(index)))
+                return m_slots.size();
+            return index;
+        }
+
+        //
+        // Rebalance
+        //////////////
+        // densities of a window of 2^h of the 2^H segments
+        // - upper: 1 at the segments down to 3/4 at the whole array
+        // - lower: 1 element per segment up to 1/8 at the whole array
+
+        size_type count_in(size_type first_segment, size_type width) const noexcept {
+            return std::accumulate(m_counts.begin() + first_segment, m_counts.begin() + first_segment + width, size_type{ 0 });
+        }
+
+        // moves out the elements of the segments [first_segment, last_segment)
+        void gather(Vector<Slot>& elems, size_type first_segment, size_type last_segment) {
+            for (size_type s = first_segment; s < last_segment; s++) {
+                auto first = m_slots.begin() + s * S;
+                elems.insert(elems.end(), std::make_move_iterator(first), std::make_move_iterator(first + m_counts[s]));
+            }
+        }
+
+        // spreads elems evenly over the segments [first_segment, first_segment + width),
+        // returns the slot of elems[rank] (the slot after the window if rank == elems.size())
+        size_type spread(Vector<Slot>& elems, size_type first_segment, size_type width, size_type rank) {
+            const size_type cnt = elems.size();
+            size_type rst = (first_segment + width) * S;
+            size_type k = 0;
+            for (size_type j = 0; j < width; j++) {
+                const size_type s = first_segment + j;
+                const size_type n = (j + 1) * cnt / width - j * cnt / width;
+                auto first = m_slots.begin() + s * S;
+                for (size_type i = 0; i < n; i++, k++) {
+                    if (k == rank)
+                        rst = s * S + i;
+                    first[i] = std::move(elems[k]);
+                }
+                // release the moved-from elements
+                for (size_type i = n; i < m_counts[s]; i++)
+                    first[i] = Slot{};
+                m_counts[s] = n;
+            }
+            return rst;
+        }
+
+        // about half full
+        size_type rebuild(Vector<Slot>& elems, size_type rank) {
+            clear();
+            if (elems.empty())
+                return 0;
+            const size_type segments = std::bit_ceil((2 * elems.size() + S - 1) / S);
+            m_slots.resize(segments * S);
+            m_counts.assign(segments, 0);
+            m_size = elems.size();
+            return spread(elems, 0, segments, rank);
+        }
+
+        // index: lower bound of value, returns the slot of value
+        size_type insert_at(size_type index, Slot&& value) {
+            if (segment_count() == 0) {
+                Vector<Slot> elems;
+                elems.push_back(std::move(value));
+                return rebuild(elems, 0);
+            }
+
+            size_type segment, offset;
+            if (index == m_slots.size()) {
+                segment = segment_count() - 1;
+                offset = m_counts[segment];
+            }
+            else {
+                segment = index / S;
+                offset = index % S;
+            }
+
+            if (m_counts[segment] < S) {
+                auto first = m_slots.begin() + segment * S;
+                std::move_backward(first + offset, first + m_counts[segment], first + m_counts[segment] + 1);
+                first[offset] = std::move(value);
+                ++m_counts[segment];
+                ++m_size;
+                return segment * S + offset;
+            }
+
+            const size_type height = static_cast<size_type>(std::bit_width(segment_count())) - 1;
+            size_type first_segment = 0;
+            size_type width = segment_count();
+            for (size_type h = 1; h <= height; h++) {
+                const size_type w = size_type{ 1 } << h;
+                const size_type f = segment & ~(w - 1);
+                if ((count_in(f, w) + 1) * 4 * height <= w * S * (4 * height - h)) {
+                    first_segment = f;
+                    width = w;
+                    break;
+                }
+            }
+
+            Vector<Slot> elems;
+            gather(elems, first_segment, segment);
+            const size_type rank = elems.size() + offset;
+            gather(elems, segment, first_segment + width);
+            elems.insert(elems.begin() + rank, std::move(value));
+            if (width == segment_count() && elems.size() * 4 > width * S * 3)
+                return rebuild(elems, rank);
+            ++m_size;
+            return spread(elems, first_segment, width, rank);
+        }
+
+        // returns the slot of the next element
+        size_type erase_at(size_type index) {
+            const size_type segment = index / S;
+            const size_type offset = index % S;
+            auto first = m_slots.begin() + segment * S;
+            std::move(first + offset + 1, first + m_counts[segment], first + offset);
+            first[m_counts[segment] - 1] = Slot{};
+            --m_counts[segment];
+            --m_size;
+
+            if (m_size == 0) {
+                clear();
+                return 0;
+            }
+            if (m_counts[segment] > 0)
+                return offset < m_counts[segment] ? index : (segment + 1) * S;
+
+            const size_type height = static_cast<size_type>(std::bit_width(segment_count())) - 1;
+            size_type first_segment = 0;
+            size_type width = segment_count();
+            for (size_type h = 1; h <= height; h++) {
+                const size_type w = size_type{ 1 } << h;
+                const size_type f = segment & ~(w - 1);
+                const size_type cnt = count_in(f, w);
+                if (cnt >= w && cnt * 8 * height >= w * S * h) {
+                    first_segment = f;
+                    width = w;
+                    break;
+                }
+            }
+
+            Vector<Slot> elems;
+            gather(elems, first_segment, segment);
+            const size_type rank = elems.size();
+            gather(elems, segment + 1, first_segment + width);
+            if (width == segment_count() && (elems.size() < width || elems.size() * 8 < width * S))
+                return rebuild(elems, rank);
+            return spread(elems, first_segment, width, rank);
+        }
+
+        Vector<Slot> m_slots;
+        Vector<size_type> m_counts;
+        size_type m_size{ 0 };
+    };
+
+    template<template<typename>class Vector, typename Slot, typename Value, typename Compare>
+    bool operator==(const gapped_flat_base<Vector, Slot, Value, Compare>& lhs, const gapped_flat_base<Vector, Slot, Value, Compare>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<template<typename>class Vector, typename Slot, typename Value, typename Compare>
+    bool operator!=(const gapped_flat_base<Vector, Slot, Value, Compare>& lhs, const gapped_flat_base<Vector, Slot, Value, Compare>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace Ubpa::details {
+    // walks the elements of a segmented array, segment s holds counts[s] elements
+    // at [s * SegmentSize, s * SegmentSize + counts[s]) followed by gaps, no segment is empty
+    // dereferences Slot as Value (std::pair<Key, T> as std::pair<const Key, T>, like flat_base_multimap)
+    template<typename Value, typename Slot, std::size_t SegmentSize>
+    class gapped_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference = Value&;
+        using pointer = Value*;
+
+        gapped_iterator() = default;
+
+        gapped_iterator(Slot* slots, const std::size_t* counts, std::size_t index) noexcept :
+            m_slots{ slots }, m_counts{ counts }, m_index{ index } {}
+
+        // iterator -> const_iterator
+        template<typename OtherValue, typename OtherSlot> requires
+            (!std::is_same_v<OtherSlot, Slot>) && std::is_convertible_v<OtherSlot*, Slot*>
+        gapped_iterator(const gapped_iterator<OtherValue, OtherSlot, SegmentSize>& other) noexcept :
+            m_slots{ other.slots() }, m_counts{ other.counts() }, m_index{ other.index() } {}
+
+        Slot* slots() const noexcept { return m_slots; }
+        const std::size_t* counts() const noexcept { return m_counts; }
+        // the slot of the element
+        std::size_t index() const noexcept { return m_index; }
+
+        reference operator*() const noexcept { return reinterpret_cast<reference>(m_slots[m_index]); }
+        pointer operator->() const noexcept { return &**this; }
+
+        gapped_iterator& operator++() noexcept {
+            const std::size_t segment = m_index / SegmentSize;
+            if (++m_index == segment * SegmentSize + m_counts[segment])
+                m_index = (segment + 1) * SegmentSize;
+            return *this;
+        }
+        gapped_iterator operator++(int) noexcept { auto rst = *this; ++*this; return rst; }
+
+        gapped_iterator& operator--() noexcept {
+            if (m_index % SegmentSize == 0) {
+                const std::size_t segment = m_index / SegmentSize - 1;
+                m_index = segment * SegmentSize + m_counts[segment] - 1;
+            }
+            else
+                --m_index;
+            return *this;
+        }
+        gapped_iterator operator--(int) noexcept { auto rst = *this; --*this; return rst; }
+
+        friend bool operator==(const gapped_iterator& lhs, const gapped_iterator& rhs) noexcept
+        { return lhs.m_index == rhs.m_index; }
+
+    private:
+        Slot* m_slots{};
+        const std::size_t* m_counts{};
+        std::size_t m_index{};
+    };
+}
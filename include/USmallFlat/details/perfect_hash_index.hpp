@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Ubpa::details {
+    // murmur3 finalizer of hash ^ seed, a different seed gives an independent hash
+    constexpr std::uint64_t perfect_hash_mix(std::uint64_t hash, std::uint64_t seed) noexcept {
+        hash ^= seed * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // a minimal perfect hash of N distinct 64-bit hashes onto the slots [0, N) (CHD, hash and displace):
+    // a hash falls in the bucket mix(hash, seed), the displacement d of its bucket gives its slot,
+    // - d < 0: the bucket holds a single hash, its slot is -d - 1
+    // - d >= 0: the slot is mix(hash, d)
+    // the buckets are placed by decreasing size, each one with the first d sending all its hashes to free slots,
+    // so a lookup costs at most two mixes and two loads; a hash outside the set gets some slot, the caller compares keys
+    template<std::size_t N>
+    class perfect_hash_index {
+        static_assert(N > 0 && N < (std::size_t{ 1 } << 31));
+    public:
+        using size_type = std::size_t;
+
+        // the hashes must be distinct, throws std::invalid_argument if no perfect hash is found
+        constexpr explicit perfect_hash_index(const std::array<std::uint64_t, N>& hashes) {
+            for (std::uint64_t attempt = 0; attempt < max_attempts; attempt++) {
+                if (try_build(hashes, ~attempt))
+                    return;
+            }
+            throw std::invalid_argument("perfect_hash_index: no perfect hash found, are the hashes distinct?");
+        }
+
+        constexpr size_type slot(std::uint64_t hash) const noexcept {
+            const std::int32_t d = m_displacements[reduce(perfect_hash_mix(hash, m_seed))];
+            return d < 0 ? static_cast<size_type>(-(d + 1)) : reduce(perfect_hash_mix(hash, static_cast<std::uint64_t>(d)));
+        }
+
+    private:
+        static constexpr std::uint64_t max_attempts = 16;
+        static constexpr std::int32_t max_displacement = 1 << 16;
+
+        // multiply-shift instead of a modulo, in [0, N)
+        static constexpr size_type reduce(std::uint64_t hash) noexcept {
+            return static_cast<size_type>(((hash >> 32) * N) >> 32);
+        }
+
+        constexpr bool try_build(const std::array<std::uint64_t, N>& hashes, std::uint64_t seed) {
+            m_seed = seed;
+            m_displacements.fill(0);
+
+            std::array<size_type, N> bucket_of{};
+            std::array<size_type, N> bucket_size{};
+            for (size_type i = 0; i < N; i++)
+                bucket_size[bucket_of[i] = reduce(perfect_hash_mix(hashes[i], seed))]++;
+
+            // hash indices grouped by bucket, the largest buckets first
+            std::array<size_type, N> order{};
+            for (size_type i = 0; i < N; i++)
+                order[i] = i;
+            std::sort(order.begin(), order.end(), [&](size_type lhs, size_type rhs) {
+                const size_type lb = bucket_of[lhs], rb = bucket_of[rhs];
+                return bucket_size[lb] != bucket_size[rb] ? bucket_size[lb] > bucket_size[rb] : lb < rb;
+            });
+
+            std::array<bool, N> used{};
+            std::array<size_type, N> slots{};
+            size_type i = 0;
+            for (; i < N && bucket_size[bucket_of[order[i]]] > 1; ) {
+                const size_type bucket = bucket_of[order[i]];
+                const size_type n = bucket_size[bucket];
+                std::int32_t d = 0;
+                for (; d < max_displacement; d++) {
+                    size_type k = 0;
+                    for (; k < n; k++) {
+                        const size_type s = reduce(perfect_hash_mix(hashes[order[i + k]], static_cast<std::uint64_t>(d)));
+                        if (used[s] || std::find(slots.begin(), slots.begin() + k, s) != slots.begin() + k)
+                            break;
+                        slots[k] = s;
+                    }
+                    if (k == n)
+                        break;
+                }
+                if (d == max_displacement)
+                    return false;
+                for (size_type k = 0; k < n; k++)
+                    used[slots[k]] = true;
+                m_displacements[bucket] = d;
+                i += n;
+            }
+
+            // the single hashes take the free slots directly
+            size_type free = 0;
+            for (; i < N; i++) {
+                while (used[free])
+                    free++;
+                used[free] = true;
+                m_displacements[bucket_of[order[i]]] = -static_cast<std::int32_t>(free) - 1;
+            }
+            return true;
+        }
+
+        std::uint64_t m_seed{ 0 };
+        std::array<std::int32_t, N> m_displacements{}; // per bucket
+    };
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace Ubpa::details {
+    // a read hint, no-op where the compiler has no builtin
+    inline void prefetch(const void* addr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(addr);
+#else
+        (void)addr;
+#endif
+    }
+}
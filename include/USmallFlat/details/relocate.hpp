@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../is_trivially_relocatable.hpp"
+
+#include <cstring>
+#include <memory>
+#include <algorithm>
+
+namespace Ubpa::details {
+    // move [first, last) to the uninitialized dest and destroy the source,
+    // the ranges must not overlap
+    template<typename T>
+    void uninitialized_relocate(T* first, T* last, T* dest)
+        noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+    {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (first != last)
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+        }
+        else {
+            std::uninitialized_move(first, last, dest);
+            std::destroy(first, last);
+        }
+    }
+
+    // relocate [first, last) to dest in the same buffer, the ranges may overlap
+    template<typename T>
+    void relocate_overlapping(T* first, T* last, T* dest) noexcept {
+        static_assert(is_trivially_relocatable_v<T>);
+        if (first != last)
+            std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+    }
+
+    // relocate the element at last to pos, [pos, last) moves one to the right
+    template<typename T>
+    void relocate_last_to(T* pos, T* last) noexcept {
+        static_assert(is_trivially_relocatable_v<T>);
+        alignas(T) unsigned char buffer[sizeof(T)];
+        std::memcpy(buffer, static_cast<const void*>(last), sizeof(T));
+        relocate_overlapping(pos, last, pos + 1);
+        std::memcpy(static_cast<void*>(pos), buffer, sizeof(T));
+    }
+
+    // make room for count elements at pos of [pos, last) and construct them with ctor(pos),
+    // the storage [last, last + count) is uninitialized
+    template<typename T, typename Ctor>
+    void uninitialized_insert(T* pos, T* last, std::size_t count, Ctor&& ctor) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            relocate_overlapping(pos, last, pos + count);
+            try {
+                ctor(pos);
+            }
+            catch (...) {
+                relocate_overlapping(pos + count, last + count, pos);
+                throw;
+            }
+        }
+        else {
+            ctor(last);
+            std::rotate(pos, last, last + count);
+        }
+    }
+
+    // remove [first, last) from [.., end), returns the new end
+    template<typename T>
+    T* erase_range(T* first, T* last, T* end) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_assignable_v<T>) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::destroy(first, last);
+            relocate_overlapping(last, end, first);
+            return first + (end - last);
+        }
+        else {
+            T* newend = std::move(last, end, first);
+            std::destroy(newend, end);
+            return newend;
+        }
+    }
+}
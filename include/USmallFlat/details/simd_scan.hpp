@@ -0,0 +1,149 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define UBPA_USMALLFLAT_SIMD_SCAN_X64
+#include <immintrin.h>
+#endif
+
+namespace Ubpa::details {
+    // counts the elements of [first, first + n) with elem < key (or key < elem if KeyFirst)
+    // no early exit, the whole array is compared
+
+    template<bool KeyFirst, typename T>
+    constexpr std::size_t count_less_scalar(const T* first, std::size_t n, T key) noexcept {
+        std::size_t cnt = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            if constexpr (KeyFirst)
+                cnt += static_cast<std::size_t>(key < first[i]);
+            else
+                cnt += static_cast<std::size_t>(first[i] < key);
+        }
+        return cnt;
+    }
+
+    // the key types with a vector path
+    template<typename T>
+    inline constexpr bool is_simd_scan_key_v = std::is_same_v<T, float> || std::is_same_v<T, double>
+        || (std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+#ifdef UBPA_USMALLFLAT_SIMD_SCAN_X64
+    // detected once at startup
+    inline const bool cpu_has_avx2 = [] {
+#if defined(__AVX2__)
+        return true;
+#elif defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        return false;
+#endif
+    }();
+
+    // x86-64 always has SSE2: 4 x 32-bit lanes, 64-bit keys stay scalar (no 64-bit compare before SSE4.2)
+    template<bool KeyFirst, typename T>
+    std::size_t count_less_sse2(const T* first, std::size_t n, T key) noexcept {
+        static_assert(sizeof(T) == 4);
+        std::size_t cnt = 0;
+        std::size_t i = 0;
+        if constexpr (std::is_floating_point_v<T>) {
+            const __m128 k = _mm_set1_ps(key);
+            for (; i + 4 <= n; i += 4) {
+                const __m128 v = _mm_loadu_ps(first + i);
+                const __m128 m = KeyFirst ? _mm_cmplt_ps(k, v) : _mm_cmplt_ps(v, k);
+                cnt += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm_movemask_ps(m))));
+            }
+        }
+        else {
+            // unsigned order is the signed order with flipped sign bits
+            const __m128i bias = _mm_set1_epi32(std::is_signed_v<T> ? 0 : INT32_MIN);
+            const __m128i k = _mm_xor_si128(_mm_set1_epi32(static_cast<std::int32_t>(key)), bias);
+            for (; i + 4 <= n; i += 4) {
+                const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), bias);
+                const __m128i m = KeyFirst ? _mm_cmplt_epi32(k, v) : _mm_cmplt_epi32(v, k);
+                cnt += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m)))));
+            }
+        }
+        return cnt + count_less_scalar<KeyFirst>(first + i, n - i, key);
+    }
+
+    template<bool KeyFirst, typename T>
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((target("avx2")))
+#endif
+    std::size_t count_less_avx2(const T* first, std::size_t n, T key) noexcept {
+        std::size_t cnt = 0;
+        std::size_t i = 0;
+        constexpr std::size_t lanes = 32 / sizeof(T);
+        if constexpr (std::is_same_v<T, float>) {
+            const __m256 k = _mm256_set1_ps(key);
+            for (; i + lanes <= n; i += lanes) {
+                const __m256 v = _mm256_loadu_ps(first + i);
+                const __m256 m = KeyFirst ? _mm256_cmp_ps(k, v, _CMP_LT_OQ) : _mm256_cmp_ps(v, k, _CMP_LT_OQ);
+                cnt += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm256_movemask_ps(m))));
+            }
+        }
+        else if constexpr (std::is_same_v<T, double>) {
+            const __m256d k = _mm256_set1_pd(key);
+            for (; i + lanes <= n; i += lanes) {
+                const __m256d v = _mm256_loadu_pd(first + i);
+                const __m256d m = KeyFirst ? _mm256_cmp_pd(k, v, _CMP_LT_OQ) : _mm256_cmp_pd(v, k, _CMP_LT_OQ);
+                cnt += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm256_movemask_pd(m))));
+            }
+        }
+        else if constexpr (sizeof(T) == 4) {
+            const __m256i bias = _mm256_set1_epi32(std::is_signed_v<T> ? 0 : INT32_MIN);
+            const __m256i k = _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(key)), bias);
+            for (; i + lanes <= n; i += lanes) {
+                const __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)), bias);
+                const __m256i m = KeyFirst ? _mm256_cmpgt_epi32(v, k) : _mm256_cmpgt_epi32(k, v);
+                cnt += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m)))));
+            }
+        }
+        else {
+            const __m256i bias = _mm256_set1_epi64x(std::is_signed_v<T> ? 0 : INT64_MIN);
+            const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<std::int64_t>(key)), bias);
+            for (; i + lanes <= n; i += lanes) {
+                const __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)), bias);
+                const __m256i m = KeyFirst ? _mm256_cmpgt_epi64(v, k) : _mm256_cmpgt_epi64(k, v);
+                cnt += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m)))));
+            }
+        }
+        return cnt + count_less_scalar<KeyFirst>(first + i, n - i, key);
+    }
+#endif
+
+    // runtime dispatch: AVX2 if the CPU has it, else SSE2 for 32-bit keys, else scalar
+    template<bool KeyFirst, typename T>
+    constexpr std::size_t count_less(const T* first, std::size_t n, T key) noexcept {
+#ifdef UBPA_USMALLFLAT_SIMD_SCAN_X64
+        if constexpr (is_simd_scan_key_v<T>) {
+            if (!std::is_constant_evaluated()) {
+                if (cpu_has_avx2)
+                    return count_less_avx2<KeyFirst>(first, n, key);
+                if constexpr (sizeof(T) == 4)
+                    return count_less_sse2<KeyFirst>(first, n, key);
+            }
+        }
+#endif
+        return count_less_scalar<KeyFirst>(first, n, key);
+    }
+
+    // the ranks of std::lower_bound / std::upper_bound in a sorted array,
+    // Greater: ordered by std::greater instead of std::less
+    template<bool Greater, typename T>
+    constexpr std::size_t simd_lower_rank(const T* first, std::size_t n, T key) noexcept {
+        // less: elem < key, greater: key < elem
+        return count_less<Greater>(first, n, key);
+    }
+
+    template<bool Greater, typename T>
+    constexpr std::size_t simd_upper_rank(const T* first, std::size_t n, T key) noexcept {
+        // less: !(key < elem), greater: !(elem < key)
+        return n - count_less<!Greater>(first, n, key);
+    }
+}
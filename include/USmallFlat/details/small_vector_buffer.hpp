@@ -0,0 +1,126 @@
+#pragma once
+
+#include "relocate.hpp"
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Ubpa::details {
+    template<typename Allocator, bool = std::is_empty_v<Allocator> && !std::is_final_v<Allocator>>
+    class small_vector_buffer_base : private Allocator {
+    protected:
+        template<typename Alloc>
+        constexpr small_vector_buffer_base(Alloc&& a) noexcept(std::is_nothrow_constructible_v<Allocator, Alloc>) :
+            Allocator{ std::forward<Alloc>(a) } {}
+
+        constexpr Allocator& GetAllocator() noexcept { return *this; }
+        constexpr const Allocator& GetAllocator() const noexcept { return *this; }
+    };
+
+    template<typename Allocator>
+    class small_vector_buffer_base<Allocator, false> {
+    protected:
+        template<typename Alloc>
+        constexpr small_vector_buffer_base(Alloc&& a) noexcept(std::is_nothrow_constructible_v<Allocator, Alloc>) :
+            alloc{ std::forward<Alloc>(a) } {}
+
+        constexpr Allocator& GetAllocator() noexcept { return alloc; }
+        constexpr const Allocator& GetAllocator() const noexcept { return alloc; }
+    private:
+        Allocator alloc;
+    };
+
+    // raw heap storage of basic_small_vector: an allocator-owned pointer and a capacity,
+    // the owner tracks how many elements are constructed
+    template<typename T, typename Allocator = std::allocator<T>>
+    class small_vector_buffer : private small_vector_buffer_base<Allocator> {
+        using mybase = small_vector_buffer_base<Allocator>;
+        using alloc_traits = std::allocator_traits<Allocator>;
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using pointer = T*;
+
+        small_vector_buffer() noexcept(std::is_nothrow_default_constructible_v<Allocator>) : mybase(Allocator()) {}
+
+        explicit small_vector_buffer(const Allocator& alloc) noexcept : mybase(alloc) {}
+
+        small_vector_buffer(const small_vector_buffer&) = delete;
+
+        small_vector_buffer(small_vector_buffer&& other) noexcept :
+            mybase(std::move(other.GetAllocator())),
+            m_data{ std::exchange(other.m_data, nullptr) },
+            m_capacity{ std::exchange(other.m_capacity, 0) } {}
+
+        ~small_vector_buffer() { release(); }
+
+        small_vector_buffer& operator=(const small_vector_buffer&) = delete;
+
+        // the allocators must be equal unless they propagate
+        small_vector_buffer& operator=(small_vector_buffer&& rhs) noexcept {
+            if (this != &rhs) {
+                release();
+                if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+                    this->GetAllocator() = std::move(rhs.GetAllocator());
+                else
+                    assert(this->GetAllocator() == rhs.GetAllocator());
+                m_data = std::exchange(rhs.m_data, nullptr);
+                m_capacity = std::exchange(rhs.m_capacity, 0);
+            }
+            return *this;
+        }
+
+        allocator_type get_allocator() const noexcept { return this->GetAllocator(); }
+
+        pointer data() const noexcept { return m_data; }
+
+        size_type capacity() const noexcept { return m_capacity; }
+
+        // relocate the first size elements into a new buffer of new_cap elements
+        void reallocate(size_type size, size_type new_cap) {
+            assert(size <= m_capacity && size <= new_cap);
+            pointer new_data = new_cap != 0 ? alloc_traits::allocate(this->GetAllocator(), new_cap) : nullptr;
+            try {
+                uninitialized_relocate(m_data, m_data + size, new_data);
+            }
+            catch (...) {
+                alloc_traits::deallocate(this->GetAllocator(), new_data, new_cap);
+                throw;
+            }
+            release();
+            m_data = new_data;
+            m_capacity = new_cap;
+        }
+
+        // the elements must be destroyed already
+        void release() noexcept {
+            if (m_data) {
+                alloc_traits::deallocate(this->GetAllocator(), m_data, m_capacity);
+                m_data = nullptr;
+                m_capacity = 0;
+            }
+        }
+
+    private:
+        pointer m_data{ nullptr };
+        size_type m_capacity{ 0 };
+    };
+
+    template<typename T>
+    struct is_small_vector_buffer : std::false_type {};
+
+    template<typename T, typename Allocator>
+    struct is_small_vector_buffer<small_vector_buffer<T, Allocator>> : std::true_type {};
+
+    template<typename T>
+    constexpr bool is_small_vector_buffer_v = is_small_vector_buffer<T>::value;
+
+    template<typename Allocator>
+    struct buffer_bind {
+        template<typename T>
+        using Ttype = small_vector_buffer<T, Allocator>;
+    };
+}
@@ -3,9 +3,9 @@
 #include "../static_vector.hpp"
 
 namespace Ubpa::details {
-    template<std::size_t N>
+    template<std::size_t N, typename Overflow = overflow_assert>
     struct static_vector_bind {
         template<typename T>
-        using Ttype = static_vector<T, N>;
+        using Ttype = static_vector<T, N, Overflow>;
     };
 }
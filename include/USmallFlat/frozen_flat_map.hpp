@@ -0,0 +1,186 @@
+#pragma once
+
+#include "basic_flat_map.hpp"
+#include "sorted_tags.hpp"
+#include "details/eytzinger_index.hpp"
+
+#include <vector>
+#include <stdexcept>
+
+namespace Ubpa {
+    // a lookup table built once: the key set is fixed, the mapped values stay writable
+    // iterates the sorted elements, searches an Eytzinger (BFS order) copy of the keys
+    template<typename Key, typename T, typename Compare = std::less<Key>>
+    class frozen_flat_map : private details::flat_base_multiset_base<Compare> {
+        using mybase = details::flat_base_multiset_base<Compare>;
+        using index_type = details::eytzinger_index<Key, Compare>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using container_type = std::vector<value_type>;
+        using size_type = typename container_type::size_type;
+        using difference_type = typename container_type::difference_type;
+        using key_compare = Compare;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using iterator = typename container_type::iterator;
+        using const_iterator = typename container_type::const_iterator;
+        using reverse_iterator = typename container_type::reverse_iterator;
+        using const_reverse_iterator = typename container_type::const_reverse_iterator;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        frozen_flat_map() : mybase(Compare()) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        frozen_flat_map(Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp) {
+            // value_type isn't assignable, sort aside
+            std::vector<std::pair<Key, T>> elems(first, last);
+            auto& cmp = this->GetCompare();
+            std::stable_sort(elems.begin(), elems.end(),
+                [&](const auto& lhs, const auto& rhs) { return cmp(lhs.first, rhs.first); });
+            elems.erase(std::unique(elems.begin(), elems.end(),
+                [&](const auto& lhs, const auto& rhs) { return !cmp(lhs.first, rhs.first); }), elems.end());
+            m_elems = container_type(std::make_move_iterator(elems.begin()), std::make_move_iterator(elems.end()));
+            m_index = index_type(m_elems.begin(), m_elems.end(), key_of);
+        }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        frozen_flat_map(sorted_unique_t, Iter first, Iter last, const Compare& comp = Compare()) :
+            mybase(comp), m_elems(first, last), m_index(m_elems.begin(), m_elems.end(), key_of)
+        {
+            assert(std::is_sorted(m_elems.begin(), m_elems.end(),
+                [&](const value_type& lhs, const value_type& rhs) { return this->GetCompare()(lhs.first, rhs.first); }));
+        }
+
+        frozen_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : frozen_flat_map(ilist.begin(), ilist.end(), comp) {}
+
+        frozen_flat_map(sorted_unique_t tag, std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : frozen_flat_map(tag, ilist.begin(), ilist.end(), comp) {}
+
+        //
+        // Iterators
+        //////////////
+
+        iterator begin() noexcept { return m_elems.begin(); }
+        const_iterator begin() const noexcept { return m_elems.begin(); }
+        const_iterator cbegin() const noexcept { return m_elems.cbegin(); }
+
+        iterator end() noexcept { return m_elems.end(); }
+        const_iterator end() const noexcept { return m_elems.end(); }
+        const_iterator cend() const noexcept { return m_elems.cend(); }
+
+        reverse_iterator rbegin() noexcept { return m_elems.rbegin(); }
+        const_reverse_iterator rbegin() const noexcept { return m_elems.rbegin(); }
+        const_reverse_iterator crbegin() const noexcept { return m_elems.crbegin(); }
+
+        reverse_iterator rend() noexcept { return m_elems.rend(); }
+        const_reverse_iterator rend() const noexcept { return m_elems.rend(); }
+        const_reverse_iterator crend() const noexcept { return m_elems.crend(); }
+
+        //
+        // Element access
+        ///////////////////
+
+        mapped_type& at(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                throw_out_of_range();
+            return target->second;
+        }
+
+        const mapped_type& at(const key_type& key) const { return const_cast<frozen_flat_map*>(this)->at(key); }
+
+        //
+        // Capacity
+        /////////////
+
+        bool empty() const noexcept { return m_elems.empty(); }
+
+        size_type size() const noexcept { return m_elems.size(); }
+
+        //
+        // Lookup
+        ///////////
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        iterator find(const key_type& key) { return begin() + m_index.find(key, this->GetCompare()); }
+        const_iterator find(const key_type& key) const { return begin() + m_index.find(key, this->GetCompare()); }
+
+        bool contains(const key_type& key) const { return m_index.contains(key, this->GetCompare()); }
+
+        std::pair<iterator, iterator> equal_range(const key_type& key) { return { lower_bound(key), upper_bound(key) }; }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return { lower_bound(key), upper_bound(key) }; }
+
+        iterator lower_bound(const key_type& key) { return begin() + m_index.lower_bound(key, this->GetCompare()); }
+        const_iterator lower_bound(const key_type& key) const { return begin() + m_index.lower_bound(key, this->GetCompare()); }
+
+        iterator upper_bound(const key_type& key) { return begin() + m_index.upper_bound(key, this->GetCompare()); }
+        const_iterator upper_bound(const key_type& key) const { return begin() + m_index.upper_bound(key, this->GetCompare()); }
+
+        // -- is_transparent
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        size_type count(const K& key) const { return static_cast<size_type>(contains(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        iterator find(const K& key) { return begin() + m_index.find(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator find(const K& key) const { return begin() + m_index.find(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        bool contains(const K& key) const { return m_index.contains(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator lower_bound(const K& key) const { return begin() + m_index.lower_bound(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator upper_bound(const K& key) const { return begin() + m_index.upper_bound(key, this->GetCompare()); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return this->GetCompare(); }
+
+    private:
+        [[noreturn]] void throw_out_of_range() const { throw std::out_of_range("invalid frozen_flat_map subscript"); }
+
+        static const Key& key_of(const value_type& elem) noexcept { return elem.first; }
+
+        container_type m_elems;
+        index_type m_index;
+    };
+
+    template<typename Key, typename T, typename Compare>
+    bool operator==(const frozen_flat_map<Key, T, Compare>& lhs, const frozen_flat_map<Key, T, Compare>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename Key, typename T, typename Compare>
+    bool operator!=(const frozen_flat_map<Key, T, Compare>& lhs, const frozen_flat_map<Key, T, Compare>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    // the key_comp() of a flat map compares elements, a stateful Compare is default constructed here
+    template<template<typename>class Vector, typename Key, typename T, typename Compare>
+    frozen_flat_map<Key, T, Compare> freeze(const basic_flat_map<Vector, Key, T, Compare>& m) {
+        return { sorted_unique, m.begin(), m.end() };
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "basic_flat_set.hpp"
+#include "sorted_tags.hpp"
+#include "details/eytzinger_index.hpp"
+
+#include <vector>
+
+namespace Ubpa {
+    // a read-only set for lookup tables built once:
+    // iterates the sorted keys, searches an Eytzinger (BFS order) copy of them
+    template<typename Key, typename Compare = std::less<Key>>
+    class frozen_flat_set : private details::flat_base_multiset_base<Compare> {
+        using mybase = details::flat_base_multiset_base<Compare>;
+        using index_type = details::eytzinger_index<Key, Compare>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using container_type = std::vector<Key>;
+        using key_type = Key;
+        using value_type = Key;
+        using size_type = typename container_type::size_type;
+        using difference_type = typename container_type::difference_type;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using reference = const Key&;
+        using const_reference = const Key&;
+        using pointer = const Key*;
+        using const_pointer = const Key*;
+        using iterator = typename container_type::const_iterator;
+        using const_iterator = typename container_type::const_iterator;
+        using reverse_iterator = typename container_type::const_reverse_iterator;
+        using const_reverse_iterator = typename container_type::const_reverse_iterator;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        frozen_flat_set() : mybase(Compare()) {}
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        frozen_flat_set(Iter first, Iter last, const Compare& comp = Compare()) : mybase(comp), m_keys(first, last) {
+            std::stable_sort(m_keys.begin(), m_keys.end(), this->GetCompare());
+            m_keys.erase(std::unique(m_keys.begin(), m_keys.end(),
+                [&](const Key& lhs, const Key& rhs) { return !this->GetCompare()(lhs, rhs); }), m_keys.end());
+            m_index = index_type(m_keys.begin(), m_keys.end());
+        }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        frozen_flat_set(sorted_unique_t, Iter first, Iter last, const Compare& comp = Compare()) :
+            mybase(comp), m_keys(first, last), m_index(m_keys.begin(), m_keys.end())
+        { assert(std::is_sorted(m_keys.begin(), m_keys.end(), this->GetCompare())); }
+
+        frozen_flat_set(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : frozen_flat_set(ilist.begin(), ilist.end(), comp) {}
+
+        frozen_flat_set(sorted_unique_t tag, std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : frozen_flat_set(tag, ilist.begin(), ilist.end(), comp) {}
+
+        //
+        // Iterators
+        //////////////
+
+        const_iterator begin() const noexcept { return m_keys.begin(); }
+        const_iterator cbegin() const noexcept { return m_keys.cbegin(); }
+
+        const_iterator end() const noexcept { return m_keys.end(); }
+        const_iterator cend() const noexcept { return m_keys.cend(); }
+
+        const_reverse_iterator rbegin() const noexcept { return m_keys.rbegin(); }
+        const_reverse_iterator crbegin() const noexcept { return m_keys.crbegin(); }
+
+        const_reverse_iterator rend() const noexcept { return m_keys.rend(); }
+        const_reverse_iterator crend() const noexcept { return m_keys.crend(); }
+
+        //
+        // Capacity
+        /////////////
+
+        bool empty() const noexcept { return m_keys.empty(); }
+
+        size_type size() const noexcept { return m_keys.size(); }
+
+        //
+        // Lookup
+        ///////////
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        const_iterator find(const key_type& key) const { return begin() + m_index.find(key, this->GetCompare()); }
+
+        bool contains(const key_type& key) const { return m_index.contains(key, this->GetCompare()); }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return { lower_bound(key), upper_bound(key) }; }
+
+        const_iterator lower_bound(const key_type& key) const { return begin() + m_index.lower_bound(key, this->GetCompare()); }
+
+        const_iterator upper_bound(const key_type& key) const { return begin() + m_index.upper_bound(key, this->GetCompare()); }
+
+        // -- is_transparent
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        size_type count(const K& key) const { return static_cast<size_type>(contains(key)); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator find(const K& key) const { return begin() + m_index.find(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        bool contains(const K& key) const { return m_index.contains(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        std::pair<const_iterator, const_iterator> equal_range(const K& key) const { return { lower_bound(key), upper_bound(key) }; }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator lower_bound(const K& key) const { return begin() + m_index.lower_bound(key, this->GetCompare()); }
+
+        template<typename K,
+            typename Comp_ = Compare, typename = std::enable_if_t<std::is_same_v<Comp_, Compare>, typename Comp_::is_transparent>>
+        const_iterator upper_bound(const K& key) const { return begin() + m_index.upper_bound(key, this->GetCompare()); }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return this->GetCompare(); }
+        value_compare value_comp() const { return this->GetCompare(); }
+
+    private:
+        container_type m_keys;
+        index_type m_index;
+    };
+
+    template<typename Key, typename Compare>
+    bool operator==(const frozen_flat_set<Key, Compare>& lhs, const frozen_flat_set<Key, Compare>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename Key, typename Compare>
+    bool operator!=(const frozen_flat_set<Key, Compare>& lhs, const frozen_flat_set<Key, Compare>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<template<typename>class Vector, typename Key, typename Compare>
+    frozen_flat_set<Key, Compare> freeze(const basic_flat_set<Vector, Key, Compare>& s) {
+        return { sorted_unique, s.begin(), s.end(), s.key_comp() };
+    }
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "details/perfect_hash_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace Ubpa {
+    // the constexpr 64-bit hash of frozen_perfect_map, equal keys must hash equal and
+    // distinct keys of a map must not (the construction throws on a full collision)
+    template<typename Key>
+    struct frozen_perfect_hash;
+
+    // the perfect hash mixes the value
+    template<typename Key> requires std::is_integral_v<Key> || std::is_enum_v<Key>
+    struct frozen_perfect_hash<Key> {
+        constexpr std::uint64_t operator()(Key key) const noexcept { return static_cast<std::uint64_t>(key); }
+    };
+
+    // 8 characters at a time, lookups accept anything convertible to std::string_view
+    template<>
+    struct frozen_perfect_hash<std::string_view> {
+        using is_transparent = void;
+
+        constexpr std::uint64_t operator()(std::string_view key) const noexcept {
+            std::uint64_t hash = 0xCBF29CE484222325ull ^ key.size();
+            std::size_t i = 0;
+            for (; i + 8 <= key.size(); i += 8)
+                hash = combine(hash, load(key, i, 8));
+            if (i < key.size())
+                hash = combine(hash, load(key, i, key.size() - i));
+            return hash;
+        }
+
+    private:
+        // little endian, the compilers merge it into a single load
+        static constexpr std::uint64_t load(std::string_view key, std::size_t pos, std::size_t n) noexcept {
+            std::uint64_t word = 0;
+            for (std::size_t k = 0; k < n; k++)
+                word |= static_cast<std::uint64_t>(static_cast<unsigned char>(key[pos + k])) << (8 * k);
+            return word;
+        }
+
+        static constexpr std::uint64_t combine(std::uint64_t hash, std::uint64_t word) noexcept {
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            return hash ^ (hash >> 32);
+        }
+    };
+
+    // a lookup table with N keys fixed at construction (usually at compile time, see make_frozen_perfect_map)
+    // a minimal perfect hash (details::perfect_hash_index) maps each key to its own slot,
+    // so a lookup is one hash of the key and a single key comparison, without probing
+    // the elements are stored by slot (unspecified order), the mapped values of a non-const map stay writable
+    template<typename Key, typename T, std::size_t N, typename Hash = frozen_perfect_hash<Key>, typename KeyEqual = std::equal_to<>>
+    class frozen_perfect_map {
+        using index_type = details::perfect_hash_index<N>;
+        using container_type = std::array<std::pair<const Key, T>, N>;
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using iterator = typename container_type::iterator;
+        using const_iterator = typename container_type::const_iterator;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        // throws std::invalid_argument on a duplicate key or a hash collision (a compile error in a constant expression)
+        constexpr explicit frozen_perfect_map(const std::pair<Key, T>(&elems)[N], const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : frozen_perfect_map(elems, hash, equal, build(elems, hash, equal), std::make_index_sequence<N>{}) {}
+
+        //
+        // Element access
+        ///////////////////
+
+        constexpr mapped_type& at(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                throw_out_of_range();
+            return target->second;
+        }
+
+        constexpr const mapped_type& at(const key_type& key) const {
+            auto target = find(key);
+            if (target == end())
+                throw_out_of_range();
+            return target->second;
+        }
+
+        //
+        // Iterators
+        //////////////
+
+        constexpr iterator begin() noexcept { return m_elems.begin(); }
+        constexpr const_iterator begin() const noexcept { return m_elems.begin(); }
+        constexpr const_iterator cbegin() const noexcept { return m_elems.cbegin(); }
+
+        constexpr iterator end() noexcept { return m_elems.end(); }
+        constexpr const_iterator end() const noexcept { return m_elems.end(); }
+        constexpr const_iterator cend() const noexcept { return m_elems.cend(); }
+
+        //
+        // Capacity
+        /////////////
+
+        [[nodiscard]] constexpr bool empty() const noexcept { return false; }
+
+        constexpr size_type size() const noexcept { return N; }
+
+        constexpr size_type max_size() const noexcept { return N; }
+
+        //
+        // Lookup
+        ///////////
+
+        constexpr size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        constexpr iterator find(const key_type& key) { return begin() + find_slot(key); }
+        constexpr const_iterator find(const key_type& key) const { return begin() + find_slot(key); }
+
+        constexpr bool contains(const key_type& key) const { return find_slot(key) != N; }
+
+        constexpr std::pair<iterator, iterator> equal_range(const key_type& key) { return equal_range_impl(*this, key); }
+        constexpr std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return equal_range_impl(*this, key); }
+
+        // -- is_transparent (Hash and KeyEqual)
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        constexpr size_type count(const K& x) const { return static_cast<size_type>(contains(x)); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        constexpr iterator find(const K& x) { return begin() + find_slot(x); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        constexpr const_iterator find(const K& x) const { return begin() + find_slot(x); }
+
+        template<typename K, typename H_ = Hash, typename E_ = KeyEqual, typename = std::enable_if_t<std::is_same_v<H_, Hash> && std::is_same_v<E_, KeyEqual>,
+            std::void_t<typename H_::is_transparent, typename E_::is_transparent>>>
+        constexpr bool contains(const K& x) const { return find_slot(x) != N; }
+
+        //
+        // Observers
+        //////////////
+
+        constexpr hasher hash_function() const { return m_hash; }
+
+        constexpr key_equal key_eq() const { return m_equal; }
+
+    private:
+        struct build_result {
+            index_type index;
+            std::array<size_type, N> sources; // the element of each slot
+        };
+
+        template<std::size_t... Slots>
+        constexpr frozen_perfect_map(const std::pair<Key, T>(&elems)[N], const Hash& hash, const KeyEqual& equal,
+            const build_result& result, std::index_sequence<Slots...>) :
+            m_index(result.index),
+            m_elems{ value_type(elems[result.sources[Slots]])... },
+            m_hash(hash),
+            m_equal(equal) {}
+
+        static constexpr build_result build(const std::pair<Key, T>(&elems)[N], const Hash& hash, const KeyEqual& equal) {
+            std::array<std::uint64_t, N> hashes{};
+            for (size_type i = 0; i < N; i++)
+                hashes[i] = static_cast<std::uint64_t>(hash(elems[i].first));
+
+            // equal hashes can't be told apart
+            std::array<size_type, N> by_hash{};
+            for (size_type i = 0; i < N; i++)
+                by_hash[i] = i;
+            std::sort(by_hash.begin(), by_hash.end(), [&](size_type lhs, size_type rhs) { return hashes[lhs] < hashes[rhs]; });
+            for (size_type i = 1; i < N; i++) {
+                if (hashes[by_hash[i - 1]] == hashes[by_hash[i]]) {
+                    if (equal(elems[by_hash[i - 1]].first, elems[by_hash[i]].first))
+                        throw std::invalid_argument("frozen_perfect_map: duplicate key");
+                    throw std::invalid_argument("frozen_perfect_map: hash collision");
+                }
+            }
+
+            build_result result{ index_type(hashes), {} };
+            for (size_type i = 0; i < N; i++)
+                result.sources[result.index.slot(hashes[i])] = i;
+            return result;
+        }
+
+        // N if not found
+        template<typename K>
+        constexpr size_type find_slot(const K& key) const {
+            const size_type slot = m_index.slot(static_cast<std::uint64_t>(m_hash(key)));
+            return m_equal(m_elems[slot].first, key) ? slot : N;
+        }
+
+        template<typename Self>
+        static constexpr auto equal_range_impl(Self& self, const key_type& key) {
+            auto target = self.find(key);
+            return std::pair{ target, target == self.end() ? target : std::next(target) };
+        }
+
+        [[noreturn]] static void throw_out_of_range() { throw std::out_of_range("invalid frozen_perfect_map subscript"); }
+
+        index_type m_index;
+        container_type m_elems;
+        [[no_unique_address]] Hash m_hash;
+        [[no_unique_address]] KeyEqual m_equal;
+    };
+
+    template<typename Key, typename T, std::size_t N, typename Hash, typename KeyEqual>
+    constexpr bool operator==(const frozen_perfect_map<Key, T, N, Hash, KeyEqual>& lhs, const frozen_perfect_map<Key, T, N, Hash, KeyEqual>& rhs) {
+        return std::all_of(lhs.begin(), lhs.end(), [&](const auto& elem) {
+            auto target = rhs.find(elem.first);
+            return target != rhs.end() && target->second == elem.second;
+        });
+    }
+
+    template<typename Key, typename T, std::size_t N, typename Hash, typename KeyEqual>
+    constexpr bool operator!=(const frozen_perfect_map<Key, T, N, Hash, KeyEqual>& lhs, const frozen_perfect_map<Key, T, N, Hash, KeyEqual>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    // the perfect hash is searched at compile time, a duplicate key doesn't compile, e.g.
+    //   constexpr auto table = make_frozen_perfect_map<std::string_view, int>({ {"b", 2}, {"a", 1} });
+    // a constexpr result is constant-initialized, and its lookups are usable in constant expressions too
+    template<typename Key, typename T, typename Hash = frozen_perfect_hash<Key>, typename KeyEqual = std::equal_to<>, std::size_t N>
+    consteval frozen_perfect_map<Key, T, N, Hash, KeyEqual> make_frozen_perfect_map(const std::pair<Key, T>(&elems)[N],
+        const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+    {
+        return frozen_perfect_map<Key, T, N, Hash, KeyEqual>(elems, hash, equal);
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "basic_gapped_flat_set.hpp"
+
+#include "details/vector_bind.hpp"
+
+namespace Ubpa {
+    template<typename Key, typename Compare = std::less<Key>, template<typename>class TAllocator = std::allocator>
+    class gapped_flat_set : public basic_gapped_flat_set<details::Tvector_bind<TAllocator>::template Ttype, Key, Compare> {
+        using mybase = basic_gapped_flat_set<details::Tvector_bind<TAllocator>::template Ttype, Key, Compare>;
+    public:
+        using mybase::mybase;
+
+        gapped_flat_set(std::initializer_list<Key> ilist, const Compare& comp = Compare())
+            : mybase(ilist, comp) {}
+    };
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <type_traits>
+#include <memory>
+#include <utility>
+
+namespace Ubpa {
+    // T is trivially relocatable if moving an object to a new address and destroying the
+    // source is equivalent to copying its bytes (no self-pointers, no registration by address)
+    // - trivially copyable types are trivially relocatable
+    // - specialize it to opt in other types
+    template<typename T>
+    struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+    template<typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    template<typename T>
+    struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> {};
+
+    template<typename T>
+    struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+    template<typename T1, typename T2>
+    struct is_trivially_relocatable<std::pair<T1, T2>>
+        : std::bool_constant<is_trivially_relocatable_v<T1> && is_trivially_relocatable_v<T2>> {};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Ubpa {
+    // what a fixed-capacity container does with an element that doesn't fit
+    // - static_vector: overflow_assert, overflow_throw
+    // - static_flat_set / static_flat_map: all of them
+    // - least recently used: static_lru_map
+
+    // assert(size() < max_size()), undefined behavior in release builds
+    struct overflow_assert {};
+
+    // throws std::length_error, the container is unchanged
+    struct overflow_throw {};
+
+    // insert returns { end(), false }, try_* functions return false
+    struct overflow_reject {};
+
+    // erases the element with the smallest key
+    struct overflow_evict_smallest {};
+
+    // erases the element with the largest key
+    struct overflow_evict_largest {};
+
+    // erases a pseudo-random element (xorshift)
+    struct overflow_evict_random {
+        std::uint32_t state = 0x9E3779B9u;
+
+        // in [0, n)
+        std::size_t operator()(std::size_t n) noexcept {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return static_cast<std::size_t>(state) % n;
+        }
+    };
+
+    template<typename Overflow>
+    inline constexpr bool is_overflow_evict_v =
+        std::is_same_v<Overflow, overflow_evict_smallest>
+        || std::is_same_v<Overflow, overflow_evict_largest>
+        || std::is_same_v<Overflow, overflow_evict_random>;
+}
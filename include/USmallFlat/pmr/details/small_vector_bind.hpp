@@ -7,5 +7,5 @@ namespace Ubpa::pmr::details {
     struct small_vector_bind {
         template<typename T>
         using Ttype = Ubpa::pmr::small_vector<T, N>;
-    }
+    };
 }
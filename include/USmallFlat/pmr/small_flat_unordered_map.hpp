@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../basic_flat_unordered_map.hpp"
+
+#include "details/small_vector_bind.hpp"
+
+namespace Ubpa::pmr {
+    template<typename Key, typename T, std::size_t N = 16, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class small_flat_unordered_map : public basic_flat_unordered_map<details::small_vector_bind<N>::template Ttype,
+        details::small_vector_bind<Ubpa::details::flat_unordered_table_capacity(N)>::template Ttype, Key, T, Hash, KeyEqual>
+    {
+        using mybase = basic_flat_unordered_map<details::small_vector_bind<N>::template Ttype,
+            details::small_vector_bind<Ubpa::details::flat_unordered_table_capacity(N)>::template Ttype, Key, T, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        small_flat_unordered_map(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : mybase(ilist, hash, equal) {}
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../basic_flat_unordered_set.hpp"
+
+#include "details/small_vector_bind.hpp"
+
+namespace Ubpa::pmr {
+    template<typename Key, std::size_t N = 16, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class small_flat_unordered_set : public basic_flat_unordered_set<details::small_vector_bind<N>::template Ttype,
+        details::small_vector_bind<Ubpa::details::flat_unordered_table_capacity(N)>::template Ttype, Key, Hash, KeyEqual>
+    {
+        using mybase = basic_flat_unordered_set<details::small_vector_bind<N>::template Ttype,
+            details::small_vector_bind<Ubpa::details::flat_unordered_table_capacity(N)>::template Ttype, Key, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        small_flat_unordered_set(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : mybase(ilist, hash, equal) {}
+    };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "../basic_small_unsorted_flat_map.hpp"
+
+#include "details/small_vector_bind.hpp"
+
+namespace Ubpa::pmr {
+    template<typename Key, typename T, std::size_t N = 8, typename Compare = std::less<Key>>
+    class small_unsorted_flat_map : public basic_small_unsorted_flat_map<details::small_vector_bind<N>::template Ttype, Key, T, Compare, N> {
+        using mybase = basic_small_unsorted_flat_map<details::small_vector_bind<N>::template Ttype, Key, T, Compare, N>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        small_unsorted_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : mybase(ilist, comp) {}
+    };
+}
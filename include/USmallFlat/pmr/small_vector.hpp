@@ -3,11 +3,12 @@
 #include "../basic_small_vector.hpp"
 
 #include <vector>
+#include <memory_resource>
 
 namespace Ubpa::pmr {
-    template<typename T, std::size_t N = 16>
-    class small_vector : public basic_small_vector<std::pmr::vector, T, N> {
-        using mybase = basic_small_vector<std::pmr::vector, T, N>;
+    template<typename T, std::size_t N = 16, typename DemotePolicy = demote_eager, typename GrowthPolicy = grow_native>
+    class small_vector : public basic_small_vector<std::pmr::vector, T, N, DemotePolicy, GrowthPolicy> {
+        using mybase = basic_small_vector<std::pmr::vector, T, N, DemotePolicy, GrowthPolicy>;
     public:
         using mybase::mybase;
         small_vector(std::initializer_list<T> ilist) : mybase(ilist) {}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "basic_flat_unordered_map.hpp"
+
+#include "details/small_vector_bind.hpp"
+
+namespace Ubpa {
+    // the elements and the table stay inline up to N elements
+    template<typename Key, typename T, std::size_t N = 16, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, template<typename>class TAllocator = std::allocator>
+    class small_flat_unordered_map : public basic_flat_unordered_map<details::Tsmall_vector_bind<N, TAllocator>::template Ttype,
+        details::Tsmall_vector_bind<details::flat_unordered_table_capacity(N), TAllocator>::template Ttype, Key, T, Hash, KeyEqual>
+    {
+        using mybase = basic_flat_unordered_map<details::Tsmall_vector_bind<N, TAllocator>::template Ttype,
+            details::Tsmall_vector_bind<details::flat_unordered_table_capacity(N), TAllocator>::template Ttype, Key, T, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        small_flat_unordered_map(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : mybase(ilist, hash, equal) {}
+    };
+}
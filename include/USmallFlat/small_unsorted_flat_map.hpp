@@ -0,0 +1,19 @@
+#pragma once
+
+#include "basic_small_unsorted_flat_map.hpp"
+
+#include "details/small_vector_bind.hpp"
+
+namespace Ubpa {
+    // unsorted while the elements are inline, sorted once when they spill to the heap
+    template<typename Key, typename T, std::size_t N = 8, typename Compare = std::less<Key>, template<typename>class TAllocator = std::allocator>
+    class small_unsorted_flat_map : public basic_small_unsorted_flat_map<details::Tsmall_vector_bind<N, TAllocator>::template Ttype, Key, T, Compare, N> {
+        using mybase = basic_small_unsorted_flat_map<details::Tsmall_vector_bind<N, TAllocator>::template Ttype, Key, T, Compare, N>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        small_unsorted_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : mybase(ilist, comp) {}
+    };
+}
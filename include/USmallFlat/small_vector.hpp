@@ -2,14 +2,25 @@
 
 #include "basic_small_vector.hpp"
 
-#include "details/vector_bind.hpp"
+#include <iterator>
+#include <vector>
 
 namespace Ubpa {
-    template<typename T, std::size_t N = 16, typename Allocator = std::allocator<T>>
-    class small_vector : public basic_small_vector<details::vector_bind<Allocator>::template Ttype, T, N> {
-        using mybase = basic_small_vector<details::vector_bind<Allocator>::template Ttype, T, N>;
+    // the heap part is a raw Allocator-owned buffer, see details::small_vector_buffer
+    template<typename T, std::size_t N = 16, typename Allocator = std::allocator<T>,
+        typename DemotePolicy = demote_eager, typename GrowthPolicy = grow_native>
+    class small_vector : public basic_small_vector<details::buffer_bind<Allocator>::template Ttype, T, N, DemotePolicy, GrowthPolicy> {
+        using mybase = basic_small_vector<details::buffer_bind<Allocator>::template Ttype, T, N, DemotePolicy, GrowthPolicy>;
     public:
         using mybase::mybase;
         small_vector(std::initializer_list<T> ilist) : mybase(ilist) {}
+        small_vector(const std::vector<T, Allocator>& storage) : mybase(storage.begin(), storage.end()) {}
+
+        // the buffer of storage can't be adopted, its elements are moved (one allocation above N), storage is left empty
+        small_vector(std::vector<T, Allocator>&& storage) :
+            mybase(std::make_move_iterator(storage.begin()), std::make_move_iterator(storage.end()))
+        {
+            storage.clear();
+        }
     };
 }
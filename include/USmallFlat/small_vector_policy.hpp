@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <bit>
+#include <algorithm>
+
+namespace Ubpa {
+    //
+    // Demotion policies
+    //////////////////////
+    // decide when a heap-mode basic_small_vector moves its elements back to the inline buffer
+    // - demote(size, N): checked after the vector shrinks to size elements (erase, pop_back, resize)
+    // - demote_on_shrink_to_fit: whether shrink_to_fit() moves a vector with size <= N back
+
+    // moves back as soon as the elements fit
+    struct demote_eager {
+        static constexpr bool demote(std::size_t size, std::size_t N) noexcept { return size <= N; }
+        static constexpr bool demote_on_shrink_to_fit = true;
+    };
+
+    // moves back once half of the inline buffer is free,
+    // so a size oscillating around N stays on the heap
+    struct demote_half {
+        static constexpr bool demote(std::size_t size, std::size_t N) noexcept { return size <= N / 2; }
+        static constexpr bool demote_on_shrink_to_fit = true;
+    };
+
+    // only shrink_to_fit() moves back
+    struct demote_on_shrink {
+        static constexpr bool demote(std::size_t, std::size_t) noexcept { return false; }
+        static constexpr bool demote_on_shrink_to_fit = true;
+    };
+
+    // stays on the heap until clear() or assignment
+    struct demote_never {
+        static constexpr bool demote(std::size_t, std::size_t) noexcept { return false; }
+        static constexpr bool demote_on_shrink_to_fit = false;
+    };
+
+    //
+    // Growth policies
+    ////////////////////
+    // decide the heap capacity of basic_small_vector when the elements don't fit
+    // - grow(capacity, required, N): capacity is the current capacity() (N while inline),
+    //   returns the new capacity (>= required)
+
+    // leaves the growth to the heap Vector (e.g. std::vector)
+    struct grow_native {};
+
+    // multiplies the capacity by Num / Den
+    template<std::size_t Num = 2, std::size_t Den = 1>
+    struct grow_geometric {
+        static_assert(Num > Den && Den > 0);
+        static constexpr std::size_t grow(std::size_t capacity, std::size_t required, std::size_t) noexcept {
+            return std::max(required, capacity / Den * Num + capacity % Den * Num / Den);
+        }
+    };
+
+    // rounds up to a power of two, lining up with size-class allocators
+    struct grow_power_of_two {
+        static constexpr std::size_t grow(std::size_t, std::size_t required, std::size_t) noexcept {
+            return std::bit_ceil(required);
+        }
+    };
+
+    // the first heap allocation is exactly required, later ones grow by Num / Den
+    template<std::size_t Num = 3, std::size_t Den = 2>
+    struct grow_exact_then_geometric {
+        static constexpr std::size_t grow(std::size_t capacity, std::size_t required, std::size_t N) noexcept {
+            return capacity <= N ? required : grow_geometric<Num, Den>::grow(capacity, required, N);
+        }
+    };
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace Ubpa {
+    // the range is sorted and has no equivalent elements, for flat sets and maps
+    struct sorted_unique_t { explicit sorted_unique_t() = default; };
+    inline constexpr sorted_unique_t sorted_unique{};
+
+    // the range is sorted, for flat multisets and multimaps
+    struct sorted_equivalent_t { explicit sorted_equivalent_t() = default; };
+    inline constexpr sorted_equivalent_t sorted_equivalent{};
+}
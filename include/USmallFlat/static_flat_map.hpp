@@ -2,12 +2,16 @@
 
 #include "basic_flat_map.hpp"
 
+#include "details/bounded_flat.hpp"
 #include "details/static_vector_bind.hpp"
 
+#include <stdexcept>
+
 namespace Ubpa {
-    template<typename Key, typename T, std::size_t N = 16, typename Compare = std::less<Key>>
-    class static_flat_map : public basic_flat_map<details::static_vector_bind<N>::template Ttype, Key, T, Compare> {
-        using mybase = basic_flat_map<details::static_vector_bind<N>::template Ttype, Key, T, Compare>;
+    // Overflow: see overflow_policy.hpp
+    template<typename Key, typename T, std::size_t N = 16, typename Compare = std::less<Key>, typename Overflow = overflow_assert>
+    class static_flat_map : public details::bounded_flat_map_t<basic_flat_map<details::static_vector_bind<N, details::bounded_storage_overflow_t<Overflow>>::template Ttype, Key, T, Compare>, Compare, N, Overflow> {
+        using mybase = details::bounded_flat_map_t<basic_flat_map<details::static_vector_bind<N, details::bounded_storage_overflow_t<Overflow>>::template Ttype, Key, T, Compare>, Compare, N, Overflow>;
     public:
         using mybase::mybase;
         using typename mybase::value_type;
@@ -15,4 +19,18 @@ namespace Ubpa {
         static_flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
             : mybase(ilist, comp) {}
     };
+
+    // sorted at compile time, a duplicate key doesn't compile, e.g.
+    //   constexpr auto table = make_static_flat_map<std::string_view, int>({ {"b", 2}, {"a", 1} });
+    // a constexpr result is constant-initialized (no startup cost), its lookups run at runtime
+    // (the iterators see the stored std::pair<Key, T> as std::pair<const Key, T>)
+    template<typename Key, typename T, typename Compare = std::less<Key>, std::size_t N>
+    consteval static_flat_map<Key, T, N, Compare> make_static_flat_map(const std::pair<Key, T>(&elems)[N], const Compare& comp = Compare()) {
+        auto key_less = [&](const std::pair<Key, T>& lhs, const std::pair<Key, T>& rhs) { return comp(lhs.first, rhs.first); };
+        static_vector<std::pair<Key, T>, N> storage(std::begin(elems), std::end(elems));
+        std::sort(storage.begin(), storage.end(), key_less);
+        if (std::adjacent_find(storage.begin(), storage.end(), [&](const auto& lhs, const auto& rhs) { return !key_less(lhs, rhs); }) != storage.end())
+            throw std::invalid_argument("make_static_flat_map: duplicate key");
+        return static_flat_map<Key, T, N, Compare>(sorted_unique, std::move(storage), comp);
+    }
 }
@@ -2,12 +2,16 @@
 
 #include "basic_flat_set.hpp"
 
+#include "details/bounded_flat.hpp"
 #include "details/static_vector_bind.hpp"
 
+#include <stdexcept>
+
 namespace Ubpa {
-    template<typename Key, std::size_t N = 16, typename Compare = std::less<Key>>
-    class static_flat_set : public basic_flat_set<details::static_vector_bind<N>::template Ttype, Key, Compare> {
-        using mybase = basic_flat_set<details::static_vector_bind<N>::template Ttype, Key, Compare>;
+    // Overflow: see overflow_policy.hpp
+    template<typename Key, std::size_t N = 16, typename Compare = std::less<Key>, typename Overflow = overflow_assert>
+    class static_flat_set : public details::bounded_flat_set_t<basic_flat_set<details::static_vector_bind<N, details::bounded_storage_overflow_t<Overflow>>::template Ttype, Key, Compare>, Compare, N, Overflow> {
+        using mybase = details::bounded_flat_set_t<basic_flat_set<details::static_vector_bind<N, details::bounded_storage_overflow_t<Overflow>>::template Ttype, Key, Compare>, Compare, N, Overflow>;
     public:
         using mybase::mybase;
         using typename mybase::value_type;
@@ -15,4 +19,16 @@ namespace Ubpa {
         static_flat_set(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
             : mybase(ilist, comp) {}
     };
+
+    // sorted at compile time, a duplicate key doesn't compile, e.g.
+    //   constexpr auto primes = make_static_flat_set({ 7, 2, 5, 3 });
+    //   static_assert(primes.contains(5));
+    template<typename Key, typename Compare = std::less<Key>, std::size_t N>
+    consteval static_flat_set<Key, N, Compare> make_static_flat_set(const Key(&keys)[N], const Compare& comp = Compare()) {
+        static_vector<Key, N> storage(std::begin(keys), std::end(keys));
+        std::sort(storage.begin(), storage.end(), comp);
+        if (std::adjacent_find(storage.begin(), storage.end(), [&](const Key& lhs, const Key& rhs) { return !comp(lhs, rhs); }) != storage.end())
+            throw std::invalid_argument("make_static_flat_set: duplicate key");
+        return static_flat_set<Key, N, Compare>(sorted_unique, std::move(storage), comp);
+    }
 }
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "basic_flat_unordered_set.hpp"
+
+#include "details/static_vector_bind.hpp"
+
+namespace Ubpa {
+    // at most N elements
+    template<typename Key, std::size_t N = 16, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class static_flat_unordered_set : public basic_flat_unordered_set<details::static_vector_bind<N>::template Ttype,
+        details::static_vector_bind<details::flat_unordered_table_capacity(N)>::template Ttype, Key, Hash, KeyEqual>
+    {
+        using mybase = basic_flat_unordered_set<details::static_vector_bind<N>::template Ttype,
+            details::static_vector_bind<details::flat_unordered_table_capacity(N)>::template Ttype, Key, Hash, KeyEqual>;
+    public:
+        using mybase::mybase;
+        using typename mybase::value_type;
+
+        static_flat_unordered_set(std::initializer_list<value_type> ilist, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : mybase(ilist, hash, equal) {}
+    };
+}
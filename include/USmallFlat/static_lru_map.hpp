@@ -0,0 +1,329 @@
+#pragma once
+
+#include "static_vector.hpp"
+#include "details/flat_base_multimap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace Ubpa {
+    // a fixed-capacity map evicting the least recently used element, no heap allocation
+    // - elements: static_vector of N slots, unordered
+    // - recency: an intrusive doubly linked list of slot indices (parallel prev / next arrays)
+    // - lookup: slot indices sorted by key, binary search
+    // non-const find / at / operator[] / try_emplace / insert_or_assign touch the element (most recent),
+    // const find / contains / count don't
+    template<typename Key, typename T, std::size_t N = 16, typename Compare = std::less<Key>>
+    class static_lru_map : private details::flat_base_multimap_comp_storage<Compare> {
+        static_assert(N > 0);
+        using comp_storage = details::flat_base_multimap_comp_storage<Compare>;
+        using slot_type = std::pair<Key, T>;
+        using index_type = details::static_vector_size_type<N>;
+        static constexpr index_type npos = static_cast<index_type>(N);
+    public:
+        //////////////////
+        // Member types //
+        //////////////////
+
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+
+        //////////////////////
+        // Member functions //
+        //////////////////////
+
+        static_lru_map() : comp_storage(Compare()) {}
+
+        explicit static_lru_map(const Compare& comp) : comp_storage(comp) {}
+
+        // the elements are inserted in order, the last one is the most recent
+        template<typename Iter> requires std::input_iterator<Iter>
+        static_lru_map(Iter first, Iter last, const Compare& comp = Compare()) : comp_storage(comp) { insert(first, last); }
+
+        static_lru_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+            : static_lru_map(ilist.begin(), ilist.end(), comp) {}
+
+        static_lru_map(const static_lru_map&) = default;
+
+        static_lru_map(static_lru_map&& other) noexcept :
+            comp_storage(static_cast<comp_storage&&>(other)),
+            m_elems(std::move(other.m_elems)),
+            m_order(std::move(other.m_order)),
+            m_prev(other.m_prev),
+            m_next(other.m_next),
+            m_head(other.m_head),
+            m_tail(other.m_tail)
+        {
+            other.clear();
+        }
+
+        static_lru_map& operator=(const static_lru_map&) = default;
+
+        static_lru_map& operator=(static_lru_map&& rhs) noexcept {
+            static_cast<comp_storage&>(*this) = static_cast<comp_storage&&>(rhs);
+            m_elems = std::move(rhs.m_elems);
+            m_order = std::move(rhs.m_order);
+            m_prev = rhs.m_prev;
+            m_next = rhs.m_next;
+            m_head = rhs.m_head;
+            m_tail = rhs.m_tail;
+            rhs.clear();
+            return *this;
+        }
+
+        //
+        // Element access
+        ///////////////////
+
+        mapped_type& at(const key_type& key) {
+            auto target = find(key);
+            if (target == end())
+                throw std::out_of_range("invalid static_lru_map subscript");
+            return target->second;
+        }
+
+        // doesn't touch
+        const mapped_type& at(const key_type& key) const {
+            auto target = find(key);
+            if (target == end())
+                throw std::out_of_range("invalid static_lru_map subscript");
+            return target->second;
+        }
+
+        mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+        mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+        //
+        // Iterators
+        //////////////
+        // unspecified order, see most_recent() / least_recent() / next_recent() for the recency order
+
+        iterator begin() noexcept { return reinterpret_cast<iterator>(m_elems.data()); }
+        const_iterator begin() const noexcept { return reinterpret_cast<const_iterator>(m_elems.data()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return begin() + m_elems.size(); }
+        const_iterator end() const noexcept { return begin() + m_elems.size(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        // end() if empty
+        iterator most_recent() noexcept { return at_index(m_head); }
+        const_iterator most_recent() const noexcept { return const_cast<static_lru_map*>(this)->most_recent(); }
+
+        // the next to be evicted, end() if empty
+        iterator least_recent() noexcept { return at_index(m_tail); }
+        const_iterator least_recent() const noexcept { return const_cast<static_lru_map*>(this)->least_recent(); }
+
+        // the element used just before pos, end() after least_recent()
+        iterator next_recent(const_iterator pos) noexcept { return at_index(m_next[index_of(pos)]); }
+        const_iterator next_recent(const_iterator pos) const noexcept { return const_cast<static_lru_map*>(this)->next_recent(pos); }
+
+        //
+        // Capacity
+        /////////////
+
+        [[nodiscard]] bool empty() const noexcept { return m_elems.empty(); }
+
+        [[nodiscard]] bool full() const noexcept { return m_elems.size() == N; }
+
+        size_type size() const noexcept { return m_elems.size(); }
+
+        static constexpr size_type max_size() noexcept { return N; }
+
+        //
+        // Modifiers
+        //////////////
+
+        void clear() noexcept {
+            m_elems.clear();
+            m_order.clear();
+            m_head = npos;
+            m_tail = npos;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(value.first, std::move(value.second)); }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            slot_type value(std::forward<Args>(args)...);
+            return insert_unique(value.first, [&]() -> slot_type&& { return std::move(value); });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args) { return try_emplace_impl(k, std::forward<Args>(args)...); }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args) { return try_emplace_impl(std::move(k), std::forward<Args>(args)...); }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const key_type& k, M&& m) { return insert_or_assign_impl(k, std::forward<M>(m)); }
+
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(key_type&& k, M&& m) { return insert_or_assign_impl(std::move(k), std::forward<M>(m)); }
+
+        // the last element is moved to pos, returns pos (or end())
+        iterator erase(const_iterator pos) {
+            const index_type index = index_of(pos);
+            m_order.erase(order_lower_bound(m_elems[index].first));
+            unlink(index);
+            const index_type last = static_cast<index_type>(m_elems.size() - 1);
+            if (index != last) {
+                m_elems[index] = std::move(m_elems[last]);
+                // the links and the order entry of last now refer to index
+                m_prev[index] = m_prev[last];
+                m_next[index] = m_next[last];
+                (m_prev[index] != npos ? m_next[m_prev[index]] : m_head) = index;
+                (m_next[index] != npos ? m_prev[m_next[index]] : m_tail) = index;
+                *order_lower_bound(m_elems[index].first) = index;
+            }
+            m_elems.pop_back();
+            return begin() + index;
+        }
+
+        size_type erase(const key_type& key) {
+            const index_type index = find_index(key);
+            if (index == npos)
+                return 0;
+            erase(begin() + index);
+            return 1;
+        }
+
+        //
+        // Lookup
+        ///////////
+
+        // touches the element
+        iterator find(const key_type& key) {
+            const index_type index = find_index(key);
+            if (index == npos)
+                return end();
+            touch(index);
+            return begin() + index;
+        }
+
+        // doesn't touch the element
+        const_iterator find(const key_type& key) const { return at_index(find_index(key)); }
+
+        size_type count(const key_type& key) const { return static_cast<size_type>(contains(key)); }
+
+        bool contains(const key_type& key) const { return find_index(key) != npos; }
+
+        //
+        // Observers
+        //////////////
+
+        key_compare key_comp() const { return this->GetCompare(); }
+
+    private:
+        iterator at_index(index_type index) noexcept { return index == npos ? end() : begin() + index; }
+        const_iterator at_index(index_type index) const noexcept { return index == npos ? end() : begin() + index; }
+
+        index_type index_of(const_iterator pos) const noexcept { return static_cast<index_type>(pos - begin()); }
+
+        // in m_order, the first index whose key is not less than key
+        auto order_lower_bound(const key_type& key) {
+            return std::lower_bound(m_order.begin(), m_order.end(), key,
+                [&](index_type index, const key_type& k) { return this->GetCompare()(m_elems[index].first, k); });
+        }
+
+        index_type find_index(const key_type& key) const {
+            auto target = const_cast<static_lru_map*>(this)->order_lower_bound(key);
+            return target != m_order.end() && !this->GetCompare()(key, m_elems[*target].first) ? *target : npos;
+        }
+
+        void unlink(index_type index) noexcept {
+            (m_prev[index] != npos ? m_next[m_prev[index]] : m_head) = m_next[index];
+            (m_next[index] != npos ? m_prev[m_next[index]] : m_tail) = m_prev[index];
+        }
+
+        void link_front(index_type index) noexcept {
+            m_prev[index] = npos;
+            m_next[index] = m_head;
+            (m_head != npos ? m_prev[m_head] : m_tail) = index;
+            m_head = index;
+        }
+
+        void touch(index_type index) noexcept {
+            if (index == m_head)
+                return;
+            unlink(index);
+            link_front(index);
+        }
+
+        // inserts make_slot() as the most recent element if no element is equal to key,
+        // reuses the slot of the least recent element if full
+        template<typename MakeSlot>
+        std::pair<iterator, bool> insert_unique(const key_type& key, MakeSlot&& make_slot) {
+            auto target = order_lower_bound(key);
+            if (target != m_order.end() && !this->GetCompare()(key, m_elems[*target].first)) {
+                const index_type index = *target;
+                touch(index);
+                return { begin() + index, false };
+            }
+            index_type index;
+            if (full()) {
+                index = m_tail;
+                const auto evicted = order_lower_bound(m_elems[index].first);
+                m_elems[index] = std::forward<MakeSlot>(make_slot)();
+                m_order.erase(evicted);
+                unlink(index);
+                target = order_lower_bound(m_elems[index].first);
+            }
+            else {
+                index = static_cast<index_type>(m_elems.size());
+                m_elems.push_back(std::forward<MakeSlot>(make_slot)());
+            }
+            m_order.insert(target, index);
+            link_front(index);
+            return { begin() + index, true };
+        }
+
+        // k and args are only consumed if k is inserted
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+            return insert_unique(k, [&]() {
+                return slot_type(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template<typename K, typename M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& k, M&& m) {
+            auto rst = insert_unique(k, [&]() { return slot_type(std::forward<K>(k), std::forward<M>(m)); });
+            if (!rst.second)
+                rst.first->second = std::forward<M>(m);
+            return rst;
+        }
+
+        static_vector<slot_type, N> m_elems;
+        static_vector<index_type, N> m_order; // slot indices in key order
+        std::array<index_type, N> m_prev{}; // towards the most recent
+        std::array<index_type, N> m_next{}; // towards the least recent
+        index_type m_head{ npos }; // the most recent
+        index_type m_tail{ npos }; // the least recent
+    };
+}
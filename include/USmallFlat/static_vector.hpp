@@ -1,5 +1,8 @@
 #pragma once
 
+#include "overflow_policy.hpp"
+#include "details/relocate.hpp"
+
 #include <cassert>
 #include <stdexcept>
 #include <algorithm>
@@ -25,8 +28,13 @@ namespace Ubpa::details {
 }
 
 namespace Ubpa {
-    template <class T, std::size_t N = 16>
+    // Overflow: overflow_assert or overflow_throw, for the functions growing the size beyond N
+    // usable in constant expressions (memcpy / memmove / relocation paths are runtime only),
+    // a constexpr variable needs a default constructible and trivially destructible T
+    // (in a constant evaluation all of the N elements are value-initialized, see storage_type)
+    template <class T, std::size_t N = 16, typename Overflow = overflow_assert>
     class static_vector {
+        static_assert(std::is_same_v<Overflow, overflow_assert> || std::is_same_v<Overflow, overflow_throw>);
     public:
         //////////////////
         // Member types //
@@ -48,50 +56,52 @@ namespace Ubpa {
         // Member functions //
         //////////////////////
 
-        static_vector() noexcept : m_size{ 0 } {}
+        constexpr static_vector() noexcept : m_size{ 0 } {}
 
-        explicit static_vector(size_type count) : m_size{ count } {
-            assert(count <= N);
-            std::uninitialized_value_construct(begin(), end());
+        constexpr explicit static_vector(size_type count) : m_size{ count } {
+            check_capacity(count);
+            uninitialized_value_construct(begin(), end());
         }
 
-        static_vector(size_type count, const value_type& value) : m_size{ count } {
-            assert(count <= N);
-            std::uninitialized_fill(begin(), end(), value);
+        constexpr static_vector(size_type count, const value_type& value) : m_size{ count } {
+            check_capacity(count);
+            uninitialized_fill(begin(), end(), value);
         }
 
-        static_vector(const static_vector& other) : m_size{ other.m_size } {
-            std::uninitialized_copy(other.begin(), other.end(), begin());
+        constexpr static_vector(const static_vector& other) : m_size{ other.m_size } {
+            uninitialized_copy(other.begin(), other.end(), begin());
         }
 
-        static_vector(static_vector&& other) noexcept : m_size{ other.m_size } {
-            std::uninitialized_move(other.begin(), other.end(), begin());
-            other.clear();
+        constexpr static_vector(static_vector&& other) noexcept : m_size{ other.m_size } {
+            relocate(other.begin(), other.end(), begin());
+            other.m_size = 0;
         }
 
-        static_vector(std::initializer_list<value_type> ilist) : m_size{ static_cast<size_type>(ilist.size()) } {
-            assert(ilist.size() <= N);
-            std::uninitialized_copy(ilist.begin(), ilist.end(), begin());
+        constexpr static_vector(std::initializer_list<value_type> ilist) : m_size{ static_cast<size_type>(ilist.size()) } {
+            check_capacity(ilist.size());
+            uninitialized_copy(ilist.begin(), ilist.end(), begin());
         }
 
         template<typename Iter> requires std::input_iterator<Iter>
-        static_vector(Iter first, Iter last) : static_vector(first, last, typename std::iterator_traits<Iter>::iterator_category{}) {}
+        constexpr static_vector(Iter first, Iter last) : static_vector(first, last, typename std::iterator_traits<Iter>::iterator_category{}) {}
 
-        ~static_vector() { std::destroy(begin(), end()); }
+        constexpr ~static_vector() { destroy(begin(), end()); }
 
-        static_vector& operator=(const static_vector& rhs) {
+        constexpr static_vector& operator=(const static_vector& rhs) {
             if (this != &rhs) {
                 if (m_size > rhs.m_size) {
-                    std::destroy(begin() + rhs.m_size, end());
+                    destroy(begin() + rhs.m_size, end());
                     std::copy(rhs.begin(), rhs.end(), begin());
                 }
                 else {
-                    if constexpr (std::is_trivially_copy_assignable_v<value_type> && std::is_trivially_copy_constructible_v<value_type>) {
-                        std::memcpy(&m_storage, &rhs.m_storage, rhs.m_size * sizeof(value_type));
+                    if (std::is_trivially_copy_assignable_v<value_type> && std::is_trivially_copy_constructible_v<value_type>
+                        && !std::is_constant_evaluated())
+                    {
+                        std::memcpy(static_cast<void*>(data()), static_cast<const void*>(rhs.data()), rhs.m_size * sizeof(value_type));
                     }
                     else {
                         std::copy(rhs.begin(), rhs.begin() + m_size, begin());
-                        std::uninitialized_copy(rhs.begin() + m_size, rhs.end(), end());
+                        uninitialized_copy(rhs.begin() + m_size, rhs.end(), end());
                     }
                 }
                 m_size = rhs.m_size;
@@ -99,19 +109,33 @@ namespace Ubpa {
             return *this;
         }
 
-        static_vector& operator=(static_vector&& rhs) noexcept {
+        constexpr static_vector& operator=(static_vector&& rhs) noexcept {
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                if (!std::is_constant_evaluated()) {
+                    if (this != &rhs) {
+                        destroy(begin(), end());
+                        details::uninitialized_relocate(rhs.begin(), rhs.end(), begin());
+                        m_size = rhs.m_size;
+                        rhs.m_size = 0;
+                    }
+                    return *this;
+                }
+            }
+
             if (this != &rhs) {
                 if (m_size > rhs.m_size) {
-                    std::destroy(begin() + rhs.m_size, end());
+                    destroy(begin() + rhs.m_size, end());
                     std::move(rhs.begin(), rhs.end(), begin());
                 }
                 else {
-                    if constexpr (std::is_trivially_move_assignable_v<value_type> && std::is_trivially_move_constructible_v<value_type>) {
-                        std::memcpy(&m_storage, &rhs.m_storage, rhs.m_size * sizeof(value_type));
+                    if (std::is_trivially_move_assignable_v<value_type> && std::is_trivially_move_constructible_v<value_type>
+                        && !std::is_constant_evaluated())
+                    {
+                        std::memcpy(static_cast<void*>(data()), static_cast<const void*>(rhs.data()), rhs.m_size * sizeof(value_type));
                     }
                     else {
-                        std::copy(rhs.begin(), rhs.begin() + m_size, begin());
-                        std::uninitialized_move(rhs.begin() + m_size, rhs.end(), end());
+                        std::move(rhs.begin(), rhs.begin() + m_size, begin());
+                        uninitialized_move(rhs.begin() + m_size, rhs.end(), end());
                     }
                 }
                 m_size = rhs.m_size;
@@ -120,28 +144,30 @@ namespace Ubpa {
             return *this;
         }
 
-        static_vector& operator=(std::initializer_list<value_type> rhs) {
-            assert(rhs.size() <= N);
+        constexpr static_vector& operator=(std::initializer_list<value_type> rhs) {
+            check_capacity(rhs.size());
             const size_type rhs_size = static_cast<size_type>(rhs.size());
             if (m_size > rhs_size) {
-                std::destroy(begin() + rhs_size, end());
+                destroy(begin() + rhs_size, end());
                 std::copy(rhs.begin(), rhs.end(), begin());
             }
             else {
-                if constexpr (std::is_trivially_copy_assignable_v<value_type> && std::is_trivially_copy_constructible_v<value_type>) {
-                    std::memcpy(&m_storage, rhs.begin(), rhs_size * sizeof(value_type));
+                if (std::is_trivially_copy_assignable_v<value_type> && std::is_trivially_copy_constructible_v<value_type>
+                    && !std::is_constant_evaluated())
+                {
+                    std::memcpy(static_cast<void*>(data()), static_cast<const void*>(rhs.begin()), rhs_size * sizeof(value_type));
                 }
                 else {
                     std::copy(rhs.begin(), rhs.begin() + m_size, begin());
-                    std::uninitialized_copy(rhs.begin() + m_size, rhs.end(), end());
+                    uninitialized_copy(rhs.begin() + m_size, rhs.end(), end());
                 }
             }
             m_size = rhs_size;
             return *this;
         }
 
-        void assign(size_type count, const value_type& value) {
-            assert(count <= N);
+        constexpr void assign(size_type count, const value_type& value) {
+            check_capacity(count);
 
             const pointer myfirst = begin();
             const pointer mylast = end();
@@ -149,22 +175,22 @@ namespace Ubpa {
             if (count > m_size) {
                 std::fill(myfirst, mylast, value);
 
-                std::uninitialized_fill_n(mylast, count - m_size, value);
+                uninitialized_fill(mylast, myfirst + count, value);
             }
             else {
                 const pointer newlast = myfirst + count;
                 std::fill(myfirst, newlast, value);
-                std::destroy(newlast, mylast);
+                destroy(newlast, mylast);
             }
             m_size = count;
         }
 
         template<class Iter> requires std::input_iterator<Iter>
-        void assign(Iter first, Iter last) {
+        constexpr void assign(Iter first, Iter last) {
             assign_range(first, last, typename std::iterator_traits<Iter>::iterator_category{});
         }
 
-        void assign(std::initializer_list<T> ilist) {
+        constexpr void assign(std::initializer_list<T> ilist) {
             assign_range(ilist.begin(), ilist.end(), std::random_access_iterator_tag{});
         }
 
@@ -172,275 +198,369 @@ namespace Ubpa {
         // Element access
         ///////////////////
 
-        reference at(size_type pos) {
+        constexpr reference at(size_type pos) {
             if (pos >= size())
                 throw_out_of_range();
 
             return *(data() + pos);
         }
 
-        const_reference at(size_type pos) const {
+        constexpr const_reference at(size_type pos) const {
             if (pos >= size())
                 throw_out_of_range();
 
             return *(data() + pos);
         }
 
-        reference operator[](size_type pos) noexcept {
+        constexpr reference operator[](size_type pos) noexcept {
             assert(pos < size());
             return *(data() + pos);
         }
 
-        const_reference operator[](size_type pos) const noexcept {
+        constexpr const_reference operator[](size_type pos) const noexcept {
             assert(pos < size());
             return *(data() + pos);
         }
 
-        reference front() noexcept {
+        constexpr reference front() noexcept {
             assert(!empty());
             return *data();
         }
 
-        const_reference front() const noexcept {
+        constexpr const_reference front() const noexcept {
             assert(!empty());
             return *data();
         }
 
-        reference back() noexcept {
+        constexpr reference back() noexcept {
             assert(!empty());
             return *(data() + m_size - 1);
         }
 
-        const_reference back() const noexcept {
+        constexpr const_reference back() const noexcept {
             assert(!empty());
             return *(data() + m_size - 1);
         }
 
-        pointer data() noexcept { return reinterpret_cast<pointer>(&m_storage); }
-        const_pointer data() const noexcept { return reinterpret_cast<const_pointer>(&m_storage); }
+        constexpr pointer data() noexcept { return m_storage.elems; }
+        constexpr const_pointer data() const noexcept { return m_storage.elems; }
 
         //
         // Iterators
         //////////////
 
-        iterator begin() noexcept { return data(); }
-        const_iterator begin() const noexcept { return data(); }
-        const_iterator cbegin() const noexcept { return begin(); }
+        constexpr iterator begin() noexcept { return data(); }
+        constexpr const_iterator begin() const noexcept { return data(); }
+        constexpr const_iterator cbegin() const noexcept { return begin(); }
 
-        iterator end() noexcept { return data() + m_size; }
-        const_iterator end() const noexcept { return data() + m_size; }
-        const_iterator cend() const noexcept { return end(); }
+        constexpr iterator end() noexcept { return data() + m_size; }
+        constexpr const_iterator end() const noexcept { return data() + m_size; }
+        constexpr const_iterator cend() const noexcept { return end(); }
 
-        reverse_iterator rbegin() noexcept { return reverse_iterator{ end() }; }
-        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{ end() }; }
-        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+        constexpr reverse_iterator rbegin() noexcept { return reverse_iterator{ end() }; }
+        constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{ end() }; }
+        constexpr const_reverse_iterator crbegin() const noexcept { return rbegin(); }
 
-        reverse_iterator rend() noexcept { return reverse_iterator{ begin() }; }
-        const_reverse_iterator rend() const noexcept { return const_reverse_iterator{ begin() }; }
-        const_reverse_iterator crend() const noexcept { return rend(); }
+        constexpr reverse_iterator rend() noexcept { return reverse_iterator{ begin() }; }
+        constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator{ begin() }; }
+        constexpr const_reverse_iterator crend() const noexcept { return rend(); }
 
         //
         // Capacity
         /////////////
 
-        bool empty() const noexcept { return m_size == 0; }
+        constexpr bool empty() const noexcept { return m_size == 0; }
 
-        size_type size() const noexcept { return m_size; }
+        constexpr size_type size() const noexcept { return m_size; }
 
-        size_type max_size() const noexcept { return N; }
+        constexpr size_type max_size() const noexcept { return N; }
 
-        size_type capacity() const noexcept { return N; }
+        constexpr size_type capacity() const noexcept { return N; }
 
         //
         // Modifiers
         //////////////
 
-        void clear() noexcept {
-            if constexpr (!std::is_trivially_destructible_v<T>) {
-                for(value_type& elem : *this)
-                    elem.~value_type();
-            }
+        constexpr void clear() noexcept {
+            destroy(begin(), end());
             m_size = 0;
         }
 
-        iterator insert(const_iterator pos, const value_type& value) {
+        constexpr iterator insert(const_iterator pos, const value_type& value) {
             return emplace(pos, value);
         }
 
-        iterator insert(const_iterator pos, value_type&& value) {
+        constexpr iterator insert(const_iterator pos, value_type&& value) {
             return emplace(pos, std::move(value));
         }
 
-        iterator insert(const_iterator pos, size_type count, const value_type& value) {
-            assert(size() + count <= N);
+        constexpr iterator insert(const_iterator pos, size_type count, const value_type& value) {
+            check_capacity(size() + count);
             iterator last = end();
             assert(begin() <= pos && pos <= last);
             const pointer posptr = const_cast<pointer>(pos);
 
             const auto affected_elements = static_cast<size_type>(last - posptr);
 
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                if (affected_elements != 0 && !std::is_constant_evaluated()) {
+                    // value may refer to an element
+                    const value_type tmp(value);
+                    // [pos, last) --relocate--> [pos+count, last+count)
+                    details::relocate_overlapping(posptr, last, posptr + count);
+                    try {
+                        std::uninitialized_fill_n(posptr, count, tmp);
+                    }
+                    catch (...) {
+                        details::relocate_overlapping(posptr + count, last + count, posptr);
+                        throw;
+                    }
+                    m_size += count;
+                    return posptr;
+                }
+            }
+
             if (affected_elements == 0)
                 ;
             else if (affected_elements < count) {
-                // [pos, last) --move--> [last, ...)
-                std::uninitialized_move(posptr, last, last);
-                std::destroy(posptr, last);
+                // [pos, last) --move--> [pos+count, last+count), beyond last
+                uninitialized_move(posptr, last, posptr + count);
+                destroy(posptr, last);
             }
             else {
-                if constexpr (std::is_trivially_move_assignable_v<value_type>) {
-                    if constexpr (std::is_trivially_move_constructible_v<value_type>)
-                        // 1. + 2. [pos, last) --move--> [pos+count, last+count)
-                        std::memmove(posptr + count, posptr, (last - posptr) * sizeof(value_type));
-                    else {
-                        // 1. [last-count, last) -> [last, last+count)
-                        std::uninitialized_move(last - count, last, last);
-                        // 2. [pos, last-count) --move--> [pos+count, last)
-                        std::memmove(posptr + count, posptr, (last - posptr - count) * sizeof(value_type));
-                    }
+                if (std::is_trivially_move_assignable_v<value_type> && std::is_trivially_move_constructible_v<value_type>
+                    && !std::is_constant_evaluated())
+                {
+                    // 1. + 2. [pos, last) --move--> [pos+count, last+count)
+                    std::memmove(static_cast<void*>(posptr + count), static_cast<const void*>(posptr), (last - posptr) * sizeof(value_type));
                 }
                 else {
                     // 1. [last-count, last) -> [last, last+count)
-                    std::uninitialized_move(last - count, last, last);
+                    uninitialized_move(last - count, last, last);
                     // 2. [pos, last-count) --move--> [pos+count, last)
-                    for (auto cursor = last - count - 1; cursor >= pos; --cursor)
-                        *(cursor + count) = std::move(*cursor);
+                    move_right(posptr, last - count, posptr + count);
                 }
 
-                std::destroy(posptr, posptr + count);
+                destroy(posptr, posptr + count);
             }
 
-            std::uninitialized_fill(posptr, posptr + count, value);
+            uninitialized_fill(posptr, posptr + count, value);
 
             m_size += count;
 
             return posptr;
         }
-        
+
         template<typename Iter> requires std::input_iterator<Iter>
-        iterator insert(const_iterator pos, Iter first, Iter last) {
+        constexpr iterator insert(const_iterator pos, Iter first, Iter last) {
             insert_range(pos, first, last, typename std::iterator_traits<Iter>::iterator_category{});
             return const_cast<iterator>(pos);
         }
 
-        iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+        constexpr iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
             return insert(pos, ilist.begin(), ilist.end());
         }
 
         template<typename... Args>
-        iterator emplace(const_iterator pos, Args&&... args) {
+        constexpr iterator emplace(const_iterator pos, Args&&... args) {
             pointer posptr = const_cast<pointer>(pos);
-            assert(size() < max_size());
+            check_capacity(size() + 1);
             iterator last = end();
             assert(begin() <= pos && pos <= last);
 
-            if (posptr != last) {
-                if constexpr (std::is_trivially_move_assignable_v<value_type>) {
-                    if constexpr (std::is_trivially_move_constructible_v<value_type>)
-                        // 1. + 2. [pos, last) --move--> [pos+1, last+1)
-                        std::memmove(posptr + 1, posptr, (last - posptr) * sizeof(value_type));
-                    else {
-                        // 1. pos -> last
-                        new(last)value_type{ std::move(*(last - 1)) };
-                        // 2. [pos, last-1) --move--> [pos+1, last)
-                        std::memmove(posptr + 1, posptr, (last - posptr - 1) * sizeof(value_type));
-                    }
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                if (!std::is_constant_evaluated()) {
+                    // built at last while args (which may refer to an element) are in place,
+                    // then [pos, last) --relocate--> [pos+1, last+1)
+                    std::construct_at(last, std::forward<Args>(args)...);
+                    details::relocate_last_to(posptr, last);
+                    ++m_size;
+                    return posptr;
                 }
-                else {
-                    // 1. pos -> last
-                    new(last)value_type{ std::move(*(last - 1)) };
-                    // 2. [pos, last-1) --move--> [pos+1, last)
-                    for (auto cursor = last - 2; cursor >= pos; --cursor)
-                        *(cursor + 1) = std::move(*cursor);
-                }
-                
-                // 3. destroy
-                if constexpr (!std::is_trivially_destructible_v<value_type>)
-                    posptr->~value_type();
             }
-            // 4. copy ctor at pos
-            new(posptr)value_type{ std::forward<Args>(args)... };
+
+            if (posptr == last) {
+                std::construct_at(posptr, std::forward<Args>(args)...);
+                ++m_size;
+                return posptr;
+            }
+
+            // args may refer to an element, so build the value before shifting
+            value_type tmp(std::forward<Args>(args)...);
+
+            if (std::is_trivially_move_assignable_v<value_type> && std::is_trivially_move_constructible_v<value_type>
+                && !std::is_constant_evaluated())
+            {
+                // 1. + 2. [pos, last) --move--> [pos+1, last+1)
+                std::memmove(static_cast<void*>(posptr + 1), static_cast<const void*>(posptr), (last - posptr) * sizeof(value_type));
+            }
+            else {
+                // 1. pos -> last
+                std::construct_at(last, std::move(*(last - 1)));
+                // 2. [pos, last-1) --move--> [pos+1, last)
+                move_right(posptr, last - 1, posptr + 1);
+            }
+
+            // 3. destroy
+            destroy(posptr, posptr + 1);
+            // 4. move ctor at pos
+            std::construct_at(posptr, std::move(tmp));
 
             ++m_size;
 
             return posptr;
         }
 
-        iterator erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
+        constexpr iterator erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
             const pointer posptr = const_cast<pointer>(pos);
             const pointer mylast = end();
             assert(begin() <= pos && pos < mylast);
 
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                if (!std::is_constant_evaluated()) {
+                    std::destroy_at(posptr);
+                    details::relocate_overlapping(posptr + 1, mylast, posptr);
+                    m_size--;
+                    return posptr;
+                }
+            }
+
             std::move(posptr + 1, mylast, posptr);
-            if constexpr (!std::is_trivially_destructible_v<value_type>)
-                (mylast - 1)->~value_type();
+            destroy(mylast - 1, mylast);
             m_size--;
             return posptr;
         }
 
-        iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
+        constexpr iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<value_type>) {
             const pointer mylast = end();
             assert(begin() <= first && first <= last && last <= mylast);
 
             const pointer firstptr = const_cast<pointer>(first);
             const pointer lastptr = const_cast<pointer>(last);
-            
+
             const size_type affected_elements = conver_size(static_cast<size_t>(last - first));
 
             if (affected_elements > 0) {
+                if constexpr (is_trivially_relocatable_v<value_type>) {
+                    if (!std::is_constant_evaluated()) {
+                        std::destroy(firstptr, lastptr);
+                        details::relocate_overlapping(lastptr, mylast, firstptr);
+                        m_size -= affected_elements;
+                        return firstptr;
+                    }
+                }
                 const pointer newlast = std::move(lastptr, mylast, firstptr);
-                std::destroy(newlast, mylast);
+                destroy(newlast, mylast);
                 m_size -= affected_elements;
             }
 
             return firstptr;
         }
 
-        void push_back(const value_type& value) {
-            assert(size() < max_size());
-            new(data() + m_size)value_type{ value };
+        constexpr void push_back(const value_type& value) {
+            check_capacity(size() + 1);
+            std::construct_at(data() + m_size, value);
             ++m_size;
         }
 
-        void push_back(T&& value) {
-            assert(size() < max_size());
-            new(data() + m_size)value_type{ std::move(value) };
+        constexpr void push_back(T&& value) {
+            check_capacity(size() + 1);
+            std::construct_at(data() + m_size, std::move(value));
             ++m_size;
         }
 
         template<typename... Args>
-        reference emplace_back(Args&&... args) {
-            assert(size() < max_size());
+        constexpr reference emplace_back(Args&&... args) {
+            check_capacity(size() + 1);
             pointer addr = data() + m_size;
-            new(addr)value_type{ std::forward<Args>(args)... };
+            std::construct_at(addr, std::forward<Args>(args)...);
             ++m_size;
             return *addr;
         }
 
-        void pop_back() {
+        // size() < max_size() is only asserted, Overflow isn't applied
+        constexpr void push_back_unchecked(const value_type& value) { emplace_back_unchecked(value); }
+
+        constexpr void push_back_unchecked(T&& value) { emplace_back_unchecked(std::move(value)); }
+
+        template<typename... Args>
+        constexpr reference emplace_back_unchecked(Args&&... args) {
+            assert(size() < N);
+            pointer addr = data() + m_size;
+            std::construct_at(addr, std::forward<Args>(args)...);
+            ++m_size;
+            return *addr;
+        }
+
+        // whatever Overflow is, returns nullptr when full
+        template<typename... Args>
+        constexpr pointer try_emplace_back(Args&&... args) {
+            if (size() == max_size())
+                return nullptr;
+            return &emplace_back_unchecked(std::forward<Args>(args)...);
+        }
+
+        constexpr pointer try_push_back(const value_type& value) { return try_emplace_back(value); }
+
+        constexpr pointer try_push_back(T&& value) { return try_emplace_back(std::move(value)); }
+
+        template<typename Iter> requires std::input_iterator<Iter>
+        constexpr void append(Iter first, Iter last) {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>) {
+                const auto count = conver_size(static_cast<size_t>(std::distance(first, last)));
+                check_capacity(m_size + count);
+                uninitialized_copy(first, last, end());
+                m_size += count;
+            }
+            else {
+                for (; first != last; ++first)
+                    emplace_back(*first);
+            }
+        }
+
+        constexpr void append(std::initializer_list<value_type> ilist) { append(ilist.begin(), ilist.end()); }
+
+        constexpr void pop_back() {
             assert(!empty());
-            if constexpr (!std::is_trivially_destructible_v<value_type>)
-                back().~value_type();
+            destroy(end() - 1, end());
             --m_size;
         }
 
-        void resize(size_type count) {
-            assert(count < max_size());
+        constexpr void resize(size_type count) {
+            check_capacity(count);
 
             if (count > m_size)
-                std::uninitialized_default_construct(end(), begin() + count);
+                uninitialized_value_construct(end(), begin() + count);
             else
-                std::destroy(begin() + count, end());
+                destroy(begin() + count, end());
 
             m_size = count;
         }
 
-        void resize(size_type count, const T& value) {
-            assert(count < max_size());
+        constexpr void resize(size_type count, const T& value) {
+            check_capacity(count);
 
             if (count > m_size)
-                std::uninitialized_fill(end(), begin() + count, value);
+                uninitialized_fill(end(), begin() + count, value);
+            else
+                destroy(begin() + count, end());
+
+            m_size = count;
+        }
+
+        // like resize(count), but the new elements are default-initialized (left indeterminate for trivial types),
+        // to be overwritten through data()
+        constexpr void resize_default_init(size_type count) {
+            check_capacity(count);
+
+            if (count > m_size) {
+                if (std::is_constant_evaluated())
+                    uninitialized_value_construct(end(), begin() + count);
+                else
+                    std::uninitialized_default_construct(end(), begin() + count);
+            }
             else
-                std::destroy(begin() + count, end());
+                destroy(begin() + count, end());
 
             m_size = count;
         }
@@ -449,18 +569,20 @@ namespace Ubpa {
         [[noreturn]] void throw_out_of_range() const { throw std::out_of_range("invalid static_vector subscript"); }
 
         template<typename Iter> requires std::input_iterator<Iter>
-        static_vector(Iter first, Iter last, std::input_iterator_tag) {
+        constexpr static_vector(Iter first, Iter last, std::input_iterator_tag) : m_size{ 0 } {
             for (; first != last; ++first)
                 emplace_back(*first);
         }
         template<typename Iter> requires std::input_iterator<Iter>
-        static_vector(Iter first, Iter last, std::forward_iterator_tag) {
-            auto mylast = std::uninitialized_copy(first, last, begin());
+        constexpr static_vector(Iter first, Iter last, std::forward_iterator_tag) : m_size{ 0 } {
+            if constexpr (std::is_same_v<Overflow, overflow_throw>)
+                check_capacity(static_cast<std::size_t>(std::distance(first, last)));
+            auto mylast = uninitialized_copy(first, last, begin());
             m_size = conver_size(static_cast<size_t>(mylast - begin()));
         }
 
         template <class Iter>
-        void assign_range(Iter first, Iter last, std::input_iterator_tag) { // assign input range [first, last)
+        constexpr void assign_range(Iter first, Iter last, std::input_iterator_tag) { // assign input range [first, last)
             const pointer myfirst = begin();
             const pointer mylast = end();
 
@@ -470,8 +592,8 @@ namespace Ubpa {
                 *cursor = *first;
 
             // Trim.
-            std::destroy(cursor, mylast);
-            m_size = cursor - myfirst;
+            destroy(cursor, mylast);
+            m_size = static_cast<size_type>(cursor - myfirst);
 
             // Append.
             for (; first != last; ++first)
@@ -479,9 +601,8 @@ namespace Ubpa {
         }
 
         template <class Iter>
-        void assign_range(Iter first, Iter last, std::forward_iterator_tag) { // assign forward range [first, last)
+        constexpr void assign_range(Iter first, Iter last, std::forward_iterator_tag) { // assign forward range [first, last)
             const auto newsize = conver_size(static_cast<size_t>(std::distance(first, last)));
-            assert(newsize <= N);
             const pointer myfirst = begin();
             const pointer mylast = end();
 
@@ -489,19 +610,19 @@ namespace Ubpa {
                 // performance note: traversing [first, _Mid) twice
                 const Iter mid = std::next(first, static_cast<difference_type>(m_size));
                 std::copy(first, mid, myfirst);
-                std::uninitialized_copy(mid, last, mylast);
+                uninitialized_copy(mid, last, mylast);
             }
             else {
                 const pointer newlast = myfirst + newsize;
                 std::copy(first, last, myfirst);
-                std::destroy(newlast, mylast);
+                destroy(newlast, mylast);
             }
 
             m_size = newsize;
         }
 
         template<typename Iter>
-        void insert_range(const_iterator pos, Iter first, Iter last, std::input_iterator_tag) {
+        constexpr void insert_range(const_iterator pos, Iter first, Iter last, std::input_iterator_tag) {
             assert(begin() <= pos && pos <= end());
 
             if (first == last)
@@ -511,29 +632,35 @@ namespace Ubpa {
             const auto whereoff = static_cast<size_type>(pos - myfirst);
             const auto oldsize = m_size;
 
-            for (; first != last; ++first) {
+            for (; first != last; ++first)
                 emplace_back(*first);
-                assert(m_size < max_size());
-                ++m_size;
-            }
 
             std::rotate(myfirst + whereoff, myfirst + oldsize, end());
         }
 
         template<typename S>
-        static constexpr size_type conver_size(const S& s) noexcept {
-            assert(s <= N);
+        static constexpr size_type conver_size(const S& s) {
+            check_capacity(s);
             return static_cast<size_type>(s);
         }
 
+        static constexpr void check_capacity(std::size_t count) {
+            if constexpr (std::is_same_v<Overflow, overflow_throw>) {
+                if (count > N)
+                    throw std::length_error("static_vector overflow");
+            }
+            else
+                assert(count <= N);
+        }
+
         template<typename Iter>
-        void insert_range(const_iterator pos, Iter first, Iter last, std::forward_iterator_tag) {
+        constexpr void insert_range(const_iterator pos, Iter first, Iter last, std::forward_iterator_tag) {
 
             // insert forward range [first, last) at pos
             const pointer posptr = const_cast<pointer>(pos);
             const auto count = conver_size(static_cast<size_t>(std::distance(first, last)));
 
-            assert(count + m_size <= N);
+            check_capacity(count + m_size);
             assert(begin() <= pos && pos <= end());
 
             const pointer oldlast = end();
@@ -544,66 +671,157 @@ namespace Ubpa {
 
             const auto affected_elements = static_cast<size_type>(oldlast - posptr);
 
-            if (count < affected_elements) { // some affected elements must be assigned
-                if constexpr (std::is_trivially_move_assignable_v<value_type>) {
-                    if constexpr (std::is_trivially_move_constructible_v<value_type>)
-                        std::memmove(posptr + count, posptr, affected_elements * sizeof(value_type));
-                    else {
-                        /*mylast = */std::uninitialized_move(oldlast - count, oldlast, oldlast);
-                        std::memmove(posptr + count, posptr, (affected_elements - count) * sizeof(value_type));
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                if (!std::is_constant_evaluated()) {
+                    // [pos, oldlast) --relocate--> [pos+count, oldlast+count)
+                    details::relocate_overlapping(posptr, oldlast, posptr + count);
+                    try {
+                        std::uninitialized_copy(first, last, posptr);
                     }
+                    catch (...) {
+                        details::relocate_overlapping(posptr + count, oldlast + count, posptr);
+                        throw;
+                    }
+                    m_size += count;
+                    return;
+                }
+            }
+
+            if (count < affected_elements) { // some affected elements must be assigned
+                if (std::is_trivially_move_assignable_v<value_type> && std::is_trivially_move_constructible_v<value_type>
+                    && !std::is_constant_evaluated())
+                {
+                    std::memmove(static_cast<void*>(posptr + count), static_cast<const void*>(posptr), affected_elements * sizeof(value_type));
                 }
                 else {
-                    /*mylast = */std::uninitialized_move(oldlast - count, oldlast, oldlast);
-                    std::move(posptr, oldlast - count, posptr + count);
-                    for (auto cursor = oldlast - count - 1; cursor >= posptr; --cursor)
-                        *(cursor + count) = std::move(*cursor);
+                    /*mylast = */uninitialized_move(oldlast - count, oldlast, oldlast);
+                    move_right(posptr, oldlast - count, posptr + count);
                 }
-                std::destroy(posptr, posptr + count);
-                std::uninitialized_copy(first, last, posptr);
+                destroy(posptr, posptr + count);
+                uninitialized_copy(first, last, posptr);
             }
             else { // affected elements don't overlap before/after
                 const pointer relocated = posptr + count;
-                std::uninitialized_move(posptr, oldlast, relocated);
-                std::destroy(posptr, oldlast);
+                uninitialized_move(posptr, oldlast, relocated);
+                destroy(posptr, oldlast);
 
-                std::uninitialized_copy(first, last, posptr);
+                uninitialized_copy(first, last, posptr);
             }
 
             m_size += count;
         }
 
-        std::aligned_storage_t<sizeof(T)* N, alignof(T)> m_storage;
+        //
+        // Element lifetime
+        /////////////////////
+        // std::uninitialized_* aren't constexpr in C++20, a constant evaluation constructs the elements one by one
+
+        template<typename Iter>
+        static constexpr pointer uninitialized_copy(Iter first, Iter last, pointer dest) {
+            if (std::is_constant_evaluated()) {
+                for (; first != last; ++first, ++dest)
+                    std::construct_at(dest, *first);
+                return dest;
+            }
+            return std::uninitialized_copy(first, last, dest);
+        }
+
+        static constexpr pointer uninitialized_move(pointer first, pointer last, pointer dest) {
+            return uninitialized_copy(std::make_move_iterator(first), std::make_move_iterator(last), dest);
+        }
+
+        static constexpr void uninitialized_fill(pointer first, pointer last, const value_type& value) {
+            if (std::is_constant_evaluated()) {
+                for (; first != last; ++first)
+                    std::construct_at(first, value);
+            }
+            else
+                std::uninitialized_fill(first, last, value);
+        }
+
+        static constexpr void uninitialized_value_construct(pointer first, pointer last) {
+            if (std::is_constant_evaluated()) {
+                for (; first != last; ++first)
+                    std::construct_at(first);
+            }
+            else
+                std::uninitialized_value_construct(first, last);
+        }
+
+        // trivially destructible elements are left alive, so a constant evaluation ends with all of them initialized
+        static constexpr void destroy(pointer first, pointer last) noexcept {
+            if constexpr (!std::is_trivially_destructible_v<value_type>)
+                std::destroy(first, last);
+        }
+
+        // [first, last) --relocate--> the uninitialized dest
+        static constexpr void relocate(pointer first, pointer last, pointer dest) {
+            if (std::is_constant_evaluated()) {
+                uninitialized_move(first, last, dest);
+                destroy(first, last);
+            }
+            else
+                details::uninitialized_relocate(first, last, dest);
+        }
+
+        // [first, last) --move--> [dest, dest + (last - first)) with first < dest, the destination elements are alive
+        static constexpr void move_right(pointer first, pointer last, pointer dest) {
+            if (std::is_trivially_move_assignable_v<value_type> && !std::is_constant_evaluated())
+                std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(value_type));
+            else
+                std::move_backward(first, last, dest + (last - first));
+        }
+
+        // no element is alive until constructed, except in a constant evaluation
+        // (a constexpr variable can't hold uninitialized elements)
+        union storage_type {
+            constexpr storage_type() noexcept {
+                if constexpr (std::is_default_constructible_v<T> && std::is_trivially_destructible_v<T>) {
+                    if (std::is_constant_evaluated()) {
+                        for (T& elem : elems)
+                            std::construct_at(&elem);
+                    }
+                }
+            }
+            constexpr ~storage_type() {}
+
+            T elems[N];
+        };
+
+        storage_type m_storage;
         size_type m_size;
     };
 
-    template<typename T, std::size_t N>
-    bool operator==(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) {
+    template<typename T, std::size_t N, typename Overflow>
+    struct is_trivially_relocatable<static_vector<T, N, Overflow>> : is_trivially_relocatable<T> {};
+
+    template<typename T, std::size_t N, typename Overflow>
+    constexpr bool operator==(const static_vector<T, N, Overflow>& lhs, const static_vector<T, N, Overflow>& rhs) {
         return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template<typename T, std::size_t N>
-    bool operator<(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) {
+    template<typename T, std::size_t N, typename Overflow>
+    constexpr bool operator<(const static_vector<T, N, Overflow>& lhs, const static_vector<T, N, Overflow>& rhs) {
         return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template<typename T, std::size_t N>
-    bool operator!=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) {
+    template<typename T, std::size_t N, typename Overflow>
+    constexpr bool operator!=(const static_vector<T, N, Overflow>& lhs, const static_vector<T, N, Overflow>& rhs) {
         return !(lhs == rhs);
     }
 
-    template<typename T, std::size_t N>
-    bool operator>(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) {
+    template<typename T, std::size_t N, typename Overflow>
+    constexpr bool operator>(const static_vector<T, N, Overflow>& lhs, const static_vector<T, N, Overflow>& rhs) {
         return rhs < lhs;
     }
 
-    template<typename T, std::size_t N>
-    bool operator<=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) {
+    template<typename T, std::size_t N, typename Overflow>
+    constexpr bool operator<=(const static_vector<T, N, Overflow>& lhs, const static_vector<T, N, Overflow>& rhs) {
         return !(rhs < lhs);
     }
 
-    template<typename T, std::size_t N>
-    bool operator>=(const static_vector<T, N>& lhs, const static_vector<T, N>& rhs) {
+    template<typename T, std::size_t N, typename Overflow>
+    constexpr bool operator>=(const static_vector<T, N, Overflow>& lhs, const static_vector<T, N, Overflow>& rhs) {
         return !(lhs < rhs);
     }
 }
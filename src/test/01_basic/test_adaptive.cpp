@@ -0,0 +1,117 @@
+#include "doctest.h"
+#include <USmallFlat/adaptive_set.hpp>
+#include <USmallFlat/adaptive_map.hpp>
+using doctest::test_suite;
+using namespace Ubpa;
+#include <string>
+#include <set>
+#include <map>
+#include <cstdint>
+
+TEST_CASE("adaptive set" * test_suite("all")) {
+  {
+    adaptive_set<int> s;
+    REQUIRE(s.empty());
+    REQUIRE(s.begin() == s.end());
+    REQUIRE(s.mode() == adaptive_mode::linear);
+    REQUIRE(s.find(1) == s.end());
+    REQUIRE(s.erase(1) == 0);
+  }
+  {
+    // grows through all representations and shrinks back
+    adaptive_set<std::uint32_t, 4, 32> s;
+    std::set<std::uint32_t> ref;
+    for (std::uint32_t i = 0; i < 4; i++)
+      REQUIRE(s.insert(i * 7).second == ref.insert(i * 7).second);
+    REQUIRE(s.mode() == adaptive_mode::linear);
+    REQUIRE(!s.insert(7).second);
+    REQUIRE(s.insert(100).second);
+    ref.insert(100);
+    REQUIRE(s.mode() == adaptive_mode::sorted);
+    REQUIRE(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+    for (std::uint32_t i = 0; i < 27; i++)
+      REQUIRE(s.insert(1000 + i).second == ref.insert(1000 + i).second);
+    REQUIRE(s.size() == 32);
+    REQUIRE(s.mode() == adaptive_mode::sorted);
+    REQUIRE(s.insert(5000).second);
+    ref.insert(5000);
+    REQUIRE(s.mode() == adaptive_mode::hashed);
+    for (auto key : ref)
+      REQUIRE(s.contains(key));
+    REQUIRE(!s.contains(1));
+
+    // below M / 2: sorted, at N / 2: linear
+    while (s.size() >= 16) {
+      const auto key = *ref.begin();
+      REQUIRE(s.mode() == adaptive_mode::hashed);
+      REQUIRE(s.erase(key) == 1);
+      ref.erase(key);
+    }
+    REQUIRE(s.mode() == adaptive_mode::sorted);
+    REQUIRE(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+    while (s.size() > 2) {
+      const auto key = *ref.rbegin();
+      REQUIRE(s.mode() == adaptive_mode::sorted);
+      REQUIRE(s.erase(key) == 1);
+      ref.erase(key);
+    }
+    REQUIRE(s.mode() == adaptive_mode::linear);
+    REQUIRE(s == adaptive_set<std::uint32_t, 4, 32>(ref.begin(), ref.end()));
+  }
+  {
+    adaptive_set<std::uint32_t, 8, 64> s;
+    std::set<std::uint32_t> ref;
+    std::uint32_t x = 1;
+    for (int i = 0; i < 20000; i++) {
+      x = x * 1103515245u + 12345u;
+      const std::uint32_t key = (x >> 8) % 200;
+      if ((i / 1000) % 2 == 0)
+        REQUIRE(s.insert(key).second == ref.insert(key).second);
+      else
+        REQUIRE(s.erase(key) == ref.erase(key));
+      REQUIRE(s.size() == ref.size());
+    }
+    for (std::uint32_t key = 0; key < 200; key++)
+      REQUIRE(s.contains(key) == ref.contains(key));
+  }
+  {
+    adaptive_set<std::string, 2, 4> s{ "a", "b", "c" };
+    REQUIRE(s.mode() == adaptive_mode::sorted);
+    auto t = std::move(s);
+    REQUIRE(s.empty());
+    REQUIRE(s.mode() == adaptive_mode::linear);
+    REQUIRE(t.size() == 3);
+    REQUIRE(*t.begin() == "a");
+  }
+}
+
+TEST_CASE("adaptive map" * test_suite("all")) {
+  adaptive_map<int, std::string, 2, 8> m{ {1, "a"} };
+  REQUIRE(m.try_emplace(2, "b").second);
+  REQUIRE(!m.try_emplace(2, "x").second);
+  REQUIRE(m.mode() == adaptive_mode::linear);
+  m[3] = "c";
+  REQUIRE(m.mode() == adaptive_mode::sorted);
+  REQUIRE(m.at(3) == "c");
+  REQUIRE_THROWS(m.at(4));
+  REQUIRE(!m.insert_or_assign(3, "cc").second);
+  REQUIRE(m.at(3) == "cc");
+  for (int i = 4; i <= 9; i++)
+    REQUIRE(m.emplace(i, std::to_string(i)).second);
+  REQUIRE(m.mode() == adaptive_mode::hashed);
+  REQUIRE(!m.insert({ 9, "x" }).second);
+  REQUIRE(m.at(9) == "9");
+  m[2] += "b";
+
+  std::map<int, std::string> ref{ {1, "a"}, {2, "bb"}, {3, "cc"} };
+  for (int i = 4; i <= 9; i++)
+    ref.emplace(i, std::to_string(i));
+  REQUIRE(m.size() == ref.size());
+  for (const auto& [key, value] : m)
+    REQUIRE(ref.at(key) == value);
+
+  for (int i = 9; i >= 2; i--)
+    REQUIRE(m.erase(i) == 1);
+  REQUIRE(m.mode() == adaptive_mode::linear);
+  REQUIRE(m == adaptive_map<int, std::string, 2, 8>{ {1, "a"} });
+}
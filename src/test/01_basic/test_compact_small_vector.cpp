@@ -0,0 +1,125 @@
+#include "doctest.h"
+#include <USmallFlat/compact_small_vector.hpp>
+#include <USmallFlat/small_vector.hpp>
+using doctest::test_suite;
+using namespace Ubpa;
+#include <string>
+#include <set>
+#include <stdexcept>
+
+namespace {
+  // throws once budget constructions are used up
+  struct counted {
+    static inline int live = 0;
+    static inline int budget = 0;
+    counted() { make(); }
+    counted(const counted&) { make(); }
+    ~counted() { --live; }
+    static void make() {
+      if (budget == 0)
+        throw std::runtime_error("counted");
+      --budget;
+      ++live;
+    }
+  };
+}
+
+TEST_CASE("compact small vector" * test_suite("all")) {
+  static_assert(sizeof(compact_small_vector<int, 4>) == 2 * sizeof(std::size_t) + 4 * sizeof(int));
+  static_assert(sizeof(compact_small_vector<int, 1>) == 2 * sizeof(std::size_t) + sizeof(int*));
+  static_assert(sizeof(compact_small_vector<int, 4>) < sizeof(small_vector<int, 4>));
+  {
+    struct throwing_move {
+      throwing_move() = default;
+      throwing_move(throwing_move&&) noexcept(false) {}
+      throwing_move& operator=(throwing_move&&) noexcept(false) { return *this; }
+    };
+    static_assert(std::is_nothrow_move_constructible_v<compact_small_vector<int, 4>>);
+    static_assert(std::is_nothrow_move_assignable_v<compact_small_vector<int, 4>>);
+    static_assert(!std::is_nothrow_move_constructible_v<compact_small_vector<throwing_move, 4>>);
+    static_assert(!std::is_nothrow_move_assignable_v<compact_small_vector<throwing_move, 4>>);
+  }
+  {
+    // a throwing element constructor leaks neither the buffer nor the elements built
+    using vector_type = compact_small_vector<counted, 2>;
+    counted::budget = 3;
+    REQUIRE_THROWS_AS(vector_type(5), std::runtime_error);
+    REQUIRE(counted::live == 0);
+    counted::budget = 5;
+    vector_type v(5);
+    counted::budget = 3;
+    REQUIRE_THROWS_AS((void)vector_type(v), std::runtime_error);
+    counted::budget = 3;
+    REQUIRE_THROWS_AS(vector_type(v.begin(), v.end()), std::runtime_error);
+    counted::budget = 3;
+    REQUIRE_THROWS_AS(vector_type(5, v[0]), std::runtime_error);
+    REQUIRE(counted::live == 5);
+  }
+  {
+    compact_small_vector<int, 4> v;
+    REQUIRE(v.empty());
+    REQUIRE(v.capacity() == 4);
+  }
+  {
+    compact_small_vector<int, 4> v;
+    for (int i = 0; i < 9; i++)
+      v.push_back(i);
+    REQUIRE(v.size() == 9);
+    REQUIRE(v.capacity() > 4);
+    for (int i = 0; i < 9; i++)
+      REQUIRE(v[i] == i);
+    while (v.size() > 3)
+      v.pop_back();
+    REQUIRE(v.capacity() > 4); // no demotion
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == 4);
+    REQUIRE(v == compact_small_vector<int, 4>{0, 1, 2});
+  }
+  {
+    compact_small_vector<std::string, 2> foo{ "a", "b", "c" };
+    compact_small_vector<std::string, 2> bar(foo);
+    REQUIRE(bar == foo);
+    compact_small_vector<std::string, 2> baz(std::move(foo));
+    REQUIRE(foo.empty());
+    REQUIRE(baz == bar);
+    baz = compact_small_vector<std::string, 2>{ "d" };
+    REQUIRE(baz == compact_small_vector<std::string, 2>{ "d" });
+    baz.swap(bar);
+    REQUIRE(bar == compact_small_vector<std::string, 2>{ "d" });
+    REQUIRE(baz == compact_small_vector<std::string, 2>{ "a", "b", "c" });
+  }
+  {
+    compact_small_vector<int, 4> v{ 1,2,3 };
+    v.insert(v.begin(), 5);
+    v.insert(v.begin(), { 5,4,3 });
+    REQUIRE(v == compact_small_vector<int, 4>{5, 4, 3, 5, 1, 2, 3});
+    v.erase(v.begin() + 1, v.begin() + 3);
+    REQUIRE(v == compact_small_vector<int, 4>{5, 5, 1, 2, 3});
+    v.insert(v.begin() + 1, 2, v[4]);
+    REQUIRE(v == compact_small_vector<int, 4>{5, 3, 3, 5, 1, 2, 3});
+  }
+  {
+    // the value refers to an element that is shifted
+    compact_small_vector<int, 4> v{ 1,2,3 };
+    v.insert(v.begin(), v[1]);
+    REQUIRE(v == compact_small_vector<int, 4>{2, 1, 2, 3});
+    v.emplace(v.begin() + 1, v[3]);
+    REQUIRE(v == compact_small_vector<int, 4>{2, 3, 1, 2, 3});
+    compact_small_vector<std::string, 4> w{ "a", "b", "c" };
+    w.insert(w.begin(), w[1]);
+    w.emplace(w.begin() + 1, w[3]);
+    REQUIRE(w == compact_small_vector<std::string, 4>{"b", "c", "a", "b", "c"});
+  }
+  {
+    compact_small_vector<int, 4> v{ 1,2,3 };
+    std::set s{ 5,4,3 };
+    v.assign(s.begin(), s.end());
+    REQUIRE(v == compact_small_vector<int, 4>{3, 4, 5});
+    v.resize(6);
+    REQUIRE(v == compact_small_vector<int, 4>{3, 4, 5, 0, 0, 0});
+    v.resize(2);
+    REQUIRE(v == compact_small_vector<int, 4>{3, 4});
+    REQUIRE(v.at(1) == 4);
+    REQUIRE_THROWS(v.at(2));
+  }
+}
@@ -3,6 +3,8 @@
 using doctest::test_suite;
 using namespace Ubpa;
 #include <string>
+#include <memory>
+#include <type_traits>
 
 TEST_CASE("Default construct a small vector of ints" * test_suite("constructors")) {
   small_vector<int, 5> vec;
@@ -42,6 +44,17 @@ TEST_CASE("Copy construct a small vector by iterator" * test_suite("constructors
   REQUIRE(copied == small_vector<int, 5>{1, 2, 3, 4, 5, 6});
 }
 
+TEST_CASE("Move construct a small vector from a std::vector" * test_suite("constructors")) {
+  std::vector<std::string> strings{ "a", "b", "c", "d", "e", "f" };
+  small_vector<std::string, 4> moved(std::move(strings));
+  REQUIRE(strings.empty());
+  REQUIRE(moved == small_vector<std::string, 4>{"a", "b", "c", "d", "e", "f"});
+  std::vector<std::string> few{ std::string(64, 'x') };
+  small_vector<std::string, 4> inline_moved(std::move(few));
+  REQUIRE(inline_moved.size() == 1);
+  REQUIRE(inline_moved[0] == std::string(64, 'x'));
+}
+
 TEST_CASE("Move construct a small vector of chars" * test_suite("constructors")) {
   small_vector<char, 5> bar(std::move(small_vector<char, 5>{'a', 'b', 'c'}));
   REQUIRE(bar.size() == 3);
@@ -62,3 +75,44 @@ TEST_CASE("Construct a small vector of bools from initializer list" * test_suite
   REQUIRE(foo[6] == static_cast<uint8_t>(true));
   REQUIRE(foo[7] == static_cast<uint8_t>(true));
 }
+
+namespace {
+  // stateful, unequal allocators don't propagate
+  template<typename T>
+  struct tagged_allocator {
+    using value_type = T;
+    using is_always_equal = std::false_type;
+    int tag = 0;
+    tagged_allocator(int t = 0) noexcept : tag{ t } {}
+    template<typename U>
+    tagged_allocator(const tagged_allocator<U>& other) noexcept : tag{ other.tag } {}
+    T* allocate(std::size_t n) { return std::allocator<T>{}.allocate(n); }
+    void deallocate(T* p, std::size_t n) noexcept { std::allocator<T>{}.deallocate(p, n); }
+    template<typename U>
+    bool operator==(const tagged_allocator<U>& rhs) const noexcept { return tag == rhs.tag; }
+  };
+
+  struct throwing_move {
+    throwing_move() = default;
+    throwing_move(throwing_move&&) noexcept(false) {}
+    throwing_move& operator=(throwing_move&&) noexcept(false) { return *this; }
+  };
+}
+
+TEST_CASE("Move assign small vectors" * test_suite("constructors")) {
+  static_assert(std::is_nothrow_move_assignable_v<small_vector<std::string, 4>>);
+  static_assert(!std::is_nothrow_move_assignable_v<small_vector<throwing_move, 4>>);
+  static_assert(!std::is_nothrow_move_assignable_v<small_vector<int, 4, tagged_allocator<int>>>);
+  small_vector<std::string, 2> foo{ "a", "b", "c" };
+  small_vector<std::string, 2> bar{ "d" };
+  bar = std::move(foo);
+  REQUIRE(foo.empty());
+  REQUIRE(bar == small_vector<std::string, 2>{ "a", "b", "c" });
+  // the default constructed allocators are equal, so the heap buffer is taken over
+  small_vector<int, 2, tagged_allocator<int>> ints{ 1, 2, 3 };
+  const int* buffer = ints.data();
+  small_vector<int, 2, tagged_allocator<int>> moved;
+  moved = std::move(ints);
+  REQUIRE(moved.data() == buffer);
+  REQUIRE(moved == small_vector<int, 2, tagged_allocator<int>>{ 1, 2, 3 });
+}
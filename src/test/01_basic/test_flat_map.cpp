@@ -2,13 +2,25 @@
 #include <USmallFlat/flat_map.hpp>
 #include <USmallFlat/static_flat_set.hpp>
 #include <USmallFlat/static_flat_map.hpp>
+#include <USmallFlat/static_lru_map.hpp>
 #include <USmallFlat/flat_map.hpp>
 #include <USmallFlat/small_vector.hpp>
+#include <USmallFlat/flat_multimap.hpp>
+#include <USmallFlat/flat_soa_map.hpp>
+#include <USmallFlat/buffered_flat_map.hpp>
+#include <USmallFlat/small_unsorted_flat_map.hpp>
+#include <USmallFlat/flat_set.hpp>
 using doctest::test_suite;
 using namespace Ubpa;
 #include <string>
 #include <memory_resource>
+#include <string_view>
 #include <map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
 
 TEST_CASE("static flat map" * test_suite("all")) {
   static_assert(sizeof(static_flat_map<int, int, 5>) == sizeof(static_flat_set<std::pair<int, int>, 5>));
@@ -43,3 +55,398 @@ TEST_CASE("static flat map" * test_suite("all")) {
     REQUIRE(m == p);
   }
 }
+
+TEST_CASE("bulk insert into flat map" * test_suite("all")) {
+  std::map<int, std::string> src{ {3, "c"}, {1, "a"}, {2, "b"} };
+  flat_map<int, std::string> m{ {2, "x"}, {4, "d"}, {2, "y"} };
+  REQUIRE(m.at(2) == "x");
+  m.insert(src.begin(), src.end());
+  flat_map<int, std::string> p{ {1, "a"}, {2, "x"}, {3, "c"}, {4, "d"} };
+  REQUIRE(m == p);
+}
+
+TEST_CASE("sorted insert into flat map" * test_suite("all")) {
+  std::map<int, int> src{ {1, 1}, {3, 3}, {5, 5} };
+  static_flat_map<int, int, 8> m(sorted_unique, src.begin(), src.end());
+  m.insert(sorted_unique, { {2, 2}, {3, 4}, {6, 6} });
+  static_flat_map<int, int, 8> p{ {1, 1}, {2, 2}, {3, 3}, {5, 5}, {6, 6} };
+  REQUIRE(m == p);
+  flat_map<int, int> q(sorted_unique, { {1, 1}, {2, 2} });
+  REQUIRE(q.at(2) == 2);
+}
+
+TEST_CASE("branchless search in flat map" * test_suite("all")) {
+  flat_map<long, int> m;
+  std::map<long, int> ref;
+  for (int i = 0; i < 200; i++) {
+    long k = i * 37 % 101;
+    REQUIRE(m.try_emplace(k, i).second == ref.try_emplace(k, i).second);
+    m.insert_or_assign(m.begin() + (m.size() / 2), k + 1, i);
+    ref.insert_or_assign(k + 1, i);
+  }
+  REQUIRE(m.size() == ref.size());
+  REQUIRE(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+  for (long k = -1; k < 104; k++) {
+    REQUIRE(m.contains(k) == ref.contains(k));
+    REQUIRE((m.lower_bound(k) == m.end()) == (ref.lower_bound(k) == ref.end()));
+  }
+}
+
+TEST_CASE("batched lookup in flat map" * test_suite("all")) {
+  flat_map<int, int> m;
+  for (int i = 0; i < 1000; i++)
+    m.try_emplace(i * 3, i);
+  std::vector<int> keys;
+  for (int i = 0; i < 100; i++)
+    keys.push_back(i * 71 % 3001 - 1); // unsorted, hits and misses
+  for (bool sorted : { false, true }) {
+    if (sorted)
+      std::sort(keys.begin(), keys.end());
+    std::vector<flat_map<int, int>::iterator> iters;
+    m.find_many(keys, std::back_inserter(iters));
+    std::vector<bool> found;
+    m.contains_many(keys, std::back_inserter(found));
+    REQUIRE(iters.size() == keys.size());
+    REQUIRE(found.size() == keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      REQUIRE(iters[i] == m.find(keys[i]));
+      REQUIRE(found[i] == m.contains(keys[i]));
+    }
+  }
+  const flat_map<int, int> empty;
+  std::vector<flat_map<int, int>::const_iterator> iters;
+  empty.find_many(keys, std::back_inserter(iters));
+  REQUIRE(iters == std::vector<flat_map<int, int>::const_iterator>(keys.size(), empty.end()));
+}
+
+TEST_CASE("erase from flat maps" * test_suite("all")) {
+  {
+    flat_multimap<int, std::string> m{ {1, "a"}, {2, "b"}, {2, "c"}, {3, "d"} };
+    REQUIRE(m.erase(2) == 2);
+    REQUIRE(m.size() == 2);
+    REQUIRE(erase_if(m, [](const auto& elem) { return elem.second == "d"; }) == 1);
+    REQUIRE(m.size() == 1);
+    REQUIRE(m.begin()->first == 1);
+  }
+  {
+    flat_map<int, int> m;
+    for (int i = 0; i < 50; i++)
+      m.try_emplace(i, i * i);
+    const std::vector<int> keys{ 0, 10, 20, 30, 40, 50 };
+    REQUIRE(m.erase_many(keys) == 5);
+    REQUIRE(m.size() == 45);
+    REQUIRE(!m.contains(10));
+    REQUIRE(m.at(11) == 121);
+    REQUIRE(erase_if(m, [](std::pair<const int, int>& elem) { return elem.first > 20; }) == 27);
+    REQUIRE(m.size() == 18);
+  }
+  {
+    flat_soa_map<int, std::string> m{ {1, "a"}, {2, "bb"}, {3, "c"} };
+    REQUIRE(erase_if(m, [](const auto& elem) { return elem.second.size() == 1; }) == 2);
+    REQUIRE(m.size() == 1);
+    REQUIRE(m.at(2) == "bb");
+  }
+}
+
+TEST_CASE("buffered flat map" * test_suite("all")) {
+  buffered_flat_map<int, std::string, 4> m{ {1, "a"}, {5, "e"} };
+  REQUIRE(m.try_emplace(3, "c"));
+  REQUIRE(!m.try_emplace(3, "x"));
+  REQUIRE(!m.try_emplace(1, "x"));
+  REQUIRE(m.at(3) == "c");
+  REQUIRE(m.insert({ 2, "b" }));
+  REQUIRE(m.emplace(4, "d"));
+  REQUIRE(!m.insert_or_assign(4, "dd"));
+  REQUIRE(m.at(4) == "dd");
+  m[6] = "f";
+  m[2] += "b";
+  REQUIRE(m.size() == 6);
+  REQUIRE(m.contains(6));
+  REQUIRE(m.count(7) == 0);
+  REQUIRE_THROWS(m.at(7));
+
+  std::map<int, std::string> ref{ {1, "a"}, {2, "bb"}, {3, "c"}, {4, "dd"}, {5, "e"}, {6, "f"} };
+  REQUIRE(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+
+  REQUIRE(m.insert_or_assign(7, "g"));
+  REQUIRE(m.erase(7) == 1);
+  REQUIRE(m.erase(1) == 1);
+  REQUIRE(m.erase(1) == 0);
+  REQUIRE(m.find(1) == m.end());
+  REQUIRE(m.lower_bound(1)->first == 2);
+
+  buffered_flat_map<int, int, 16> n;
+  for (int i = 0; i < 100; i++)
+    n[(i * 37) % 100] = i;
+  for (int i = 0; i < 100; i++)
+    REQUIRE(n.at((i * 37) % 100) == i);
+  REQUIRE(n.size() == 100);
+  REQUIRE(n.flat().size() == 100);
+}
+
+TEST_CASE("small unsorted flat map" * test_suite("all")) {
+  small_unsorted_flat_map<int, std::string, 4> m{ {5, "e"}, {1, "a"} };
+  REQUIRE(!m.sorted());
+  REQUIRE(m.try_emplace(3, "c").second);
+  REQUIRE(!m.try_emplace(3, "x").second);
+  REQUIRE(m.insert_or_assign(2, "b").second);
+  // append order while unsorted
+  std::vector<int> keys;
+  for (const auto& [key, value] : m)
+    keys.push_back(key);
+  REQUIRE(keys == std::vector<int>{ 5, 1, 3, 2 });
+  REQUIRE(m.at(1) == "a");
+  REQUIRE_THROWS(m.at(7));
+  REQUIRE(m == small_unsorted_flat_map<int, std::string, 4>{ {1, "a"}, {2, "b"}, {3, "c"}, {5, "e"} });
+
+  // unsorted erase moves the last element into the hole
+  auto iter = m.erase(m.begin());
+  REQUIRE(iter->first == 2);
+  REQUIRE(m.erase(2) == 1);
+  m[2] = "b";
+  m[5] = "e";
+  REQUIRE(!m.sorted());
+  REQUIRE(m.size() == 4);
+
+  // the fifth element sorts them
+  m[4] = "d";
+  REQUIRE(m.sorted());
+  std::map<int, std::string> ref{ {1, "a"}, {2, "b"}, {3, "c"}, {4, "d"}, {5, "e"} };
+  REQUIRE(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+  REQUIRE(!m.emplace(4, "x").second);
+  REQUIRE(m.erase(1) == 1);
+  REQUIRE(m.begin()->first == 2);
+  REQUIRE(m.find(1) == m.end());
+  REQUIRE(m.contains(5));
+
+  m.clear();
+  REQUIRE(!m.sorted());
+
+  small_unsorted_flat_map<int, int, 8> n;
+  std::map<int, int> nref;
+  for (int i = 0; i < 200; i++) {
+    const int key = (i * 37) % 50;
+    if (i % 5 == 4)
+      REQUIRE(n.erase(key) == nref.erase(key));
+    else
+      REQUIRE(n.insert_or_assign(key, i).second == nref.insert_or_assign(key, i).second);
+  }
+  REQUIRE(n.sorted());
+  REQUIRE(std::equal(n.begin(), n.end(), nref.begin(), nref.end()));
+
+  auto moved = std::move(n);
+  REQUIRE(n.empty());
+  REQUIRE(!n.sorted());
+  REQUIRE(moved.size() == nref.size());
+}
+
+TEST_CASE("extract and replace flat map storage" * test_suite("all")) {
+  flat_map<int, std::string> m{ {2, "b"}, {1, "a"} };
+  std::vector<std::pair<int, std::string>> storage = std::move(m).extract();
+  REQUIRE(m.empty());
+  REQUIRE(storage.size() == 2);
+  REQUIRE(storage[0].first == 1);
+  for (auto& [key, value] : storage)
+    value += value;
+  storage.emplace_back(3, "cc");
+  m.replace(sorted_unique, std::move(storage));
+  REQUIRE(m.size() == 3);
+  REQUIRE(m.at(1) == "aa");
+  REQUIRE(m.at(3) == "cc");
+}
+
+namespace {
+  // counts the keys constructed from a std::string_view
+  struct counted_key {
+    static inline int constructed = 0;
+    std::string str;
+    explicit counted_key(std::string s) : str(std::move(s)) {}
+    explicit counted_key(std::string_view s) : str(s) { ++constructed; }
+  };
+  struct counted_key_less {
+    using is_transparent = int;
+    bool operator()(const counted_key& lhs, const counted_key& rhs) const { return lhs.str < rhs.str; }
+    bool operator()(const counted_key& lhs, std::string_view rhs) const { return lhs.str < rhs; }
+    bool operator()(std::string_view lhs, const counted_key& rhs) const { return lhs < rhs.str; }
+  };
+}
+
+TEST_CASE("transparent modifiers of flat maps" * test_suite("all")) {
+  using namespace std::string_view_literals;
+  {
+    flat_map<counted_key, int, counted_key_less> m;
+    m.try_emplace(counted_key(std::string("a")), 1);
+    m.try_emplace(counted_key(std::string("c")), 3);
+    counted_key::constructed = 0;
+
+    REQUIRE(!m.try_emplace("a"sv, 10).second);
+    REQUIRE(m["a"sv] == 1);
+    REQUIRE(m.at("c"sv) == 3);
+    REQUIRE(!m.insert_or_assign("c"sv, 30).second);
+    REQUIRE(m.at("c"sv) == 30);
+    REQUIRE(m.erase("x"sv) == 0);
+    REQUIRE(counted_key::constructed == 0);
+
+    REQUIRE(m.try_emplace("b"sv, 2).second);
+    m["d"sv] = 4;
+    REQUIRE(m.insert_or_assign(m.end(), "e"sv, 5)->second == 5);
+    REQUIRE(counted_key::constructed == 3);
+    REQUIRE(m.size() == 5);
+    REQUIRE(m.erase("b"sv) == 1);
+    REQUIRE(m.size() == 4);
+    REQUIRE_THROWS(m.at("b"sv));
+  }
+  {
+    flat_multimap<std::string, int, std::less<>> m{ {"a", 1}, {"a", 2}, {"b", 3} };
+    REQUIRE(m.count("a"sv) == 2);
+    REQUIRE(std::distance(m.equal_range("a"sv).first, m.equal_range("a"sv).second) == 2);
+    REQUIRE(m.erase("a"sv) == 2);
+    REQUIRE(m.size() == 1);
+  }
+  {
+    flat_set<std::string, std::less<>> s{ "a", "c" };
+    REQUIRE(!s.insert("a"sv).second);
+    REQUIRE(s.insert("b"sv).second);
+    REQUIRE(s.erase("c"sv) == 1);
+    REQUIRE(s == flat_set<std::string, std::less<>>{ "a", "b" });
+  }
+}
+
+TEST_CASE("overflow policies of static flat map" * test_suite("all")) {
+  static_assert(sizeof(static_flat_map<int, int, 4, std::less<int>, overflow_evict_smallest>) == sizeof(static_flat_map<int, int, 4>));
+  {
+    static_flat_map<int, int, 2, std::less<int>, overflow_throw> m{ {1, 1}, {2, 2} };
+    REQUIRE_THROWS_AS(m.try_emplace(3, 3), std::length_error);
+    REQUIRE_THROWS_AS(m[3], std::length_error);
+    REQUIRE(!m.try_emplace(2, 0).second);
+    m[2] = 4;
+    REQUIRE(m == static_flat_map<int, int, 2, std::less<int>, overflow_throw>{ {1, 1}, {2, 4} });
+    REQUIRE_THROWS_AS((static_flat_map<int, int, 2, std::less<int>, overflow_throw>{ {1, 1}, {2, 2}, {3, 3} }), std::length_error);
+  }
+  {
+    static_flat_map<int, int, 2, std::less<int>, overflow_reject> m;
+    REQUIRE(m.insert({ 1, 1 }).second);
+    REQUIRE(m.emplace(2, 2).second);
+    auto rst = m.try_emplace(3, 3);
+    REQUIRE(!rst.second);
+    REQUIRE(rst.first == m.end());
+    REQUIRE(m.insert_or_assign(m.begin(), 4, 4) == m.end());
+    REQUIRE(!m.insert_or_assign(2, 5).second);
+    REQUIRE(m.at(2) == 5);
+    m.erase(1);
+    REQUIRE(m.try_emplace(3, 3).second);
+    REQUIRE(m == static_flat_map<int, int, 2, std::less<int>, overflow_reject>{ {2, 5}, {3, 3} });
+  }
+  {
+    static_flat_map<int, std::string, 3, std::less<int>, overflow_evict_smallest> m{ {3, "c"}, {1, "a"}, {2, "b"} };
+    m[4] = "d";
+    REQUIRE(m.size() == 3);
+    REQUIRE(!m.contains(1));
+    REQUIRE(m.begin()->first == 2);
+    std::vector<std::pair<int, std::string>> more{ {5, "e"}, {0, "z"} };
+    m.insert(more.begin(), more.end());
+    REQUIRE(m == static_flat_map<int, std::string, 3, std::less<int>, overflow_evict_smallest>{ {0, "z"}, {4, "d"}, {5, "e"} });
+  }
+  {
+    static_flat_map<int, int, 3, std::less<int>, overflow_evict_largest> m{ {1, 1}, {2, 2}, {3, 3} };
+    REQUIRE(m.try_emplace(0, 0).second);
+    REQUIRE(m == static_flat_map<int, int, 3, std::less<int>, overflow_evict_largest>{ {0, 0}, {1, 1}, {2, 2} });
+    REQUIRE(m.insert_or_assign(9, 9).second);
+    REQUIRE(m == static_flat_map<int, int, 3, std::less<int>, overflow_evict_largest>{ {0, 0}, {1, 1}, {9, 9} });
+  }
+  {
+    static_flat_map<int, int, 4, std::less<int>, overflow_evict_random> m;
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(m.try_emplace(i, i).second);
+      REQUIRE(m.size() == std::min(i + 1, 4));
+      REQUIRE(m.contains(i));
+      REQUIRE(std::is_sorted(m.begin(), m.end()));
+    }
+  }
+}
+
+TEST_CASE("static lru map" * test_suite("all")) {
+  auto recency = [](const auto& m) {
+    std::vector<int> keys;
+    for (auto iter = m.most_recent(); iter != m.end(); iter = m.next_recent(iter))
+      keys.push_back(iter->first);
+    return keys;
+  };
+  {
+    static_lru_map<int, std::string, 3> m;
+    REQUIRE(m.empty());
+    REQUIRE(m.most_recent() == m.end());
+    REQUIRE(m.least_recent() == m.end());
+    REQUIRE(m.try_emplace(1, "a").second);
+    REQUIRE(m.try_emplace(2, "b").second);
+    REQUIRE(m.try_emplace(3, "c").second);
+    REQUIRE(m.full());
+    REQUIRE(recency(m) == std::vector<int>{ 3, 2, 1 });
+    REQUIRE(m.find(1)->second == "a");
+    REQUIRE(recency(m) == std::vector<int>{ 1, 3, 2 });
+    REQUIRE(std::as_const(m).find(2)->second == "b");
+    REQUIRE(recency(m) == std::vector<int>{ 1, 3, 2 });
+    m[4] = "d";
+    REQUIRE(!m.contains(2));
+    REQUIRE(recency(m) == std::vector<int>{ 4, 1, 3 });
+    REQUIRE(m.least_recent()->first == 3);
+    REQUIRE(!m.insert_or_assign(3, "cc").second);
+    REQUIRE(m.at(3) == "cc");
+    REQUIRE(recency(m) == std::vector<int>{ 3, 4, 1 });
+    REQUIRE(m.erase(4) == 1);
+    REQUIRE(m.erase(4) == 0);
+    REQUIRE(recency(m) == std::vector<int>{ 3, 1 });
+    REQUIRE(m.emplace(5, "e").second);
+    REQUIRE(m.emplace(6, "f").second);
+    REQUIRE(recency(m) == std::vector<int>{ 6, 5, 3 });
+    REQUIRE_THROWS_AS(m.at(1), std::out_of_range);
+    auto n = std::move(m);
+    REQUIRE(m.empty());
+    REQUIRE(n.size() == 3);
+    REQUIRE(recency(n) == std::vector<int>{ 6, 5, 3 });
+  }
+  {
+    // against a reference: a list in recency order
+    static_lru_map<std::uint32_t, std::uint32_t, 8> m;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> ref;
+    std::uint32_t x = 1;
+    for (int i = 0; i < 5000; i++) {
+      x = x * 1103515245u + 12345u;
+      const std::uint32_t key = (x >> 8) % 20;
+      auto target = std::find_if(ref.begin(), ref.end(), [&](const auto& elem) { return elem.first == key; });
+      if (i % 5 == 4) {
+        REQUIRE(m.erase(key) == static_cast<std::size_t>(target != ref.end()));
+        if (target != ref.end())
+          ref.erase(target);
+      }
+      else {
+        const bool inserted = target == ref.end();
+        REQUIRE(m.try_emplace(key, i).second == inserted);
+        if (inserted) {
+          if (ref.size() == 8)
+            ref.pop_back();
+          ref.insert(ref.begin(), { key, i });
+        }
+        else
+          std::rotate(ref.begin(), target, target + 1);
+      }
+      REQUIRE(m.size() == ref.size());
+      std::vector<int> keys;
+      for (const auto& elem : ref)
+        keys.push_back(static_cast<int>(elem.first));
+      REQUIRE(recency(m) == keys);
+      for (const auto& [k, v] : ref)
+        REQUIRE(std::as_const(m).at(k) == v);
+    }
+  }
+}
+
+TEST_CASE("compile-time static flat map" * test_suite("all")) {
+  static constexpr auto table = make_static_flat_map<std::string_view, int>({ {"two", 2}, {"one", 1}, {"three", 3} });
+  static_assert(table.size() == 3);
+  REQUIRE(table.at("one") == 1);
+  REQUIRE(table.at("three") == 3);
+  REQUIRE(table.find("four") == table.end());
+  REQUIRE(table.begin()->first == "one");
+  REQUIRE(table == static_flat_map<std::string_view, int, 3>{ {"one", 1}, {"three", 3}, {"two", 2} });
+}
@@ -8,6 +8,7 @@
 #include <USmallFlat/small_flat_set.hpp>
 #include <USmallFlat/flat_set.hpp>
 #include <USmallFlat/pmr/flat_set.hpp>
+#include <USmallFlat/buffered_flat_set.hpp>
 
 #include <USmallFlat/static_flat_multiset.hpp>
 #include <USmallFlat/small_flat_multiset.hpp>
@@ -17,7 +18,13 @@
 using doctest::test_suite;
 using namespace Ubpa;
 #include <string>
+#include <string_view>
+#include <memory>
 #include <memory_resource>
+#include <vector>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
 
 TEST_CASE("static flat set" * test_suite("all")) {
   static_assert(sizeof(static_flat_set<int, 5>) == sizeof(static_vector<int, 5>));
@@ -147,3 +154,496 @@ TEST_CASE("static flat set" * test_suite("all")) {
     REQUIRE(v == static_flat_multiset<int, 5>{1, 1, 2, 2, 3});
   }
 }
+
+TEST_CASE("bulk insert into flat set" * test_suite("all")) {
+  {
+    flat_set<int> v{ 5, 1, 3, 1, 9 };
+    REQUIRE(v == flat_set<int>{ 1, 3, 5, 9 });
+    int more[] = { 4, 9, 0, 4, 10 };
+    v.insert(std::begin(more), std::end(more));
+    REQUIRE(v == flat_set<int>{ 0, 1, 3, 4, 5, 9, 10 });
+    v = { 2, 2, 1 };
+    REQUIRE(v == flat_set<int>{ 1, 2 });
+  }
+  {
+    // already in order after the existing elements
+    flat_set<int> v{ 1, 2 };
+    v.insert({ 2, 4, 3 });
+    REQUIRE(v == flat_set<int>{ 1, 2, 3, 4 });
+  }
+  {
+    flat_multiset<int> v{ 3, 1, 3 };
+    v.insert({ 2, 3, 0 });
+    REQUIRE(v == flat_multiset<int>{ 0, 1, 2, 3, 3, 3 });
+  }
+  {
+    // duplicates don't fit the fixed capacity
+    static_flat_set<int, 4> v{ 1, 2 };
+    v.insert({ 2, 2, 2, 1, 3 });
+    REQUIRE(v == static_flat_set<int, 4>{ 1, 2, 3 });
+  }
+  {
+    // a range longer than the 8-bit size_type of static_vector<int, 16>
+    std::vector<int> keys;
+    for (int i = 0; i < 260; i++)
+      keys.push_back(i % 10);
+    static_flat_set<int, 16> v{ 20 };
+    v.insert(keys.begin(), keys.end());
+    REQUIRE(v == static_flat_set<int, 16>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 20 });
+    static_flat_set<int, 16> w(keys.begin(), keys.end());
+    REQUIRE(w.size() == 10);
+  }
+}
+
+TEST_CASE("sorted insert into flat set" * test_suite("all")) {
+  {
+    small_flat_set<int, 4> v(sorted_unique, { 1, 3, 5 });
+    int more[] = { 6, 7, 8 };
+    v.insert(sorted_unique, std::begin(more), std::end(more));
+    REQUIRE(v == small_flat_set<int, 4>{ 1, 3, 5, 6, 7, 8 });
+    v.insert(sorted_unique, { 0, 3, 4, 9 });
+    REQUIRE(v == small_flat_set<int, 4>{ 0, 1, 3, 4, 5, 6, 7, 8, 9 });
+  }
+  {
+    static_vector<int, 5> s{ 1, 1, 2 };
+    static_flat_multiset<int, 5> v(sorted_equivalent, s);
+    v.insert(sorted_equivalent, { 0, 1 });
+    REQUIRE(v == static_flat_multiset<int, 5>{ 0, 1, 1, 1, 2 });
+  }
+}
+
+namespace {
+  struct plain_less : std::less<int> {}; // no branchless search
+}
+
+TEST_CASE("branchless search in flat set" * test_suite("all")) {
+  static_assert(enable_branchless_search_v<int, std::less<int>>);
+  static_assert(enable_branchless_search_v<double, std::greater<>>);
+  static_assert(!enable_branchless_search_v<int, plain_less>);
+  static_assert(!enable_branchless_search_v<std::string, std::less<>>);
+  for (int n = 0; n < 40; n++) {
+    flat_multiset<int> a;
+    flat_multiset<int, plain_less> b;
+    flat_multiset<float, std::greater<>> c;
+    for (int i = 0; i < n; i++) {
+      a.insert(i * 7 % 13);
+      b.insert(i * 7 % 13);
+      c.insert(static_cast<float>(i * 7 % 13));
+    }
+    for (int k = -1; k <= 13; k++) {
+      REQUIRE(a.lower_bound(k) - a.begin() == b.lower_bound(k) - b.begin());
+      REQUIRE(a.upper_bound(k) - a.begin() == b.upper_bound(k) - b.begin());
+      REQUIRE(a.count(k) == b.count(k));
+      REQUIRE(c.count(static_cast<float>(k)) == a.count(k));
+      REQUIRE(c.lower_bound(static_cast<float>(k)) - c.begin() == static_cast<std::ptrdiff_t>(c.size()) - (a.upper_bound(k) - a.begin()));
+    }
+  }
+}
+
+namespace {
+  template<typename T, typename Compare>
+  void check_simd_scan() {
+    static_assert(simd_scan_threshold_v<T> > 0);
+    for (int n = 0; n <= 70; n++) {
+      small_flat_multiset<T, 40, Compare> s; // SIMD scan while 8 <= size() <= simd_scan_threshold_v<T>
+      std::vector<T> ref;
+      for (int i = 0; i < n; i++) {
+        T v = static_cast<T>(i * 7 % 11) - static_cast<T>(std::is_signed_v<T> ? 5 : 0);
+        if constexpr (std::is_unsigned_v<T>)
+          v += static_cast<T>(i % 2 ? ~T{ 0 } / 2 : 0); // values on both sides of the sign bit
+        s.insert(v);
+        ref.push_back(v);
+      }
+      std::sort(ref.begin(), ref.end(), Compare{});
+      REQUIRE(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+      for (const T k : ref) {
+        for (const T key : { k, static_cast<T>(k - 1), static_cast<T>(k + 1) }) {
+          auto lb = std::lower_bound(ref.begin(), ref.end(), key, Compare{}) - ref.begin();
+          auto ub = std::upper_bound(ref.begin(), ref.end(), key, Compare{}) - ref.begin();
+          REQUIRE(s.lower_bound(key) - s.begin() == lb);
+          REQUIRE(s.upper_bound(key) - s.begin() == ub);
+          REQUIRE(s.count(key) == static_cast<std::size_t>(ub - lb));
+          REQUIRE(s.contains(key) == (ub != lb));
+          REQUIRE((s.find(key) == s.end()) == (ub == lb));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("simd scan in flat set" * test_suite("all")) {
+  check_simd_scan<int, std::less<int>>();
+  check_simd_scan<int, std::greater<>>();
+  check_simd_scan<unsigned, std::less<>>();
+  check_simd_scan<std::int64_t, std::less<std::int64_t>>();
+  check_simd_scan<std::uint64_t, std::greater<std::uint64_t>>();
+  check_simd_scan<float, std::less<float>>();
+  check_simd_scan<double, std::greater<double>>();
+}
+
+TEST_CASE("batched lookup in flat set" * test_suite("all")) {
+  small_flat_multiset<std::string, 4> s{ "b", "d", "d", "f" };
+  const std::string keys[] = { "d", "a", "f", "g", "b", "c" };
+  bool found[6];
+  s.contains_many(keys, found);
+  REQUIRE(found[0]);
+  REQUIRE(!found[1]);
+  REQUIRE(found[2]);
+  REQUIRE(!found[3]);
+  REQUIRE(found[4]);
+  REQUIRE(!found[5]);
+  const std::string sorted_keys[] = { "a", "d", "d", "e" };
+  decltype(s)::iterator iters[4];
+  s.find_many(sorted_keys, iters);
+  REQUIRE(iters[0] == s.end());
+  REQUIRE(iters[1] == s.begin() + 1);
+  REQUIRE(iters[2] == s.begin() + 1);
+  REQUIRE(iters[3] == s.end());
+}
+
+namespace {
+  template<typename Set>
+  Set random_set(int n, int range, unsigned seed) {
+    Set s;
+    for (int i = 0; i < n; i++) {
+      seed = seed * 1103515245u + 12345u;
+      s.insert(static_cast<int>((seed >> 8) % static_cast<unsigned>(range)));
+    }
+    return s;
+  }
+}
+
+TEST_CASE("set operations on flat sets" * test_suite("all")) {
+  // balanced and unequal sizes (galloping)
+  for (auto [n, m] : { std::pair{ 50, 60 }, std::pair{ 400, 20 }, std::pair{ 5, 300 }, std::pair{ 0, 10 } }) {
+    auto a = random_set<flat_multiset<int>>(n, 100, 1);
+    auto b = random_set<small_flat_multiset<int, 8>>(m, 100, 2);
+    auto check = [&](auto result, auto std_op) {
+      std::vector<int> expected;
+      std_op(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+      REQUIRE(std::equal(result.begin(), result.end(), expected.begin(), expected.end()));
+    };
+    check(set_union(a, b), [](auto... args) { std::set_union(args...); });
+    check(set_intersection(a, b), [](auto... args) { std::set_intersection(args...); });
+    check(set_difference(a, b), [](auto... args) { std::set_difference(args...); });
+    check(set_symmetric_difference(a, b), [](auto... args) { std::set_symmetric_difference(args...); });
+
+    flat_set<int> ua(a.begin(), a.end());
+    flat_set<int> ub(b.begin(), b.end());
+    auto ucheck = [&](const flat_set<int>& result, auto std_op) {
+      std::vector<int> expected;
+      std_op(ua.begin(), ua.end(), ub.begin(), ub.end(), std::back_inserter(expected));
+      REQUIRE(std::equal(result.begin(), result.end(), expected.begin(), expected.end()));
+    };
+    ucheck(set_union(ua, ub), [](auto... args) { std::set_union(args...); });
+    ucheck(set_union(ua, b), [](auto... args) { std::set_union(args...); }); // a multiset rhs adds each key once
+    ucheck(set_intersection(ua, ub), [](auto... args) { std::set_intersection(args...); });
+    ucheck(set_difference(ua, ub), [](auto... args) { std::set_difference(args...); });
+    ucheck(set_symmetric_difference(ua, ub), [](auto... args) { std::set_symmetric_difference(args...); });
+  }
+}
+
+TEST_CASE("set operations on flat sets of strings" * test_suite("all")) {
+  {
+    flat_set<std::string> a{ "0", "1", "5", "6" };
+    a.set_union(flat_set<std::string>{ "0", "1", "4", "5" });
+    REQUIRE(a == flat_set<std::string>{ "0", "1", "4", "5", "6" });
+    a.set_symmetric_difference(flat_set<std::string>{ "2", "5", "6" });
+    REQUIRE(a == flat_set<std::string>{ "0", "1", "2", "4" });
+  }
+  // the elements of *this are moved in place, none may be left moved-from
+  for (auto [n, m] : { std::pair{ 50, 60 }, std::pair{ 400, 20 }, std::pair{ 5, 300 } }) {
+    auto to_strings = [](const auto& ints) {
+      std::vector<std::string> strs;
+      for (int i : ints)
+        strs.push_back(std::to_string(i));
+      return strs;
+    };
+    auto ai = to_strings(random_set<flat_multiset<int>>(n, 100, 3));
+    auto bi = to_strings(random_set<flat_multiset<int>>(m, 100, 4));
+    flat_multiset<std::string> a(ai.begin(), ai.end());
+    small_flat_multiset<std::string, 8> b(bi.begin(), bi.end());
+    flat_set<std::string> ua(a.begin(), a.end());
+    flat_set<std::string> ub(b.begin(), b.end());
+    auto check = [](const auto& result, const auto& lhs, const auto& rhs, auto std_op) {
+      std::vector<std::string> expected;
+      std_op(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+      REQUIRE(std::equal(result.begin(), result.end(), expected.begin(), expected.end()));
+    };
+    auto merge_op = [](auto first, auto last, auto ofirst, auto olast, auto out) { std::merge(first, last, ofirst, olast, out); };
+    auto union_op = [](auto... args) { std::set_union(args...); };
+    auto sym_op = [](auto... args) { std::set_symmetric_difference(args...); };
+
+    check(set_union(a, b), a, b, union_op);
+    check(set_symmetric_difference(a, b), a, b, sym_op);
+    check(set_union(ua, ub), ua, ub, union_op);
+    check(set_symmetric_difference(ua, ub), ua, ub, sym_op);
+    {
+      auto result = a;
+      auto source = b;
+      result.merge(source);
+      check(result, a, b, merge_op);
+      REQUIRE(source.empty());
+    }
+    {
+      auto result = ua;
+      auto source = b;
+      result.merge(source);
+      check(result, ua, ub, union_op);
+      // one element of each new key is taken, the rest stays in source
+      std::vector<std::string> taken;
+      std::set_difference(ub.begin(), ub.end(), ua.begin(), ua.end(), std::back_inserter(taken));
+      check(source, b, taken, [](auto... args) { std::set_difference(args...); });
+    }
+  }
+}
+
+TEST_CASE("merge flat sets" * test_suite("all")) {
+  {
+    flat_set<std::string> a{ "a", "c", "e" };
+    small_flat_multiset<std::string, 4> b{ "b", "c", "d", "d", "f" };
+    a.merge(b);
+    REQUIRE(a == flat_set<std::string>{ "a", "b", "c", "d", "e", "f" });
+    REQUIRE(b == small_flat_multiset<std::string, 4>{ "c", "d" }); // already in a
+    a.merge(a);
+    REQUIRE(a.size() == 6);
+  }
+  {
+    static_flat_multiset<int, 8> a{ 1, 3 };
+    flat_set<int> b{ 1, 2 };
+    a.merge(std::move(b));
+    REQUIRE(a == static_flat_multiset<int, 8>{ 1, 1, 2, 3 });
+    REQUIRE(b.empty());
+  }
+  {
+    static_flat_set<int, 4> a{ 1, 2, 3 };
+    a.set_intersection(flat_set<int>{ 2, 3, 4 });
+    REQUIRE(a == static_flat_set<int, 4>{ 2, 3 });
+  }
+  {
+    // merged within the fixed storage
+    static_flat_set<std::string, 6> a{ "a", "c" };
+    a.set_union(flat_set<std::string>{ "b", "c", "d" });
+    REQUIRE(a == static_flat_set<std::string, 6>{ "a", "b", "c", "d" });
+    a.set_symmetric_difference(flat_multiset<std::string>{ "a", "e", "e" });
+    REQUIRE(a == static_flat_set<std::string, 6>{ "b", "c", "d", "e" });
+  }
+  {
+    // move-only elements
+    std::unique_ptr<int> ptrs[4];
+    for (auto& ptr : ptrs)
+      ptr = std::make_unique<int>(0);
+    std::sort(std::begin(ptrs), std::end(ptrs));
+    static_flat_set<std::unique_ptr<int>, 4> a;
+    a.insert(std::move(ptrs[0]));
+    a.insert(std::move(ptrs[2]));
+    flat_set<std::unique_ptr<int>> b;
+    b.insert(std::move(ptrs[1]));
+    b.insert(std::move(ptrs[3]));
+    a.merge(b);
+    REQUIRE(a.size() == 4);
+    REQUIRE(b.empty());
+    REQUIRE(std::is_sorted(a.begin(), a.end()));
+  }
+}
+
+TEST_CASE("erase from flat sets" * test_suite("all")) {
+  {
+    flat_multiset<int> s{ 1, 2, 2, 2, 3, 4, 4, 5 };
+    REQUIRE(s.erase(2) == 3);
+    REQUIRE(s == flat_multiset<int>{ 1, 3, 4, 4, 5 });
+    REQUIRE(erase_if(s, [](int x) { return x % 2 == 0; }) == 2);
+    REQUIRE(s == flat_multiset<int>{ 1, 3, 5 });
+  }
+  {
+    small_flat_multiset<int, 4> s;
+    for (int i = 0; i < 100; i++)
+      s.insert(i % 10);
+    const int keys[] = { -1, 0, 3, 4, 9, 12 };
+    REQUIRE(s.erase_many(keys) == 40);
+    REQUIRE(s.size() == 60);
+    REQUIRE(!s.contains(0));
+    REQUIRE(!s.contains(9));
+    REQUIRE(s.count(5) == 10);
+    const std::vector<int> none;
+    REQUIRE(s.erase_many(none) == 0);
+  }
+  {
+    static_flat_set<std::string, 8> s{ "a", "b", "c", "d" };
+    const std::string keys[] = { "a", "c" };
+    REQUIRE(s.erase_many(keys) == 2);
+    REQUIRE(s == static_flat_set<std::string, 8>{ "b", "d" });
+  }
+}
+
+TEST_CASE("buffered flat set" * test_suite("all")) {
+  buffered_flat_set<int, 8> s;
+  std::set<int> ref;
+  std::uint32_t x = 7;
+  for (int i = 0; i < 500; i++) {
+    x = x * 1103515245u + 12345u;
+    const int key = static_cast<int>((x >> 16) % 200);
+    REQUIRE(s.insert(key) == ref.insert(key).second);
+    REQUIRE(s.size() == ref.size());
+    if (i % 7 == 0) {
+      REQUIRE(s.erase(key / 2) == ref.erase(key / 2));
+      REQUIRE(s.contains(key / 2) == false);
+    }
+  }
+  for (int key = 0; key < 200; key++)
+    REQUIRE(s.count(key) == ref.count(key));
+  REQUIRE(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+
+  s.emplace(1000);
+  REQUIRE(s.find(1000) != s.end());
+  REQUIRE(s.lower_bound(1000) == std::prev(s.end()));
+  s.insert({ -1, -2, -3 });
+  REQUIRE(*s.begin() == -3);
+  REQUIRE(s.size() == ref.size() + 4);
+
+  buffered_flat_set<int, 8> t(s.begin(), s.end());
+  REQUIRE(s == t);
+  t.erase(1000);
+  REQUIRE(s != t);
+  t.clear();
+  REQUIRE(t.empty());
+}
+
+TEST_CASE("extract and replace flat set storage" * test_suite("all")) {
+  flat_set<int> s{ 3, 1, 2 };
+  auto storage = std::move(s).extract();
+  REQUIRE(s.empty());
+  REQUIRE(storage == std::vector<int>{ 1, 2, 3 });
+  for (auto& elem : storage)
+    elem *= 10;
+  s.replace(sorted_unique, std::move(storage));
+  REQUIRE(s.size() == 3);
+  REQUIRE(s.contains(20));
+  REQUIRE(!s.contains(2));
+
+  flat_multiset<int> m{ 1, 1, 2 };
+  auto mstorage = std::move(m).extract();
+  mstorage.push_back(2);
+  m.replace(std::move(mstorage));
+  REQUIRE(m.count(2) == 2);
+}
+
+TEST_CASE("overflow policies of static flat set" * test_suite("all")) {
+  {
+    static_flat_set<int, 2, std::less<int>, overflow_reject> s{ 3, 1, 2 };
+    REQUIRE(s == static_flat_set<int, 2, std::less<int>, overflow_reject>{ 1, 3 });
+    REQUIRE(s.insert(0).first == s.end());
+    REQUIRE(!s.insert(1).second);
+    REQUIRE(*s.insert(s.begin(), 3) == 3);
+  }
+  {
+    static_flat_set<std::string, 2, std::less<std::string>, overflow_evict_largest> s{ "b", "c" };
+    REQUIRE(s.emplace(1, 'a').second);
+    REQUIRE(s == static_flat_set<std::string, 2, std::less<std::string>, overflow_evict_largest>{ "a", "b" });
+    REQUIRE(*s.emplace_hint(s.end(), "d") == "d");
+    REQUIRE(s == static_flat_set<std::string, 2, std::less<std::string>, overflow_evict_largest>{ "a", "d" });
+  }
+  {
+    static_flat_set<int, 2, std::less<int>, overflow_throw> s{ 1, 2 };
+    REQUIRE_THROWS_AS(s.insert(3), std::length_error);
+    REQUIRE(s.size() == 2);
+    static_assert(std::is_same_v<decltype(s)::container_type, static_vector<int, 2, overflow_throw>>);
+  }
+}
+
+namespace {
+  template<typename Set>
+  concept has_symmetric_difference = requires(Set& lhs, const flat_set<int>& rhs) { lhs.set_symmetric_difference(rhs); };
+}
+
+TEST_CASE("set operations under the overflow policies of static flat set" * test_suite("all")) {
+  flat_set<int> many;
+  for (int i = 5; i <= 20; i++)
+    many.insert(i);
+  {
+    // the size of the result is checked first
+    using set_type = static_flat_set<int, 4, std::less<int>, overflow_throw>;
+    set_type s{ 1, 2, 3, 4 };
+    auto source = many;
+    REQUIRE_THROWS_AS(s.merge(source), std::length_error);
+    REQUIRE_THROWS_AS(s.set_union(many), std::length_error);
+    REQUIRE_THROWS_AS(s.set_symmetric_difference(flat_set<int>{ 5, 6 }), std::length_error);
+    REQUIRE(s == set_type{ 1, 2, 3, 4 });
+    REQUIRE(source == many);
+    s.set_union(flat_multiset<int>{ 2, 3, 3 });
+    // 5 is merged in before 4 is dropped
+    REQUIRE_THROWS_AS(s.set_symmetric_difference(flat_set<int>{ 4, 5 }), std::length_error);
+    s.set_difference(flat_set<int>{ 4 });
+    s.set_symmetric_difference(flat_set<int>{ 3, 5 });
+    REQUIRE(s == set_type{ 1, 2, 5 });
+    flat_set<int> small_source{ 1, 6 };
+    s.merge(small_source);
+    REQUIRE(s == set_type{ 1, 2, 5, 6 });
+    REQUIRE(small_source == flat_set<int>{ 1 });
+  }
+  {
+    // the elements not inserted stay in source
+    using set_type = static_flat_set<int, 4, std::less<int>, overflow_reject>;
+    set_type s{ 1, 2, 3 };
+    flat_set<int> source{ 0, 2, 5, 6 };
+    s.merge(source);
+    REQUIRE(s == set_type{ 0, 1, 2, 3 });
+    REQUIRE(source == flat_set<int>{ 2, 5, 6 });
+    s.set_union(many);
+    REQUIRE(s == set_type{ 0, 1, 2, 3 });
+    static_assert(!has_symmetric_difference<set_type>);
+    static_assert(has_symmetric_difference<static_flat_set<int, 4, std::less<int>, overflow_throw>>);
+  }
+  {
+    using set_type = static_flat_set<int, 4, std::less<int>, overflow_evict_smallest>;
+    set_type s{ 1, 2, 3, 4 };
+    s.set_union(flat_set<int>{ 5, 6 });
+    REQUIRE(s == set_type{ 3, 4, 5, 6 });
+    auto source = many;
+    s.merge(source);
+    REQUIRE(s == set_type{ 17, 18, 19, 20 });
+    REQUIRE(source == flat_set<int>{ 5, 6 });
+  }
+  {
+    using set_type = static_flat_set<int, 4, std::less<int>, overflow_evict_largest>;
+    set_type s{ 1, 2, 3, 4 };
+    s.set_union(flat_set<int>{ 0, 5 });
+    REQUIRE(s == set_type{ 0, 1, 2, 5 });
+  }
+  {
+    static_flat_set<int, 4, std::less<int>, overflow_evict_random> s{ 1, 2, 3, 4 };
+    s.set_union(many);
+    REQUIRE(s.size() == 4);
+    REQUIRE(s.contains(20));
+  }
+  {
+    // the checked operations run the in-place merge of the base
+    using set_type = static_flat_set<std::string, 5, std::less<std::string>, overflow_throw>;
+    set_type s{ "0", "1", "5", "6" };
+    REQUIRE_THROWS_AS(s.set_union(flat_set<std::string>{ "2", "3" }), std::length_error);
+    s.set_union(flat_set<std::string>{ "0", "1", "4", "5" });
+    REQUIRE(s == set_type{ "0", "1", "4", "5", "6" });
+    s.set_difference(flat_set<std::string>{ "4" });
+    s.set_symmetric_difference(flat_set<std::string>{ "3", "5" });
+    REQUIRE(s == set_type{ "0", "1", "3", "6" });
+    flat_set<std::string> source{ "1", "2" };
+    s.merge(source);
+    REQUIRE(s == set_type{ "0", "1", "2", "3", "6" });
+    REQUIRE(source == flat_set<std::string>{ "1" });
+  }
+}
+
+TEST_CASE("compile-time static flat set" * test_suite("all")) {
+  constexpr auto primes = make_static_flat_set({ 7, 2, 5, 3, 11 });
+  static_assert(primes.size() == 5);
+  static_assert(primes.contains(5) && !primes.contains(4));
+  static_assert(*primes.begin() == 2 && *primes.lower_bound(8) == 11);
+  static_assert(primes.find(12) == primes.end());
+  static_assert(primes == static_flat_set<int, 5>(sorted_unique, static_vector<int, 5>{ 2, 3, 5, 7, 11 }));
+  REQUIRE(primes.count(7) == 1);
+
+  constexpr auto names = make_static_flat_set<std::string_view>({ "b", "c", "a" }, std::greater<>{});
+  static_assert(*names.begin() == "c");
+  static_assert(names.contains("a"));
+  REQUIRE(std::vector<std::string_view>(names.begin(), names.end()) == std::vector<std::string_view>{ "c", "b", "a" });
+}
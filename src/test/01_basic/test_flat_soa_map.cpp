@@ -0,0 +1,46 @@
+#include "doctest.h"
+#include <USmallFlat/flat_soa_map.hpp>
+#include <USmallFlat/small_flat_soa_map.hpp>
+using doctest::test_suite;
+using namespace Ubpa;
+#include <string>
+#include <map>
+
+TEST_CASE("flat soa map" * test_suite("all")) {
+  {
+    flat_soa_map<int, std::string> m{ {3, "c"}, {1, "a"}, {2, "b"}, {1, "x"} };
+    REQUIRE(m.size() == 3);
+    REQUIRE(m.keys() == std::vector<int>{ 1, 2, 3 });
+    REQUIRE(m.values() == std::vector<std::string>{ "a", "b", "c" });
+    REQUIRE(m.at(2) == "b");
+    REQUIRE_THROWS(m.at(4));
+    m[4] = "d";
+    m[2] = "y";
+    REQUIRE(m.find(2)->second == "y");
+    REQUIRE(m.find(5) == m.end());
+    REQUIRE(m.contains(4));
+    auto [iter, inserted] = m.try_emplace(0, "z");
+    REQUIRE(inserted);
+    REQUIRE(iter == m.begin());
+    REQUIRE(!m.insert_or_assign(0, "w").second);
+    REQUIRE(m.begin()->second == "w");
+    REQUIRE(m.erase(3) == 1);
+    REQUIRE(m.erase(3) == 0);
+    int expected[] = { 0, 1, 2, 4 };
+    int i = 0;
+    for (auto [key, value] : m)
+      REQUIRE(key == expected[i++]);
+    REQUIRE((*m.rbegin()).first == 4);
+  }
+  {
+    small_flat_soa_map<int, int, 4> m{ {5, 5}, {1, 1} };
+    std::map<int, int> src{ {0, 0}, {1, 2}, {3, 3}, {7, 7} };
+    m.insert(src.begin(), src.end());
+    small_flat_soa_map<int, int, 4> p(sorted_unique, { {0, 0}, {1, 1}, {3, 3}, {5, 5}, {7, 7} });
+    REQUIRE(m == p);
+    m.insert(sorted_unique, { {8, 8}, {9, 9} });
+    REQUIRE(m.size() == 7);
+    m.erase(m.begin() + 1, m.end() - 1);
+    REQUIRE(m == small_flat_soa_map<int, int, 4>{ {0, 0}, {9, 9} });
+  }
+}
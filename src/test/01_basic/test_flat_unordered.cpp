@@ -0,0 +1,173 @@
+#include "doctest.h"
+#include <USmallFlat/small_flat_unordered_set.hpp>
+#include <USmallFlat/small_flat_unordered_map.hpp>
+#include <USmallFlat/static_flat_unordered_set.hpp>
+#include <USmallFlat/static_flat_unordered_map.hpp>
+#include <USmallFlat/pmr/small_flat_unordered_map.hpp>
+using doctest::test_suite;
+using namespace Ubpa;
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <unordered_map>
+#include <cstdint>
+
+namespace {
+  struct string_hash {
+    using is_transparent = int;
+    std::size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>{}(str); }
+  };
+
+  // every key collides, probing goes through all groups
+  struct bad_hash {
+    std::size_t operator()(int) const noexcept { return 0; }
+  };
+}
+
+TEST_CASE("flat unordered set" * test_suite("all")) {
+  {
+    small_flat_unordered_set<int> s;
+    REQUIRE(s.empty());
+    REQUIRE(s.begin() == s.end());
+    REQUIRE(s.find(1) == s.end());
+    REQUIRE(s.erase(1) == 0);
+    REQUIRE(s.bucket_count() == 0);
+  }
+  {
+    small_flat_unordered_set<int> s{ 3, 1, 2, 1 };
+    REQUIRE(s.size() == 3);
+    REQUIRE(s.contains(1));
+    REQUIRE(s.count(4) == 0);
+    // insertion order
+    REQUIRE(*s.begin() == 3);
+    REQUIRE(!s.insert(2).second);
+    auto [iter, inserted] = s.emplace(4);
+    REQUIRE(inserted);
+    REQUIRE(*iter == 4);
+    REQUIRE(s == small_flat_unordered_set<int>{ 4, 3, 2, 1 });
+    REQUIRE(s != small_flat_unordered_set<int>{ 4, 3, 2 });
+  }
+  {
+    // random inserts and erases against std::unordered_set, through several rehashes and spills
+    small_flat_unordered_set<std::uint32_t, 8> s;
+    std::unordered_set<std::uint32_t> ref;
+    std::uint32_t x = 1;
+    for (int i = 0; i < 20000; i++) {
+      x = x * 1103515245u + 12345u;
+      const std::uint32_t key = (x >> 8) % 3000;
+      if (i < 8000 || i % 3 == 0)
+        REQUIRE(s.insert(key).second == ref.insert(key).second);
+      else
+        REQUIRE(s.erase(key) == ref.erase(key));
+      REQUIRE(s.size() == ref.size());
+    }
+    REQUIRE(s.load_factor() <= s.max_load_factor());
+    for (std::uint32_t key = 0; key < 3001; key++)
+      REQUIRE(s.contains(key) == ref.contains(key));
+    for (auto key : s)
+      REQUIRE(ref.contains(key));
+  }
+  {
+    small_flat_unordered_set<int, 16, bad_hash> s;
+    for (int i = 0; i < 100; i++)
+      s.insert(i);
+    for (int i = 0; i < 100; i += 2)
+      REQUIRE(s.erase(i) == 1);
+    REQUIRE(s.size() == 50);
+    for (int i = 0; i < 100; i++)
+      REQUIRE(s.contains(i) == (i % 2 == 1));
+    // erase returns the position of the moved last element
+    const int first = *s.begin();
+    const int last = *(s.end() - 1);
+    auto iter = s.erase(s.begin());
+    REQUIRE(iter == s.begin());
+    REQUIRE(*iter == last);
+    REQUIRE(s.size() == 49);
+    REQUIRE(!s.contains(first));
+    REQUIRE(s.contains(last));
+  }
+  {
+    small_flat_unordered_set<std::string, 4, string_hash, std::equal_to<>> s{ "a", "b" };
+    REQUIRE(s.contains(std::string_view{ "a" }));
+    REQUIRE(s.find(std::string_view{ "c" }) == s.end());
+    REQUIRE(s.erase(std::string_view{ "b" }) == 1);
+    REQUIRE(s.size() == 1);
+  }
+  {
+    small_flat_unordered_set<int> s{ 1, 2, 3 };
+    auto t = std::move(s);
+    REQUIRE(s.empty());
+    REQUIRE(!s.contains(1));
+    REQUIRE(t.size() == 3);
+    s = t;
+    REQUIRE(s == t);
+  }
+  {
+    static_flat_unordered_set<int, 14> s;
+    for (int i = 0; i < 14; i++)
+      REQUIRE(s.insert(i).second);
+    // erases and inserts reuse the table
+    for (int round = 0; round < 100; round++) {
+      REQUIRE(s.erase(round) == 1);
+      REQUIRE(s.insert(round + 14).second);
+    }
+    REQUIRE(s.size() == 14);
+    REQUIRE(s.bucket_count() == details::flat_unordered_table_capacity(14));
+    for (int i = 100; i < 114; i++)
+      REQUIRE(s.contains(i));
+  }
+}
+
+TEST_CASE("flat unordered map" * test_suite("all")) {
+  {
+    small_flat_unordered_map<int, std::string> m{ {1, "a"}, {2, "b"} };
+    REQUIRE(m.size() == 2);
+    REQUIRE(m.at(1) == "a");
+    REQUIRE_THROWS_AS(m.at(3), std::out_of_range);
+    m[3] = "c";
+    REQUIRE(m.find(3)->second == "c");
+    REQUIRE(!m.try_emplace(3, "d").second);
+    REQUIRE(m[3] == "c");
+    REQUIRE(!m.insert_or_assign(3, "d").second);
+    REQUIRE(m[3] == "d");
+    REQUIRE(m.insert_or_assign(4, "e").second);
+    REQUIRE(m.emplace(5, "f").second);
+    REQUIRE(!m.insert({ 5, "g" }).second);
+    REQUIRE(m.size() == 5);
+    REQUIRE(m.erase(1) == 1);
+    REQUIRE(m == small_flat_unordered_map<int, std::string>{ {5, "f"}, {2, "b"}, {3, "d"}, {4, "e"} });
+    for (auto& [key, value] : m)
+      value += "!";
+    REQUIRE(m.at(2) == "b!");
+  }
+  {
+    small_flat_unordered_map<std::uint32_t, std::uint32_t, 8> m;
+    std::unordered_map<std::uint32_t, std::uint32_t> ref;
+    std::uint32_t x = 1;
+    for (std::uint32_t i = 0; i < 20000; i++) {
+      x = x * 1103515245u + 12345u;
+      const std::uint32_t key = (x >> 8) % 3000;
+      if (i % 4 != 0) {
+        m[key] = i;
+        ref[key] = i;
+      }
+      else
+        REQUIRE(m.erase(key) == ref.erase(key));
+    }
+    REQUIRE(m.size() == ref.size());
+    for (const auto& [key, value] : ref)
+      REQUIRE(m.at(key) == value);
+  }
+  {
+    static_flat_unordered_map<int, int, 4> m{ {1, 1}, {2, 2}, {3, 3}, {4, 4} };
+    REQUIRE(m.size() == 4);
+    REQUIRE(m.at(4) == 4);
+  }
+  {
+    pmr::small_flat_unordered_map<std::string, int, 4, string_hash, std::equal_to<>> m;
+    for (int i = 0; i < 10; i++)
+      m.try_emplace(std::to_string(i), i);
+    REQUIRE(m.find(std::string_view{ "7" })->second == 7);
+    REQUIRE(m.count(std::string_view{ "10" }) == 0);
+  }
+}
@@ -0,0 +1,129 @@
+#include "doctest.h"
+#include <USmallFlat/frozen_flat_set.hpp>
+#include <USmallFlat/frozen_flat_map.hpp>
+#include <USmallFlat/flat_set.hpp>
+#include <USmallFlat/flat_map.hpp>
+#include <USmallFlat/small_flat_map.hpp>
+#include <USmallFlat/frozen_perfect_map.hpp>
+using doctest::test_suite;
+using namespace Ubpa;
+#include <string>
+#include <string_view>
+#include <set>
+
+TEST_CASE("frozen flat set" * test_suite("all")) {
+  {
+    frozen_flat_set<int> s;
+    REQUIRE(s.empty());
+    REQUIRE(s.find(1) == s.end());
+    REQUIRE(s.lower_bound(1) == s.end());
+  }
+  for (int n = 0; n < 70; n++) {
+    flat_set<int> src;
+    for (int i = 0; i < n; i++)
+      src.insert(2 * i);
+    auto s = freeze(src);
+    REQUIRE(s.size() == src.size());
+    REQUIRE(std::equal(s.begin(), s.end(), src.begin()));
+    for (int k = -1; k <= 2 * n; k++) {
+      REQUIRE(s.lower_bound(k) - s.begin() == src.lower_bound(k) - src.begin());
+      REQUIRE(s.upper_bound(k) - s.begin() == src.upper_bound(k) - src.begin());
+      REQUIRE(s.contains(k) == src.contains(k));
+    }
+  }
+  {
+    frozen_flat_set<std::string, std::greater<>> s{ "b", "a", "c", "a" };
+    REQUIRE(s.size() == 3);
+    REQUIRE(*s.begin() == "c");
+    REQUIRE(s.contains("a"));
+    REQUIRE(s.count(std::string("d")) == 0);
+  }
+}
+
+TEST_CASE("frozen flat map" * test_suite("all")) {
+  small_flat_map<int, std::string, 4> src{ {3, "c"}, {1, "a"}, {2, "b"}, {8, "h"}, {5, "e"} };
+  auto m = freeze(src);
+  REQUIRE(m.size() == 5);
+  REQUIRE(m.at(2) == "b");
+  REQUIRE_THROWS(m.at(4));
+  REQUIRE(m.lower_bound(4)->first == 5);
+  REQUIRE(m.upper_bound(8) == m.end());
+  m.find(5)->second = "x";
+  REQUIRE(m.at(5) == "x");
+  frozen_flat_map<int, int> n{ {2, 2}, {1, 1}, {2, 3} };
+  REQUIRE(n.size() == 2);
+  REQUIRE(n.at(2) == 2);
+}
+
+namespace {
+  enum class frozen_color { red, green, blue };
+
+  constexpr auto frozen_keywords = make_frozen_perfect_map<std::string_view, int>({
+    {"if", 1}, {"else", 2}, {"for", 3}, {"while", 4}, {"return", 5},
+    {"switch", 6}, {"case", 7}, {"default", 8}, {"constexpr_if_possible", 9} });
+
+  static_assert(frozen_keywords.size() == 9);
+  static_assert(frozen_keywords.at("while") == 4);
+  static_assert(frozen_keywords.at("constexpr_if_possible") == 9);
+  static_assert(!frozen_keywords.contains("do"));
+  static_assert(frozen_keywords.find("whilE") == frozen_keywords.end());
+
+  constexpr auto frozen_squares = [] {
+    std::pair<int, int> elems[64]{};
+    for (int i = 0; i < 64; i++)
+      elems[i] = { i * i, i };
+    return frozen_perfect_map<int, int, 64>(elems);
+  }();
+
+  static_assert(frozen_squares.at(49) == 7);
+  static_assert(frozen_squares.count(50) == 0);
+}
+
+TEST_CASE("frozen perfect map" * test_suite("all")) {
+  {
+    // transparent lookups
+    REQUIRE(frozen_keywords.at(std::string("case")) == 7);
+    REQUIRE(frozen_keywords.contains("default"));
+    REQUIRE(frozen_keywords.count(std::string("defaults")) == 0);
+    REQUIRE_THROWS_AS(frozen_keywords.at("goto"), std::out_of_range);
+    auto [first, last] = frozen_keywords.equal_range("for");
+    REQUIRE(last - first == 1);
+    REQUIRE(first->second == 3);
+    std::set<int> values;
+    for (const auto& [key, value] : frozen_keywords) {
+      REQUIRE(frozen_keywords.find(key)->second == value);
+      values.insert(value);
+    }
+    REQUIRE(values.size() == 9);
+  }
+  for (int i = 0; i < 64; i++) {
+    REQUIRE(frozen_squares.at(i * i) == i);
+    REQUIRE(!frozen_squares.contains(i * i + 2));
+  }
+  {
+    // built at runtime, all the keys and some misses
+    static std::pair<long long, int> elems[1000];
+    std::uint64_t x = 1;
+    for (int i = 0; i < 1000; i++) {
+      x = x * 6364136223846793005ull + 1442695040888963407ull;
+      elems[i] = { static_cast<long long>(x >> 20) * 2, i };
+    }
+    frozen_perfect_map<long long, int, 1000> m(elems);
+    for (int i = 0; i < 1000; i++) {
+      REQUIRE(m.at(elems[i].first) == i);
+      REQUIRE(!m.contains(elems[i].first + 1));
+    }
+    m.find(elems[3].first)->second = -1;
+    REQUIRE(m.at(elems[3].first) == -1);
+    REQUIRE(m != frozen_perfect_map<long long, int, 1000>(elems));
+    elems[3].second = -1;
+    REQUIRE(m == frozen_perfect_map<long long, int, 1000>(elems));
+  }
+  {
+    constexpr auto colors = make_frozen_perfect_map<frozen_color, std::string_view>({
+      {frozen_color::red, "red"}, {frozen_color::green, "green"}, {frozen_color::blue, "blue"} });
+    static_assert(colors.at(frozen_color::green) == "green");
+    std::pair<int, int> duplicated[3]{ {1, 1}, {2, 2}, {1, 3} };
+    REQUIRE_THROWS_AS((frozen_perfect_map<int, int, 3>(duplicated)), std::invalid_argument);
+  }
+}
@@ -0,0 +1,117 @@
+#include "doctest.h"
+#include <USmallFlat/gapped_flat_set.hpp>
+#include <USmallFlat/gapped_flat_map.hpp>
+using doctest::test_suite;
+using namespace Ubpa;
+#include <string>
+#include <set>
+#include <map>
+#include <cstdint>
+
+TEST_CASE("gapped flat set" * test_suite("all")) {
+  {
+    gapped_flat_set<int> s;
+    REQUIRE(s.empty());
+    REQUIRE(s.begin() == s.end());
+    REQUIRE(s.find(1) == s.end());
+    REQUIRE(s.erase(1) == 0);
+  }
+  {
+    // random inserts and erases against std::set, through several grows and shrinks
+    gapped_flat_set<std::uint32_t> s;
+    std::set<std::uint32_t> ref;
+    std::uint32_t x = 1;
+    for (int i = 0; i < 20000; i++) {
+      x = x * 1103515245u + 12345u;
+      const std::uint32_t key = (x >> 8) % 5000;
+      if (i < 12000 || i % 3 == 0)
+        REQUIRE(s.insert(key).second == ref.insert(key).second);
+      else
+        REQUIRE(s.erase(key) == ref.erase(key));
+      REQUIRE(s.size() == ref.size());
+    }
+    REQUIRE(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+    REQUIRE(std::equal(s.rbegin(), s.rend(), ref.rbegin(), ref.rend()));
+    for (std::uint32_t key = 0; key < 5001; key++) {
+      REQUIRE(s.contains(key) == ref.contains(key));
+      auto lb = s.lower_bound(key);
+      auto ref_lb = ref.lower_bound(key);
+      REQUIRE((lb == s.end()) == (ref_lb == ref.end()));
+      if (lb != s.end())
+        REQUIRE(*lb == *ref_lb);
+      auto ub = s.upper_bound(key);
+      auto ref_ub = ref.upper_bound(key);
+      REQUIRE((ub == s.end()) == (ref_ub == ref.end()));
+      if (ub != s.end())
+        REQUIRE(*ub == *ref_ub);
+    }
+    // erase by iterator returns the next element
+    while (!s.empty()) {
+      auto next = s.erase(s.begin());
+      ref.erase(ref.begin());
+      REQUIRE(s.size() == ref.size());
+      if (!ref.empty())
+        REQUIRE(*next == *ref.begin());
+    }
+    REQUIRE(s.capacity() == 0);
+  }
+  {
+    // a compare without the branchless search
+    struct reversed { bool operator()(int lhs, int rhs) const { return rhs < lhs; } };
+    gapped_flat_set<int, reversed> s;
+    std::set<int, reversed> ref;
+    for (int i = 0; i < 4000; i++) {
+      const int key = (i * 7919) % 4001;
+      s.insert(key);
+      ref.insert(key);
+      if (i % 4 == 0) {
+        REQUIRE(s.erase(key / 2) == ref.erase(key / 2));
+      }
+    }
+    REQUIRE(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+    for (int key = -1; key < 4002; key += 7) {
+      REQUIRE(s.contains(key) == ref.contains(key));
+      REQUIRE(std::distance(s.begin(), s.upper_bound(key)) == std::distance(ref.begin(), ref.upper_bound(key)));
+    }
+  }
+  {
+    gapped_flat_set<std::string> s{ "b", "a", "c", "a" };
+    REQUIRE(s.size() == 3);
+    REQUIRE(*s.begin() == "a");
+    s.insert({ "d", "b" });
+    REQUIRE(s.size() == 4);
+    REQUIRE(s.erase_if([](const std::string& str) { return str < "c"; }) == 2);
+    gapped_flat_set<std::string> t{ "c", "d" };
+    REQUIRE(s == t);
+    gapped_flat_set<std::string> u = std::move(t);
+    REQUIRE(t.empty());
+    REQUIRE(u == s);
+  }
+}
+
+TEST_CASE("gapped flat map" * test_suite("all")) {
+  gapped_flat_map<int, std::string> m{ {2, "b"}, {1, "a"} };
+  REQUIRE(m.try_emplace(3, "c").second);
+  REQUIRE(!m.try_emplace(3, "x").second);
+  REQUIRE(m.at(3) == "c");
+  REQUIRE(!m.insert_or_assign(3, "cc").second);
+  REQUIRE(m.at(3) == "cc");
+  REQUIRE(m.emplace(4, "d").second);
+  m[5] = "e";
+  REQUIRE_THROWS(m.at(6));
+  REQUIRE(m.find(5)->second == "e");
+  REQUIRE(m.erase(1) == 1);
+  REQUIRE(m.begin()->first == 2);
+
+  std::map<int, int> ref;
+  gapped_flat_map<int, int> n;
+  for (int i = 0; i < 3000; i++) {
+    const int key = (i * 7919) % 3001;
+    n[key] = i;
+    ref[key] = i;
+  }
+  REQUIRE(std::equal(n.begin(), n.end(), ref.begin(), ref.end()));
+  for (auto& [key, value] : n)
+    value = -key;
+  REQUIRE(n.at(100) == -100);
+}
@@ -1,8 +1,10 @@
 #include "doctest.h"
 #include <USmallFlat/small_vector.hpp>
+#include <USmallFlat/pmr/small_vector.hpp>
 using doctest::test_suite;
 using namespace Ubpa;
 #include <string>
+#include <memory>
 
 TEST_CASE("Pushing into a small vector" * test_suite("push_back")) {
   small_vector<int, 5> a;
@@ -47,3 +49,96 @@ TEST_CASE("Popping out of a small vector" * test_suite("pop_back")) {
   REQUIRE(a.size() == 0);
   REQUIRE(a.empty());
 }
+
+TEST_CASE("Demotion policies of a small vector" * test_suite("pop_back")) {
+  {
+    small_vector<int, 4, std::allocator<int>, demote_half> a{1, 2, 3, 4, 5};
+    REQUIRE(a.capacity() > 4);
+    const int* heap = a.data();
+    // oscillating around N stays on the heap
+    for (int i = 0; i < 8; i++) {
+      a.pop_back();
+      a.pop_back();
+      REQUIRE(a.data() == heap);
+      a.push_back(4);
+      a.push_back(5);
+      REQUIRE(a.data() == heap);
+    }
+    a.erase(a.begin() + 2, a.end());
+    REQUIRE(a.capacity() == 4);
+    REQUIRE(a == small_vector<int, 4, std::allocator<int>, demote_half>{1, 2});
+  }
+  {
+    small_vector<int, 4, std::allocator<int>, demote_on_shrink> a{1, 2, 3, 4, 5, 6};
+    a.resize(1);
+    a.insert(a.begin(), 0);
+    REQUIRE(a.capacity() > 4);
+    a.shrink_to_fit();
+    REQUIRE(a.capacity() == 4);
+    REQUIRE(a == small_vector<int, 4, std::allocator<int>, demote_on_shrink>{0, 1});
+  }
+  {
+    small_vector<int, 4, std::allocator<int>, demote_never> a{1, 2, 3, 4, 5, 6};
+    while (!a.empty())
+      a.pop_back();
+    a.shrink_to_fit();
+    a.push_back(1);
+    REQUIRE(a.size() == 1);
+    REQUIRE(a[0] == 1);
+  }
+}
+
+TEST_CASE("Heap part of a small vector" * test_suite("push_back")) {
+  {
+    // raw buffer
+    small_vector<std::string, 2> a;
+    for (int i = 0; i < 20; i++)
+      a.push_back(std::to_string(i));
+    a.push_back(a[0]); // aliasing a full buffer
+    a.insert(a.begin() + 1, a[3]);
+    a.erase(a.begin() + 2, a.begin() + 4);
+    REQUIRE(a.size() == 20);
+    REQUIRE(a[0] == "0");
+    REQUIRE(a[1] == "3");
+    REQUIRE(a[2] == "3");
+    REQUIRE(a.back() == "0");
+    small_vector<std::string, 2> b{ a };
+    REQUIRE(a == b);
+    small_vector<std::string, 2> c{ std::move(b) };
+    REQUIRE(b.empty());
+    REQUIRE(a == c);
+    c = small_vector<std::string, 2>{ "x" };
+    REQUIRE(c == small_vector<std::string, 2>{ "x" });
+  }
+  {
+    small_vector<std::unique_ptr<int>, 2> a;
+    for (int i = 0; i < 10; i++)
+      a.emplace_back(std::make_unique<int>(i));
+    a.emplace(a.begin(), std::make_unique<int>(-1));
+    a.erase(a.begin() + 1);
+    REQUIRE(a.size() == 10);
+    REQUIRE(*a[0] == -1);
+    for (int i = 1; i < 10; i++)
+      REQUIRE(*a[i] == i);
+    a.resize(2);
+    REQUIRE(a.capacity() == 2);
+    REQUIRE(*a[1] == 1);
+  }
+  {
+    // std::pmr::vector
+    pmr::small_vector<std::string, 2> a;
+    for (int i = 0; i < 20; i++)
+      a.push_back(std::to_string(i));
+    a.push_back(a[0]);
+    a.insert(a.begin() + 1, a[3]);
+    a.erase(a.begin() + 2, a.begin() + 4);
+    REQUIRE(a.size() == 20);
+    REQUIRE(a[1] == "3");
+    REQUIRE(a.back() == "0");
+    pmr::small_vector<std::string, 2> b{ a };
+    REQUIRE(a == b);
+    b.resize(1);
+    REQUIRE(b.capacity() == 2);
+    REQUIRE(b[0] == "0");
+  }
+}
@@ -51,3 +51,86 @@ TEST_CASE("Sizing/Resizing in small vector of ints" * test_suite("sizing")) {
     REQUIRE(v == small_vector<int, 5>{2,3});
   }
 }
+
+TEST_CASE("Growth policies of a small vector" * test_suite("sizing")) {
+  static_assert(grow_geometric<3, 2>::grow(16, 17, 16) == 24);
+  static_assert(grow_power_of_two::grow(16, 17, 16) == 32);
+  static_assert(grow_exact_then_geometric<>::grow(16, 20, 16) == 20);
+  static_assert(grow_exact_then_geometric<>::grow(20, 21, 16) == 30);
+  {
+    small_vector<int, 4, std::allocator<int>, demote_eager, grow_power_of_two> v;
+    for (int i = 0; i < 100; i++) {
+      v.push_back(i);
+      REQUIRE(std::has_single_bit(v.capacity()));
+    }
+    REQUIRE(v.capacity() == 128);
+    for (int i = 0; i < 100; i++)
+      REQUIRE(v[i] == i);
+  }
+  {
+    small_vector<int, 4, std::allocator<int>, demote_eager, grow_exact_then_geometric<>> v{ 1,2,3,4 };
+    int arr[] = { 5, 6 };
+    v.insert(v.begin(), std::begin(arr), std::end(arr));
+    REQUIRE(v.capacity() == 6);
+    v.push_back(7);
+    REQUIRE(v.capacity() == 9);
+    REQUIRE(v == small_vector<int, 4, std::allocator<int>, demote_eager, grow_exact_then_geometric<>>{ 5,6,1,2,3,4,7 });
+  }
+  {
+    small_vector<int, 4, std::allocator<int>, demote_eager, grow_geometric<3, 2>> v{ 1,2,3,4 };
+    v.emplace(v.begin(), 0);
+    REQUIRE(v.capacity() == 6);
+    v.resize(7);
+    REQUIRE(v.capacity() == 9);
+  }
+}
+
+TEST_CASE("Reserve then fill a small vector" * test_suite("sizing")) {
+  {
+    small_vector<int, 4> v{ 1, 2 };
+    v.reserve(10);
+    REQUIRE(v.capacity() >= 10);
+    const int* heap = v.data();
+    for (int i = 3; i <= 10; i++)
+      v.push_back_unchecked(i);
+    REQUIRE(v.data() == heap);
+    REQUIRE(v.size() == 10);
+    for (int i = 0; i < 10; i++)
+      REQUIRE(v[i] == i + 1);
+  }
+  {
+    small_vector<std::string, 2> v;
+    v.emplace_back_unchecked("a");
+    REQUIRE(v.emplace_back_unchecked("b") == "b");
+    v.append({ "c", "d", "e" });
+    std::set<std::string> s{ "f", "g" };
+    v.append(s.begin(), s.end());
+    REQUIRE(v == small_vector<std::string, 2>{ "a", "b", "c", "d", "e", "f", "g" });
+  }
+  {
+    small_vector<int, 4> v{ 1 };
+    v.resize_default_init(3);
+    REQUIRE(v.size() == 3);
+    v[1] = 2;
+    v[2] = 3;
+    v.resize_default_init(8);
+    REQUIRE(v.size() == 8);
+    for (int i = 3; i < 8; i++)
+      v.data()[i] = i + 1;
+    for (int i = 0; i < 8; i++)
+      REQUIRE(v[i] == i + 1);
+    v.resize(10);
+    REQUIRE(v[9] == 0);
+  }
+  {
+    static_vector<int, 8> v{ 1 };
+    v.push_back_unchecked(2);
+    v.emplace_back_unchecked(3);
+    v.append({ 4, 5 });
+    v.resize_default_init(6);
+    v[5] = 6;
+    REQUIRE(v == static_vector<int, 8>{ 1, 2, 3, 4, 5, 6 });
+    v.resize(8);
+    REQUIRE(v[7] == 0);
+  }
+}
@@ -1,8 +1,26 @@
 #include "doctest.h"
 #include <USmallFlat/static_vector.hpp>
+#include <USmallFlat/compact_small_vector.hpp>
 using doctest::test_suite;
 using namespace Ubpa;
 #include <string>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+namespace {
+  struct relocatable {
+    static inline int moves = 0;
+    relocatable(int v) : value{ std::make_unique<int>(v) } {}
+    relocatable(relocatable&& other) noexcept : value{ std::move(other.value) } { ++moves; }
+    relocatable& operator=(relocatable&& other) noexcept { value = std::move(other.value); ++moves; return *this; }
+    std::unique_ptr<int> value;
+  };
+}
+
+template<>
+struct Ubpa::is_trivially_relocatable<relocatable> : std::true_type {};
 
 TEST_CASE("static vector" * test_suite("all")) {
   //////////////////////
@@ -174,4 +192,132 @@ TEST_CASE("static vector" * test_suite("all")) {
     static_vector<int, 5> w{v.rbegin(), v.rend()};
     REQUIRE(w == static_vector<int, 5>{ 5,4,3,2,1 });
   }
+  {
+    // the value refers to an element that is shifted
+    static_vector<int, 5> v{ 1,2,3 };
+    v.insert(v.begin(), v[1]);
+    v.emplace(v.begin() + 1, v[3]);
+    REQUIRE(v == static_vector<int, 5>{ 2,3,1,2,3 });
+    static_vector<std::string, 5> w{ "a", "b", "c" };
+    w.insert(w.begin(), w[1]);
+    w.emplace(w.begin() + 1, w[3]);
+    REQUIRE(w == static_vector<std::string, 5>{ "b", "c", "a", "b", "c" });
+    static_vector<std::unique_ptr<int>, 5> p;
+    p.push_back(std::make_unique<int>(1));
+    p.push_back(std::make_unique<int>(2));
+    p.insert(p.begin(), std::move(p[1]));
+    REQUIRE(*p[0] == 2);
+    REQUIRE(*p[1] == 1);
+    REQUIRE(p[2] == nullptr);
+  }
+}
+
+TEST_CASE("trivially relocatable" * test_suite("all")) {
+  static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+  static_assert(is_trivially_relocatable_v<static_vector<std::unique_ptr<int>, 4>>);
+  static_assert(is_trivially_relocatable_v<compact_small_vector<int, 4>>);
+  static_assert(!is_trivially_relocatable_v<std::string>);
+  {
+    static_vector<relocatable, 8> v;
+    for (int i = 0; i < 4; i++)
+      v.emplace_back(i);
+    v.emplace(v.begin(), -1);
+    v.erase(v.begin() + 1);
+    v.erase(v.begin() + 1, v.begin() + 2);
+    static_vector<relocatable, 8> w(std::move(v));
+    REQUIRE(relocatable::moves == 0);
+    REQUIRE(v.empty());
+    REQUIRE(w.size() == 3);
+    REQUIRE(*w[0].value == -1);
+    REQUIRE(*w[1].value == 2);
+    REQUIRE(*w[2].value == 3);
+  }
+  {
+    compact_small_vector<relocatable, 2> v;
+    for (int i = 0; i < 6; i++)
+      v.emplace(v.begin(), i);
+    v.erase(v.begin());
+    v.shrink_to_fit();
+    compact_small_vector<relocatable, 2> w(std::move(v));
+    REQUIRE(relocatable::moves == 0);
+    REQUIRE(w.size() == 5);
+    for (int i = 0; i < 5; i++)
+      REQUIRE(*w[i].value == 4 - i);
+  }
+  {
+    compact_small_vector<std::unique_ptr<int>, 2> v;
+    v.push_back(std::make_unique<int>(1));
+    v.push_back(std::make_unique<int>(3));
+    v.insert(v.begin() + 1, std::make_unique<int>(2));
+    REQUIRE(*v[0] == 1);
+    REQUIRE(*v[1] == 2);
+    REQUIRE(*v[2] == 3);
+  }
+}
+
+TEST_CASE("static vector overflow" * test_suite("all")) {
+  {
+    static_vector<int, 2, overflow_throw> v{ 1, 2 };
+    REQUIRE_THROWS_AS(v.push_back(3), std::length_error);
+    REQUIRE_THROWS_AS(v.insert(v.begin(), 0), std::length_error);
+    REQUIRE_THROWS_AS(v.resize(3), std::length_error);
+    REQUIRE(v.size() == 2);
+    REQUIRE(v[0] == 1);
+    REQUIRE(v[1] == 2);
+    const std::vector<int> three{ 1, 2, 3 };
+    REQUIRE_THROWS_AS((static_vector<int, 2, overflow_throw>(three.begin(), three.end())), std::length_error);
+  }
+  {
+    // the unchecked functions bypass Overflow
+    static_vector<int, 2, overflow_throw> v;
+    v.push_back_unchecked(1);
+    REQUIRE(v.emplace_back_unchecked(2) == 2);
+    REQUIRE(v == static_vector<int, 2, overflow_throw>{ 1, 2 });
+  }
+  {
+    static_vector<std::string, 2> v;
+    REQUIRE(v.try_push_back("a"));
+    REQUIRE(*v.try_emplace_back("b") == "b");
+    std::string c = "c";
+    REQUIRE(!v.try_push_back(std::move(c)));
+    REQUIRE(c == "c");
+    REQUIRE(v.try_emplace_back("d") == nullptr);
+    REQUIRE(v.size() == 2);
+  }
+}
+
+namespace {
+  constexpr std::size_t constexpr_static_vector_test() {
+    static_vector<std::string, 6> v;
+    v.push_back("b");
+    v.emplace(v.begin(), "a");
+    v.insert(v.end(), 2, std::string("c"));
+    v.insert(v.begin() + 1, { "x", "y" });
+    v.erase(v.begin() + 1);
+    static_vector<std::string, 6> w = v;
+    w.pop_back();
+    w.resize(1);
+    return v.size() * 10 + w.size() + (w[0] == "a" && v[1] == "y" ? 100 : 0);
+  }
+
+  constexpr static_vector<int, 8> constexpr_sorted_static_vector() {
+    static_vector<int, 8> v{ 5, 1, 4 };
+    v.insert(v.begin() + 1, { 9, 8 });
+    v.erase(v.begin());
+    std::sort(v.begin(), v.end());
+    return v;
+  }
+}
+
+TEST_CASE("constexpr static vector" * test_suite("all")) {
+  static_assert(constexpr_static_vector_test() == 151);
+  constexpr auto v = constexpr_sorted_static_vector();
+  static_assert(v == static_vector<int, 8>{ 1, 4, 8, 9 });
+  REQUIRE(v.size() == 4);
+  {
+    // the new elements outnumber the moved ones
+    static_vector<std::string, 8> w{ "a", "b" };
+    w.insert(w.begin() + 1, 3, "x");
+    REQUIRE(w == static_vector<std::string, 8>{ "a", "x", "x", "x", "b" });
+  }
 }
@@ -1,10 +1,252 @@
 #include <USmallFlat/small_vector.hpp>
 #include <USmallFlat/small_flat_set.hpp>
+#include <USmallFlat/flat_map.hpp>
+#include <USmallFlat/flat_set.hpp>
+#include <USmallFlat/flat_soa_map.hpp>
+#include <USmallFlat/frozen_flat_set.hpp>
+#include <USmallFlat/buffered_flat_map.hpp>
+#include <USmallFlat/gapped_flat_set.hpp>
+#include <USmallFlat/small_flat_unordered_map.hpp>
+#include <USmallFlat/small_flat_map.hpp>
+#include <USmallFlat/small_unsorted_flat_map.hpp>
+#include <USmallFlat/adaptive_map.hpp>
+#include <USmallFlat/static_flat_map.hpp>
+#include <USmallFlat/frozen_perfect_map.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <set>
 #include <unordered_map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// counts the heap traffic of small_vector growth policies
+struct alloc_stats {
+	static inline std::size_t allocations = 0;
+	static inline std::size_t bytes = 0;
+	static inline std::size_t peak_bytes = 0;
+	static void reset() { allocations = bytes = peak_bytes = 0; }
+};
+
+template<typename T>
+struct counting_allocator {
+	using value_type = T;
+	counting_allocator() = default;
+	template<typename U>
+	counting_allocator(const counting_allocator<U>&) noexcept {}
+	T* allocate(std::size_t n) {
+		++alloc_stats::allocations;
+		alloc_stats::bytes += n * sizeof(T);
+		alloc_stats::peak_bytes = std::max(alloc_stats::peak_bytes, alloc_stats::bytes);
+		return std::allocator<T>{}.allocate(n);
+	}
+	void deallocate(T* p, std::size_t n) noexcept {
+		alloc_stats::bytes -= n * sizeof(T);
+		std::allocator<T>{}.deallocate(p, n);
+	}
+	template<typename U>
+	bool operator==(const counting_allocator<U>&) const noexcept { return true; }
+};
+
+template<typename GrowthPolicy>
+void bench_growth(const char* name, std::size_t cnt) {
+	using vector_type = Ubpa::small_vector<std::size_t, 16, counting_allocator<std::size_t>, Ubpa::demote_eager, GrowthPolicy>;
+	alloc_stats::reset();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	{
+		vector_type v;
+		for (std::size_t k = 0; k < cnt; k++)
+			v.push_back(k);
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	std::cout << name
+		<< " : reallocations " << alloc_stats::allocations
+		<< ", peak heap bytes " << alloc_stats::peak_bytes
+		<< ", " << std::chrono::duration<double, std::micro>(t1 - t0).count() << " us" << std::endl;
+}
+
+// 8-byte keys with 64-byte values
+struct wide_value {
+	std::size_t payload[8];
+};
+
+template<typename Map>
+double bench_lookup(std::size_t cnt, std::size_t& rst) {
+	Map m;
+	for (std::size_t k = 0; k < cnt; k++)
+		m.try_emplace(k * 2, wide_value{ { k } });
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < 1000000; j++)
+		rst += m.find((std::rand() % cnt) * 2)->second.payload[0];
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// same order as std::less, opts out of the branchless search
+struct plain_less : std::less<std::size_t> {};
+
+template<typename Set>
+double bench_contains(const Set& s, std::size_t cnt, std::size_t& rst) {
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < 1000000; j++)
+		rst += s.contains(std::rand() % (2 * cnt));
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// lower_bound of keys in [0, 2n) over 0, 2, ..., 2n - 2
+template<typename T>
+void bench_scan(std::size_t n, std::size_t& rst) {
+	std::vector<T> keys(n);
+	for (std::size_t i = 0; i < n; i++)
+		keys[i] = static_cast<T>(i * 2);
+	std::vector<T> queries(4096);
+	for (auto& q : queries)
+		q = static_cast<T>(std::rand() % (2 * n));
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < 4000000; j++)
+		rst += Ubpa::details::simd_lower_rank<false>(keys.data(), n, queries[j % queries.size()]);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < 4000000; j++)
+		rst += Ubpa::details::branchless_lower_bound(keys.data(), keys.data() + n, queries[j % queries.size()], std::less<T>{}, std::identity{}) - keys.data();
+	auto t2 = std::chrono::high_resolution_clock::now();
+	std::cout << "  " << n << " keys : scan " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, binary search " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+}
+
+// a batch of cnt random keys: find one by one, find_many, find_many after sorting the batch
+void bench_find_many(std::size_t n, std::size_t cnt, std::size_t& rst) {
+	Ubpa::flat_map<std::size_t, std::size_t> m;
+	for (std::size_t k = 0; k < n; k++)
+		m.try_emplace(k * 2, k);
+	std::vector<std::size_t> keys(cnt);
+	std::vector<Ubpa::flat_map<std::size_t, std::size_t>::iterator> iters(cnt);
+	double single = 0, batched = 0, sorted = 0;
+	for (std::size_t r = 0; r < (1 << 19) / cnt; r++) {
+		for (auto& k : keys)
+			k = (std::rand() * std::size_t{ 7919 } % n) * 2;
+		auto t0 = std::chrono::high_resolution_clock::now();
+		for (std::size_t i = 0; i < cnt; i++)
+			iters[i] = m.find(keys[i]);
+		for (auto iter : iters)
+			rst += iter->second;
+		auto t1 = std::chrono::high_resolution_clock::now();
+		m.find_many(keys, iters.begin());
+		for (auto iter : iters)
+			rst += iter->second;
+		auto t2 = std::chrono::high_resolution_clock::now();
+		std::sort(keys.begin(), keys.end());
+		auto t3 = std::chrono::high_resolution_clock::now();
+		m.find_many(keys, iters.begin());
+		for (auto iter : iters)
+			rst += iter->second;
+		auto t4 = std::chrono::high_resolution_clock::now();
+		single += std::chrono::duration<double, std::milli>(t1 - t0).count();
+		batched += std::chrono::duration<double, std::milli>(t2 - t1).count();
+		sorted += std::chrono::duration<double, std::milli>(t4 - t3).count();
+	}
+	std::cout << "  " << cnt << " keys in " << n << " elements : find " << single << " ms, find_many " << batched
+		<< " ms, sorted find_many " << sorted << " ms" << std::endl;
+}
+
+// n random inserts then n lookups
+template<typename Map>
+void bench_random_insert(const char* name, std::size_t n, std::size_t& rst) {
+	std::vector<std::size_t> keys(n);
+	for (auto& k : keys)
+		k = std::rand() * std::size_t{ 7919 } + std::rand();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	Map m;
+	for (auto k : keys)
+		m.try_emplace(k, k);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	for (auto k : keys)
+		rst += m.find(k)->second;
+	auto t2 = std::chrono::high_resolution_clock::now();
+	std::cout << "  " << name << " " << n << " elements : insert " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, find " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+}
+
+// n random inserts then n lookups
+template<typename Set>
+void bench_random_insert_set(const char* name, std::size_t n, std::size_t& rst) {
+	std::vector<std::size_t> keys(n);
+	for (auto& k : keys)
+		k = std::rand() * std::size_t{ 7919 } + std::rand();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	Set s;
+	for (auto k : keys)
+		s.insert(k);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	for (auto k : keys)
+		rst += s.contains(k);
+	auto t2 = std::chrono::high_resolution_clock::now();
+	std::cout << "  " << name << " " << n << " elements : insert " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, contains " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+}
+
+// 10000 maps of n keys built and dropped, then 1000000 lookups in one of them
+template<typename Map>
+void bench_small_map(const char* name, std::size_t n, std::size_t& rst) {
+	std::vector<std::size_t> keys(n);
+	for (auto& k : keys)
+		k = std::rand() * std::size_t{ 7919 } + std::rand();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < 10000; j++) {
+		Map m;
+		for (auto k : keys)
+			m.try_emplace(k, j);
+		rst += m.size();
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	Map m;
+	for (auto k : keys)
+		m.try_emplace(k, k);
+	for (std::size_t j = 0; j < 1000000; j++)
+		rst += m.find(keys[std::rand() % n])->second;
+	auto t2 = std::chrono::high_resolution_clock::now();
+	std::cout << "  " << name << " " << n << " elements : build " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+		<< " ms, find " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+}
+
+// maps of n random keys built (n inserts and n lookups) for 2^20 inserts in total
+template<typename Map>
+void bench_build_and_find(const char* name, std::size_t n, std::size_t& rst) {
+	std::vector<std::size_t> keys(n);
+	for (auto& k : keys)
+		k = std::rand() * std::size_t{ 7919 } + std::rand();
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < (std::size_t{ 1 } << 20) / n; j++) {
+		Map m;
+		for (auto k : keys)
+			m.try_emplace(k, k);
+		for (auto k : keys)
+			rst += m.find(k)->second;
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	std::cout << "  " << name << " " << n << " elements : " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+}
+
+// 2^20 lookups of identifier-like keys, 1 in 4 misses
+template<typename Map, std::size_t N>
+double bench_keyword_find(const Map& m, const std::string_view(&keys)[N], std::size_t& rst) {
+	std::vector<std::string> queries(4096);
+	for (auto& q : queries) {
+		q = keys[std::rand() % N];
+		if (std::rand() % 4 == 0)
+			q.back() = '_';
+	}
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (std::size_t j = 0; j < (std::size_t{ 1 } << 20); j++) {
+		auto target = m.find(std::string_view(queries[j % queries.size()]));
+		rst += target != m.end() ? target->second : 0;
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
 
 void init_small_vector(void* ptr) {
 	new(ptr)Ubpa::small_vector<std::size_t, 16>();
@@ -142,5 +384,126 @@ int main() {
 
 		std::cout << sum << std::endl;
 	}
+	{
+		// heap growth policies: reallocation count and peak heap bytes (the RSS high-water mark of the vector)
+		for (std::size_t n : { cnt, std::size_t{ 1000 }, std::size_t{ 100000 } }) {
+			std::cout << "push_back " << n << " elements" << std::endl;
+			bench_growth<Ubpa::grow_native>("  native                 ", n);
+			bench_growth<Ubpa::grow_geometric<2, 1>>("  geometric 2x           ", n);
+			bench_growth<Ubpa::grow_geometric<3, 2>>("  geometric 1.5x         ", n);
+			bench_growth<Ubpa::grow_power_of_two>("  power of two           ", n);
+			bench_growth<Ubpa::grow_exact_then_geometric<>>("  exact then geometric   ", n);
+		}
+	}
+	{
+		// flat_map (interleaved pairs) vs flat_soa_map (dense key array)
+		for (std::size_t n : { cnt, std::size_t{ 1000 }, std::size_t{ 100000 } }) {
+			double aos = bench_lookup<Ubpa::flat_map<std::size_t, wide_value>>(n, rst);
+			double soa = bench_lookup<Ubpa::flat_soa_map<std::size_t, wide_value>>(n, rst);
+			std::cout << "find in " << n << " wide elements : flat_map " << aos << " ms, flat_soa_map " << soa << " ms" << std::endl;
+		}
+	}
+	{
+		// flat_set (sorted layout) vs frozen_flat_set (Eytzinger layout)
+		for (std::size_t n : { std::size_t{ 1000 }, std::size_t{ 100000 }, std::size_t{ 1000000 } }) {
+			Ubpa::flat_set<std::size_t> s;
+			for (std::size_t k = 0; k < n; k++)
+				s.insert(k * 2);
+			auto fs = Ubpa::freeze(s);
+			double sorted = bench_contains(s, n, rst);
+			double eytzinger = bench_contains(fs, n, rst);
+			std::cout << "contains in " << n << " elements : flat_set " << sorted << " ms, frozen_flat_set " << eytzinger << " ms" << std::endl;
+		}
+	}
+	{
+		// branchless search vs std::lower_bound
+		for (std::size_t n : { std::size_t{ 1000 }, std::size_t{ 100000 }, std::size_t{ 1000000 } }) {
+			Ubpa::flat_set<std::size_t> s;
+			Ubpa::flat_set<std::size_t, plain_less> p;
+			for (std::size_t k = 0; k < n; k++) {
+				s.insert(k * 2);
+				p.insert(k * 2);
+			}
+			double branchless = bench_contains(s, n, rst);
+			double branchy = bench_contains(p, n, rst);
+			std::cout << "contains in " << n << " elements : branchless " << branchless << " ms, std::lower_bound " << branchy << " ms" << std::endl;
+		}
+	}
+	{
+		// SIMD scan vs branchless binary search, the crossover is simd_scan_threshold
+		std::cout << "lower_bound in 32-bit keys" << std::endl;
+		for (std::size_t n : { 4, 8, 16, 32, 64, 128, 256 })
+			bench_scan<std::uint32_t>(n, rst);
+		std::cout << "lower_bound in 64-bit keys" << std::endl;
+		for (std::size_t n : { 4, 8, 16, 32, 64, 128, 256 })
+			bench_scan<std::uint64_t>(n, rst);
+	}
+	{
+		// 2^19 lookups in batches
+		std::cout << "batched lookup" << std::endl;
+		for (std::size_t n : { std::size_t{ 100000 }, std::size_t{ 1000000 } }) {
+			bench_find_many(n, 256, rst);
+			bench_find_many(n, 65536, rst);
+		}
+	}
+	{
+		// random inserts: flat_map shifts on every insert, buffered_flat_map merges every 64
+		std::cout << "random insert" << std::endl;
+		for (std::size_t n : { std::size_t{ 1000 }, std::size_t{ 10000 }, std::size_t{ 100000 } }) {
+			bench_random_insert<Ubpa::flat_map<std::size_t, std::size_t>>("flat_map", n, rst);
+			bench_random_insert<Ubpa::buffered_flat_map<std::size_t, std::size_t>>("buffered_flat_map", n, rst);
+		}
+	}
+	{
+		// random inserts: flat_set shifts O(n) elements, gapped_flat_set amortized O(log^2(n))
+		std::cout << "random insert into sets" << std::endl;
+		for (std::size_t n : { std::size_t{ 10000 }, std::size_t{ 100000 }, std::size_t{ 300000 } }) {
+			bench_random_insert_set<Ubpa::flat_set<std::size_t>>("flat_set", n, rst);
+			bench_random_insert_set<Ubpa::gapped_flat_set<std::size_t>>("gapped_flat_set", n, rst);
+		}
+	}
+	{
+		// small maps: std::unordered_map allocates per node, small_flat_unordered_map stays inline up to 32
+		std::cout << "small maps" << std::endl;
+		for (std::size_t n : { std::size_t{ 8 }, std::size_t{ 32 }, std::size_t{ 64 } }) {
+			bench_small_map<std::unordered_map<std::size_t, std::size_t>>("std::unordered_map       ", n, rst);
+			bench_small_map<Ubpa::flat_map<std::size_t, std::size_t>>("flat_map                 ", n, rst);
+			bench_small_map<Ubpa::small_flat_unordered_map<std::size_t, std::size_t, 32>>("small_flat_unordered_map ", n, rst);
+		}
+	}
+	{
+		// tiny maps under inserts: small_flat_map shifts on every insert, small_unsorted_flat_map appends
+		std::cout << "tiny maps" << std::endl;
+		for (std::size_t n : { std::size_t{ 4 }, std::size_t{ 8 } }) {
+			bench_small_map<Ubpa::small_flat_map<std::size_t, std::size_t, 8>>("small_flat_map           ", n, rst);
+			bench_small_map<Ubpa::small_unsorted_flat_map<std::size_t, std::size_t, 8>>("small_unsorted_flat_map  ", n, rst);
+		}
+	}
+	{
+		// adaptive_map (linear up to 8, sorted up to 64, hashed) around its transitions
+		std::cout << "adaptive map" << std::endl;
+		for (std::size_t n : { 4, 8, 9, 32, 64, 65, 1024, 16384 }) {
+			if (n <= 1024)
+				bench_build_and_find<Ubpa::flat_map<std::size_t, std::size_t>>("flat_map          ", n, rst);
+			bench_build_and_find<std::unordered_map<std::size_t, std::size_t>>("std::unordered_map", n, rst);
+			bench_build_and_find<Ubpa::adaptive_map<std::size_t, std::size_t>>("adaptive_map      ", n, rst);
+		}
+	}
+	{
+		// static_flat_map (binary search, string comparisons) vs frozen_perfect_map (one hash, one comparison)
+		static std::string names[64];
+		std::string_view keys[64];
+		std::pair<std::string_view, std::size_t> elems[64];
+		for (std::size_t i = 0; i < 64; i++) {
+			names[i] = "handler_" + std::to_string(i * 7919) + "_name";
+			keys[i] = names[i];
+			elems[i] = { keys[i], i };
+		}
+		Ubpa::static_flat_map<std::string_view, std::size_t, 64> sorted(std::begin(elems), std::end(elems));
+		Ubpa::frozen_perfect_map<std::string_view, std::size_t, 64> perfect(elems);
+		double binary = bench_keyword_find(sorted, keys, rst);
+		double hashed = bench_keyword_find(perfect, keys, rst);
+		std::cout << "find in 64 string keys : static_flat_map " << binary << " ms, frozen_perfect_map " << hashed << " ms" << std::endl;
+	}
 	std::cout << rst << std::endl;
 }